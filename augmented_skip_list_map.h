@@ -0,0 +1,1114 @@
+//==============================================================================
+// augmented_skip_list_map.h
+//==============================================================================
+
+#pragma once
+
+#include "skip_list_detail.h"
+
+#include <memory>     // for std::allocator
+#include <functional> // for std::less
+#include <iterator>   // for std::reverse_iterator
+#include <limits>     // for std::numeric_limits
+#include <utility>    // for std::pair
+#include <new>        // for placement new
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
+#endif
+
+//==============================================================================
+#pragma mark - aggregators
+//==============================================================================
+
+namespace goodliffe {
+
+/// An Aggregator says how to combine the mapped values of an
+/// augmented_skip_list_map. It is a monoid: an identity, a way to make a
+/// result from one mapped value, and an associative way to combine two
+/// results (which need not be commutative; results are always combined
+/// in key order).
+///
+/// These are the common ones. Write your own with the same members.
+template <typename T>
+struct sum_aggregator
+{
+    typedef T result_type;
+
+    result_type identity() const                                                  { return T(); }
+    result_type operator()(const T &value) const                                  { return value; }
+    result_type operator()(const result_type &lhs, const result_type &rhs) const  { return lhs + rhs; }
+};
+
+template <typename T>
+struct min_aggregator
+{
+    typedef T result_type;
+
+    result_type identity() const                                                  { return std::numeric_limits<T>::max(); }
+    result_type operator()(const T &value) const                                  { return value; }
+    result_type operator()(const result_type &lhs, const result_type &rhs) const  { return rhs < lhs ? rhs : lhs; }
+};
+
+template <typename T>
+struct max_aggregator
+{
+    typedef T result_type;
+
+    result_type identity() const                                                  { return std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::min() : -std::numeric_limits<T>::max(); }
+    result_type operator()(const T &value) const                                  { return value; }
+    result_type operator()(const result_type &lhs, const result_type &rhs) const  { return lhs < rhs ? rhs : lhs; }
+};
+
+/// Counts the entries, whatever their values.
+template <typename T, typename Count = std::size_t>
+struct count_aggregator
+{
+    typedef Count result_type;
+
+    result_type identity() const                                                  { return 0; }
+    result_type operator()(const T &) const                                       { return 1; }
+    result_type operator()(const result_type &lhs, const result_type &rhs) const  { return lhs + rhs; }
+};
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - internal forward declarations
+
+namespace goodliffe {
+namespace detail
+{
+    template <typename K,typename M,typename AG,typename C,typename A,typename LG>
+    class asl_impl;
+}
+}
+
+//==============================================================================
+#pragma mark - augmented_skip_list_map
+//==============================================================================
+
+namespace goodliffe {
+
+/// An augmented_skip_list_map is a skip_list_map that also keeps, for each
+/// link in each tower, the Aggregator's result for the mapped values the
+/// link passes over. The spans of a random_access_skip_list are the same
+/// idea, with a count_aggregator.
+///
+/// aggregate(lo, hi) then combines the values of every key in [lo, hi)
+/// from the links that cover it, in O(log N), rather than visiting each
+/// entry. For example, with prices as keys and volumes as values, a
+/// sum_aggregator gives the total volume between two prices.
+///
+/// The aggregates depend on the mapped values, so those can't be written
+/// through an iterator; change them with update(), which brings the
+/// aggregates above the entry up to date in O(log N).
+///
+/// @see skip_list_map
+template <typename Key,
+          typename MappedTo,
+          typename Aggregator      = sum_aggregator<MappedTo>,
+          typename KeyCompare      = std::less<Key>,
+          typename Allocator       = std::allocator<std::pair<const Key, MappedTo> >,
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32> >
+class augmented_skip_list_map
+{
+public:
+
+    //======================================================================
+    // types
+
+    typedef Key                                           key_type;
+    typedef MappedTo                                      mapped_type;
+    typedef std::pair<const Key, MappedTo>                value_type;
+    typedef Allocator                                     allocator_type;
+    typedef Aggregator                                    aggregator_type;
+    typedef typename Aggregator::result_type              aggregate_type;
+
+protected:
+    typedef typename detail::asl_impl<Key,MappedTo,Aggregator,KeyCompare,Allocator,LevelGenerator> impl_type;
+    typedef typename impl_type::node_type node_type;
+
+    template <typename T1> friend class detail::sl_const_iterator;
+
+public:
+    typedef typename impl_type::size_type                 size_type;
+    typedef typename allocator_type::difference_type      difference_type;
+    typedef typename allocator_type::reference            reference;
+    typedef typename allocator_type::const_reference      const_reference;
+    typedef typename allocator_type::pointer              pointer;
+    typedef typename allocator_type::const_pointer        const_pointer;
+    typedef KeyCompare                                    compare;
+
+    typedef typename detail::sl_const_iterator<impl_type> iterator;
+    typedef typename detail::sl_const_iterator<impl_type> const_iterator;
+    typedef std::reverse_iterator<const_iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>         const_reverse_iterator;
+
+    //======================================================================
+    // lifetime management
+
+    explicit augmented_skip_list_map(const Allocator &alloc = Allocator(),
+                                     const Aggregator &aggregator = Aggregator());
+
+    template <class InputIterator>
+    augmented_skip_list_map(InputIterator first, InputIterator last, const Allocator &alloc = Allocator(),
+                            const Aggregator &aggregator = Aggregator());
+
+    augmented_skip_list_map(const augmented_skip_list_map &other);
+
+#if SKIP_LIST_CPP11
+    augmented_skip_list_map(augmented_skip_list_map &&other);
+    augmented_skip_list_map(std::initializer_list<value_type> init, const Allocator &alloc = Allocator(),
+                            const Aggregator &aggregator = Aggregator());
+#endif
+
+    allocator_type  get_allocator() const  { return impl.get_allocator(); }
+    aggregator_type get_aggregator() const { return impl.aggregator; }
+
+    //======================================================================
+    // assignment
+
+    augmented_skip_list_map &operator=(const augmented_skip_list_map &other);
+#if SKIP_LIST_CPP11
+    augmented_skip_list_map &operator=(augmented_skip_list_map &&other);
+#endif
+
+    template <typename InputIterator>
+    void assign(InputIterator first, InputIterator last);
+
+    //======================================================================
+    // element access
+
+    const_reference front() const;
+    const_reference back() const;
+
+    //======================================================================
+    // iterators
+
+    const_iterator begin() const            { return const_iterator(&impl, impl.front()); }
+    const_iterator cbegin() const           { return const_iterator(&impl, impl.front()); }
+
+    const_iterator end() const              { return const_iterator(&impl, impl.one_past_end()); }
+    const_iterator cend() const             { return const_iterator(&impl, impl.one_past_end()); }
+
+    const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const  { return const_reverse_iterator(end()); }
+
+    const_reverse_iterator rend() const     { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const    { return const_reverse_iterator(begin()); }
+
+    //======================================================================
+    // capacity
+
+    bool      empty() const         { return impl.size() == 0; }
+    size_type size() const          { return impl.size(); }
+    size_type max_size() const      { return impl.get_allocator().max_size(); }
+
+    //======================================================================
+    // modifiers
+
+    void clear();
+
+    typedef typename std::pair<iterator,bool> insert_by_value_result;
+
+    insert_by_value_result insert(const value_type &value);
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last);
+
+#if SKIP_LIST_CPP11
+    void insert(std::initializer_list<value_type> ilist);
+#endif
+
+    /// Set the value mapped to key, inserting it if there is none.
+    iterator update(const key_type &key, const mapped_type &mapped);
+
+    /// Set the value the entry at position maps to.
+    void update(const_iterator position, const mapped_type &mapped);
+
+    size_type erase(const key_type &key);
+    iterator  erase(const_iterator position);
+    iterator  erase(const_iterator first, const_iterator last);
+
+    void swap(augmented_skip_list_map &other) { impl.swap(other.impl); }
+
+    friend void swap(augmented_skip_list_map &lhs, augmented_skip_list_map &rhs) { lhs.swap(rhs); }
+
+    //======================================================================
+    // lookup
+
+    bool           contains(const key_type &key) const { return count(key) != 0; }
+    size_type      count(const key_type &key) const;
+
+    const_iterator find(const key_type &key) const;
+    const_iterator lower_bound(const key_type &key) const;
+    const_iterator upper_bound(const key_type &key) const;
+
+    //======================================================================
+    // aggregates
+
+    /// The Aggregator's result for the values of the keys in [lo, hi),
+    /// combined in key order. O(log n).
+    aggregate_type aggregate(const key_type &lo, const key_type &hi) const { return impl.aggregate(lo, hi); }
+
+    /// The Aggregator's result for every value. O(log n).
+    aggregate_type aggregate() const                                       { return impl.aggregate(); }
+
+    //======================================================================
+    // other operations
+
+    template <typename STREAM>
+    void dump(STREAM &stream) const { impl.dump(stream); }
+
+protected:
+    impl_type impl;
+
+    bool holds(const node_type *node, const key_type &key) const
+    {
+        return impl.is_valid(node) && detail::equivalent(node->value.first, key, impl.less);
+    }
+};
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - non-members
+
+namespace goodliffe {
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+bool operator==(const augmented_skip_list_map<K,T,AG,C,A,LG> &lhs, const augmented_skip_list_map<K,T,AG,C,A,LG> &rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+bool operator!=(const augmented_skip_list_map<K,T,AG,C,A,LG> &lhs, const augmented_skip_list_map<K,T,AG,C,A,LG> &rhs)
+{
+    return !operator==(lhs, rhs);
+}
+
+} // namespace goodliffe
+
+namespace std
+{
+    template <class K, class T, class AG, class C, class A, class LG>
+    void swap(goodliffe::augmented_skip_list_map<K,T,AG,C,A,LG> &lhs, goodliffe::augmented_skip_list_map<K,T,AG,C,A,LG> &rhs)
+    {
+        lhs.swap(rhs);
+    }
+}
+
+//==============================================================================
+#pragma mark - lifetime management
+//==============================================================================
+
+namespace goodliffe {
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG>::augmented_skip_list_map(const allocator_type &alloc_, const aggregator_type &aggregator_)
+:   impl(alloc_, aggregator_)
+{
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+template <class InputIterator>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG>::augmented_skip_list_map(InputIterator first, InputIterator last,
+                                                                const allocator_type &alloc_, const aggregator_type &aggregator_)
+:   impl(alloc_, aggregator_)
+{
+    assign(first, last);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG>::augmented_skip_list_map(const augmented_skip_list_map &other)
+:   impl(other.get_allocator(), other.get_aggregator())
+{
+    insert(other.begin(), other.end());
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG>::augmented_skip_list_map(augmented_skip_list_map &&other)
+:   impl(other.get_allocator(), other.get_aggregator())
+{
+    impl.swap(other.impl);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG>::augmented_skip_list_map(std::initializer_list<value_type> init,
+                                                                const allocator_type &alloc_, const aggregator_type &aggregator_)
+:   impl(alloc_, aggregator_)
+{
+    assign(init.begin(), init.end());
+}
+
+#endif
+
+//==============================================================================
+#pragma mark assignment
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG> &
+augmented_skip_list_map<K,T,AG,C,A,LG>::operator=(const augmented_skip_list_map &other)
+{
+    if (this != &other)
+    {
+        // The aggregates are computed afresh, so with the other's aggregator
+        impl.aggregator = other.impl.aggregator;
+        assign(other.begin(), other.end());
+    }
+    return *this;
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+augmented_skip_list_map<K,T,AG,C,A,LG> &
+augmented_skip_list_map<K,T,AG,C,A,LG>::operator=(augmented_skip_list_map &&other)
+{
+    if (this != &other)
+    {
+        impl.swap(other.impl);
+        other.clear();
+    }
+    return *this;
+}
+
+#endif
+
+template <class K, class T, class AG, class C, class A, class LG>
+template <typename InputIterator>
+inline
+void augmented_skip_list_map<K,T,AG,C,A,LG>::assign(InputIterator first, InputIterator last)
+{
+    clear();
+    insert(first, last);
+}
+
+//==============================================================================
+#pragma mark element access
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::const_reference
+augmented_skip_list_map<K,T,AG,C,A,LG>::front() const
+{
+    assert_that(!empty());
+    return impl.front()->value;
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::const_reference
+augmented_skip_list_map<K,T,AG,C,A,LG>::back() const
+{
+    assert_that(!empty());
+    return impl.one_past_end()->prev->value;
+}
+
+//==============================================================================
+#pragma mark modifiers
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+void augmented_skip_list_map<K,T,AG,C,A,LG>::clear()
+{
+    impl.remove_all();
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::insert_by_value_result
+augmented_skip_list_map<K,T,AG,C,A,LG>::insert(const value_type &value)
+{
+    bool inserted;
+    node_type *node = impl.insert(value, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+template <class InputIterator>
+inline
+void augmented_skip_list_map<K,T,AG,C,A,LG>::insert(InputIterator first, InputIterator last)
+{
+    while (first != last) insert(*first++);
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+void augmented_skip_list_map<K,T,AG,C,A,LG>::insert(std::initializer_list<value_type> ilist)
+{
+    insert(ilist.begin(), ilist.end());
+}
+
+#endif
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::iterator
+augmented_skip_list_map<K,T,AG,C,A,LG>::update(const key_type &key, const mapped_type &mapped)
+{
+    bool inserted;
+    node_type *node = impl.insert(value_type(key, mapped), &inserted);
+    if (!inserted) impl.update(node, mapped);
+    return iterator(&impl, node);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+void augmented_skip_list_map<K,T,AG,C,A,LG>::update(const_iterator position, const mapped_type &mapped)
+{
+    assert_that(impl.is_valid(position.get_node()));
+    impl.update(const_cast<node_type*>(position.get_node()), mapped);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::size_type
+augmented_skip_list_map<K,T,AG,C,A,LG>::erase(const key_type &key)
+{
+    node_type *node = impl.find(key);
+    if (!holds(node, key)) return 0;
+    impl.remove(node);
+    return 1;
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::iterator
+augmented_skip_list_map<K,T,AG,C,A,LG>::erase(const_iterator position)
+{
+    assert_that(impl.is_valid(position.get_node()));
+    node_type *node = const_cast<node_type*>(position.get_node());
+    node_type *next = node->next[0];
+    impl.remove(node);
+    return iterator(&impl, next);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::iterator
+augmented_skip_list_map<K,T,AG,C,A,LG>::erase(const_iterator first, const_iterator last)
+{
+    while (first != last) first = erase(first);
+    return last;
+}
+
+//==============================================================================
+#pragma mark lookup
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::size_type
+augmented_skip_list_map<K,T,AG,C,A,LG>::count(const key_type &key) const
+{
+    return holds(impl.find(key), key);
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::const_iterator
+augmented_skip_list_map<K,T,AG,C,A,LG>::find(const key_type &key) const
+{
+    const node_type *node = impl.find(key);
+    return holds(node, key) ? const_iterator(&impl, node) : end();
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::const_iterator
+augmented_skip_list_map<K,T,AG,C,A,LG>::lower_bound(const key_type &key) const
+{
+    return const_iterator(&impl, impl.lower_bound(key));
+}
+
+template <class K, class T, class AG, class C, class A, class LG>
+inline
+typename augmented_skip_list_map<K,T,AG,C,A,LG>::const_iterator
+augmented_skip_list_map<K,T,AG,C,A,LG>::upper_bound(const key_type &key) const
+{
+    return const_iterator(&impl, impl.find(key)->next[0]);
+}
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - asl_impl
+//==============================================================================
+
+namespace goodliffe {
+namespace detail {
+
+/// The alignment of T, the C++03 way.
+template <typename T>
+struct asl_alignment_of
+{
+    struct probe { char c; T t; };
+    static const std::size_t value = sizeof(probe) - sizeof(T);
+};
+
+template <typename T, typename Aggregate>
+struct asl_node
+{
+    typedef Aggregate aggregate_type;
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    unsigned    magic;
+#endif
+    T           value;
+    unsigned    level;
+    asl_node   *prev;
+    asl_node   *next[1]; ///< effectively node_type *next[level+1];
+                         ///< followed by aggregate_type aggregate[level+1];
+
+    /// aggregate()[l] combines the values after this node, up to and
+    /// including next[l]. A link to tail ends with the identity.
+    aggregate_type       *aggregate()       { return reinterpret_cast<aggregate_type*>(reinterpret_cast<char*>(this) + aggregate_offset(level)); }
+    const aggregate_type *aggregate() const { return reinterpret_cast<const aggregate_type*>(reinterpret_cast<const char*>(this) + aggregate_offset(level)); }
+
+    static std::size_t aggregate_offset(unsigned level)
+    {
+        const std::size_t align = asl_alignment_of<aggregate_type>::value;
+        return (sizeof(asl_node) + level*sizeof(asl_node*) + align-1) / align * align;
+    }
+
+    /// The number of bytes required for a node with the given level.
+    /// The next and aggregate arrays trail the node, in the same block.
+    static std::size_t bytes_for(unsigned level)
+        { return aggregate_offset(level) + (level+1)*sizeof(aggregate_type); }
+};
+
+/// Internal implementation of augmented_skip_list_map.
+///
+/// The search and link code is sl_impl's. On top of it, after any change
+/// the aggregates of the links that pass over it are recomputed, from the
+/// bottom level up. Each is combined from the links one level down that
+/// it spans, of which there are two on average, so that is O(log n) and
+/// needs no inverse (min and max have none).
+///
+/// @internal
+template <typename Key, typename Mapped, typename Aggregator,
+          typename Compare, typename Allocator, typename LevelGenerator>
+class asl_impl
+{
+public:
+
+    typedef std::pair<const Key, Mapped>              value_type;
+    typedef Key                                       key_type;
+    typedef Mapped                                    mapped_type;
+    typedef typename Allocator::size_type             size_type;
+    typedef typename Allocator::difference_type       difference_type;
+    typedef typename Allocator::const_reference       const_reference;
+    typedef typename Allocator::const_pointer         const_pointer;
+    typedef typename Allocator::reference             reference;
+    typedef typename Allocator::pointer               pointer;
+    typedef Allocator                                 allocator_type;
+    typedef Compare                                   compare_type;
+    typedef LevelGenerator                            generator_type;
+    typedef Aggregator                                aggregator_type;
+    typedef typename Aggregator::result_type          aggregate_type;
+    typedef asl_node<value_type, aggregate_type>      node_type;
+
+    static const unsigned num_levels = LevelGenerator::num_levels;
+
+    asl_impl(const Allocator &alloc = Allocator(), const Aggregator &aggregator = Aggregator());
+    ~asl_impl();
+
+    Allocator        get_allocator() const                 { return alloc; }
+    size_type        size() const                          { return item_count; }
+    bool             is_valid(const node_type *node) const { return node && node != head && node != tail; }
+    node_type       *front()                               { return head->next[0]; }
+    const node_type *front() const                         { return head->next[0]; }
+    node_type       *one_past_end()                        { return tail; }
+    const node_type *one_past_end() const                  { return tail; }
+    node_type       *find(const key_type &key) const;
+    node_type       *lower_bound(const key_type &key) const;
+    node_type       *insert(const value_type &value, bool *inserted = 0);
+    void             update(node_type *node, const mapped_type &mapped);
+    void             remove(node_type *node);
+    void             remove_all();
+    void             swap(asl_impl &other);
+
+    aggregate_type   aggregate(const key_type &lo, const key_type &hi) const;
+    aggregate_type   aggregate() const;
+
+    template <typename STREAM>
+    void        dump(STREAM &stream) const;
+    bool        check() const;
+    unsigned    new_level();
+
+    compare_type    less;
+    aggregator_type aggregator;
+
+private:
+    typedef typename Allocator::template rebind<char>::other node_allocator;
+
+    asl_impl(const asl_impl &other);
+    asl_impl &operator=(const asl_impl &other);
+
+    void find_chain(const key_type &key, node_type **chain) const;
+    void refresh(node_type **chain, node_type *new_node);
+    void recompute(node_type *node, unsigned level);
+
+    allocator_type  alloc;
+    generator_type  generator;
+    unsigned        levels;
+    node_type      *head;
+    node_type      *tail;
+    size_type       item_count;
+
+    node_type *allocate(unsigned level)
+    {
+        node_type *node = reinterpret_cast<node_type*>(
+            node_allocator(alloc).allocate(node_type::bytes_for(level), (void*)0));
+        node->level = level;
+        for (unsigned n = 0; n <= level; ++n) new (node->aggregate()+n) aggregate_type(aggregator.identity());
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+        for (unsigned n = 0; n <= level; ++n) node->next[n] = 0;
+        node->magic = MAGIC_GOOD;
+#endif
+        return node;
+    }
+
+    void deallocate(node_type *node)
+    {
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+        assert_that(node->magic == MAGIC_GOOD);
+        node->magic = MAGIC_BAD;
+        for (unsigned n = 0; n <= node->level; ++n) node->next[n] = 0;
+        node->prev = 0;
+#endif
+        for (unsigned n = 0; n <= node->level; ++n) node->aggregate()[n].~aggregate_type();
+        node_allocator(alloc).deallocate(reinterpret_cast<char*>(node), node_type::bytes_for(node->level));
+    }
+};
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+asl_impl<K,M,AG,C,A,LG>::asl_impl(const allocator_type &alloc_, const aggregator_type &aggregator_)
+:   aggregator(aggregator_),
+    alloc(alloc_),
+    levels(0),
+    head(allocate(num_levels)),
+    tail(allocate(num_levels)),
+    item_count(0)
+{
+    for (unsigned n = 0; n < num_levels; n++)
+    {
+        head->next[n] = tail;
+        tail->next[n] = 0;
+    }
+    head->prev = 0;
+    tail->prev = head;
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+asl_impl<K,M,AG,C,A,LG>::~asl_impl()
+{
+    remove_all();
+    deallocate(head);
+    deallocate(tail);
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+typename asl_impl<K,M,AG,C,A,LG>::node_type *
+asl_impl<K,M,AG,C,A,LG>::find(const key_type &key) const
+{
+    node_type *search = const_cast<node_type*>(head);
+    for (unsigned l = levels; l; )
+    {
+        --l;
+        while (search->next[l] != tail && detail::less_or_equal(search->next[l]->value.first, key, less))
+        {
+            search = search->next[l];
+        }
+    }
+    return search;
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+typename asl_impl<K,M,AG,C,A,LG>::node_type *
+asl_impl<K,M,AG,C,A,LG>::lower_bound(const key_type &key) const
+{
+    node_type *chain[num_levels];
+    chain[0] = head;
+    find_chain(key, chain);
+    return chain[0]->next[0];
+}
+
+/// Fill chain with the last node before key on each live level.
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::find_chain(const key_type &key, node_type **chain) const
+{
+    node_type *cur = head;
+    for (unsigned l = levels; l; )
+    {
+        --l;
+        while (cur->next[l] != tail && less(cur->next[l]->value.first, key))
+        {
+            cur = cur->next[l];
+        }
+        chain[l] = cur;
+    }
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+typename asl_impl<K,M,AG,C,A,LG>::node_type *
+asl_impl<K,M,AG,C,A,LG>::insert(const value_type &value, bool *inserted)
+{
+    node_type *chain[num_levels];
+    chain[0] = head;
+    find_chain(value.first, chain);
+
+    node_type *next = chain[0]->next[0];
+    if (next != tail && !less(value.first, next->value.first))
+    {
+        if (inserted) *inserted = false;
+        return next;
+    }
+
+    // new_level() may raise the list by one level, which starts at head
+    const unsigned old_levels = levels;
+    const unsigned level      = new_level();
+    for (unsigned l = old_levels; l < levels; ++l) chain[l] = head;
+
+    node_type *new_node = allocate(level);
+    alloc.construct(&new_node->value, value);
+    for (unsigned l = 0; l <= level; ++l)
+    {
+        new_node->next[l] = chain[l]->next[l];
+        chain[l]->next[l] = new_node;
+    }
+    new_node->prev          = chain[0];
+    new_node->next[0]->prev = new_node;
+    ++item_count;
+
+    refresh(chain, new_node);
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+    if (inserted) *inserted = true;
+    return new_node;
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::update(node_type *node, const mapped_type &mapped)
+{
+    assert_that(is_valid(node));
+    node->value.second = mapped;
+
+    node_type *chain[num_levels];
+    find_chain(node->value.first, chain);
+    refresh(chain, 0);
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::remove(node_type *node)
+{
+    assert_that(is_valid(node));
+
+    node_type *chain[num_levels];
+    find_chain(node->value.first, chain);
+
+    for (unsigned l = 0; l <= node->level; ++l)
+    {
+        assert_that(chain[l]->next[l] == node);
+        chain[l]->next[l] = node->next[l];
+    }
+    node->next[0]->prev = node->prev;
+
+    alloc.destroy(&node->value);
+    deallocate(node);
+    --item_count;
+
+    refresh(chain, 0);
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::remove_all()
+{
+    node_type *node = head->next[0];
+    while (node != tail)
+    {
+        node_type *next = node->next[0];
+        alloc.destroy(&node->value);
+        deallocate(node);
+        node = next;
+    }
+    node_pool_traits<allocator_type>::release_unused(alloc);
+
+    for (unsigned l = 0; l < levels; ++l)
+    {
+        head->next[l]         = tail;
+        head->aggregate()[l] = aggregator.identity();
+    }
+    tail->prev = head;
+    item_count = 0;
+    levels     = 0;
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+/// Bring up to date the aggregates that may have changed: on each level,
+/// the link from chain (and from new_node, when there is one) covers the
+/// change. Those one level down are already done by the time each level
+/// is reached.
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::refresh(node_type **chain, node_type *new_node)
+{
+    for (unsigned l = 0; l < levels; ++l)
+    {
+        if (new_node && l <= new_node->level) recompute(new_node, l);
+        recompute(chain[l], l);
+    }
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::recompute(node_type *node, unsigned level)
+{
+    const node_type *end = node->next[level];
+    if (level == 0)
+    {
+        node->aggregate()[0] = end == tail ? aggregator.identity() : aggregator(end->value.second);
+        return;
+    }
+
+    aggregate_type result = aggregator.identity();
+    for (const node_type *n = node; n != end; n = n->next[level-1])
+    {
+        result = aggregator(result, n->aggregate()[level-1]);
+    }
+    node->aggregate()[level] = result;
+}
+
+/// Start at the last node before lo, and fold in links while they end
+/// before hi: climbing while a taller link still fits, and descending
+/// when the current one goes too far. Like a finger search from lo to hi,
+/// that is expected O(log n) links.
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+typename asl_impl<K,M,AG,C,A,LG>::aggregate_type
+asl_impl<K,M,AG,C,A,LG>::aggregate(const key_type &lo, const key_type &hi) const
+{
+    aggregate_type result = aggregator.identity();
+    if (!levels || !less(lo, hi)) return result;
+
+    node_type *chain[num_levels];
+    find_chain(lo, chain);
+
+    const node_type *node = chain[0];
+    unsigned l = 0;
+    for (;;)
+    {
+        while (l+1 < levels && l < node->level
+               && node->next[l+1] != tail && less(node->next[l+1]->value.first, hi))
+        {
+            ++l;
+        }
+
+        const node_type *next = node->next[l];
+        if (next != tail && less(next->value.first, hi))
+        {
+            result = aggregator(result, node->aggregate()[l]);
+            node   = next;
+        }
+        else if (l)
+        {
+            --l;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return result;
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+typename asl_impl<K,M,AG,C,A,LG>::aggregate_type
+asl_impl<K,M,AG,C,A,LG>::aggregate() const
+{
+    aggregate_type result = aggregator.identity();
+    if (!levels) return result;
+
+    const unsigned l = levels-1;
+    for (const node_type *node = head; node != tail; node = node->next[l])
+    {
+        result = aggregator(result, node->aggregate()[l]);
+    }
+    return result;
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+unsigned asl_impl<K,M,AG,C,A,LG>::new_level()
+{
+    unsigned level = generator.new_level();
+    if (level >= levels)
+    {
+        level = levels;
+        if (levels < num_levels)
+        {
+            // Above the live levels head links straight to tail, and its
+            // aggregate is not kept up to date. Set it as the level comes
+            // alive.
+            assert_that(head->next[levels] == tail);
+            recompute(head, levels);
+            ++levels;
+        }
+        else --level;
+    }
+    return level;
+}
+
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+void asl_impl<K,M,AG,C,A,LG>::swap(asl_impl &other)
+{
+    using std::swap;
+
+    swap(alloc,      other.alloc);
+    swap(less,       other.less);
+    swap(aggregator, other.aggregator);
+    swap(generator,  other.generator);
+    swap(levels,     other.levels);
+    swap(head,       other.head);
+    swap(tail,       other.tail);
+    swap(item_count, other.item_count);
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+// for diagnostics only
+template <class K, class M, class AG, class C, class A, class LG>
+template <class STREAM>
+inline
+void asl_impl<K,M,AG,C,A,LG>::dump(STREAM &s) const
+{
+    s << "skip_list(size=" << item_count << ",levels=" << levels << ")\n";
+    for (unsigned l = 0; l < levels; ++l)
+    {
+        s << "  [" << l << "] ";
+        for (const node_type *n = head; n != tail; n = n->next[l])
+        {
+            if (is_valid(n))
+                s << n->value.first << " ";
+            else
+                s << "* ";
+            s << "(" << n->aggregate()[l] << ")> ";
+        }
+        s << "*\n";
+    }
+}
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+template <class K, class M, class AG, class C, class A, class LG>
+inline
+bool asl_impl<K,M,AG,C,A,LG>::check() const
+{
+    for (unsigned l = 0; l < levels; ++l)
+    {
+        size_type count = 0;
+        for (const node_type *n = head; n != tail; n = n->next[l])
+        {
+            if (n->magic != MAGIC_GOOD)
+            {
+                assert_that(false && "bad magic");
+                dump(std::cerr);
+                return false;
+            }
+            if (l == 0 && n->next[0]->prev != n)
+            {
+                assert_that(false && "chain error");
+                dump(std::cerr);
+                return false;
+            }
+            const node_type *next = n->next[l];
+            if (n != head && next != tail && !less(n->value.first, next->value.first))
+            {
+                assert_that(false && "value order error");
+                dump(std::cerr);
+                return false;
+            }
+            if (n != head) ++count;
+        }
+        if (l == 0 && count != item_count)
+        {
+            assert_that(false && "item count error");
+            dump(std::cerr);
+            return false;
+        }
+
+        // each aggregate must combine the values its link passes over
+        const node_type *from     = head;
+        aggregate_type   expected = aggregator.identity();
+        for (const node_type *n = head->next[0]; n; n = n->next[0])
+        {
+            if (n != tail)
+            {
+                expected = aggregator(expected, aggregator(n->value.second));
+                if (n->level < l) continue;
+            }
+            if (from->next[l] != n || !(from->aggregate()[l] == expected))
+            {
+                assert_that(false && "aggregate error");
+                dump(std::cerr);
+                return false;
+            }
+            from     = n;
+            expected = aggregator.identity();
+        }
+    }
+    return true;
+}
+#endif
+
+} // namespace detail
+} // namespace goodliffe
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
@@ -0,0 +1,717 @@
+//==============================================================================
+// concurrent_skip_list.h
+//==============================================================================
+
+#pragma once
+
+#include "skip_list_detail.h"
+#include "skip_list_epoch_reclaimer.h"
+
+#if !SKIP_LIST_CPP11
+#error "concurrent_skip_list needs C++11 (std::atomic and thread_local)"
+#endif
+
+#include <atomic>
+#include <cstdint>    // for std::uintptr_t
+#include <functional> // for std::less
+#include <memory>     // for std::allocator
+#include <new>        // for placement new
+#include <utility>    // for std::pair
+#include <vector>
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
+#endif
+
+//==============================================================================
+#pragma mark - internal forward declarations
+//==============================================================================
+
+namespace goodliffe {
+namespace detail
+{
+    template <typename T>
+    struct csl_node;
+
+    template <typename T, typename KeyType, typename Compare,
+              typename Allocator, typename LevelGenerator,
+              typename KeyFromValue>
+    class csl_impl;
+}
+}
+
+//==============================================================================
+#pragma mark - concurrent_skip_list
+//==============================================================================
+
+namespace goodliffe {
+
+/// A skip list that many threads can use at once, without locks.
+///
+/// Every member function except construction and destruction may be called
+/// concurrently from any number of threads. insert, erase and contains are
+/// lock-free: a thread that stalls, or is descheduled, mid-operation never
+/// stops any other thread from making progress. Readers never block.
+///
+/// The price of that is a smaller interface than skip_list. There are no
+/// iterators, since a node may be erased from under one at any moment.
+/// Instead, for_each visits the values in order under the protection of an
+/// epoch (see below). Values are immutable once inserted.
+///
+/// Towers are linked with compare-and-swap. An erase first marks each of
+/// the node's links as deleted, from the top down; a marked link can no
+/// longer be changed, so no insert can be lost after it. The node is then
+/// unlinked, by the eraser or by any other thread that passes it.
+///
+/// Erased nodes are not deallocated straight away, because another thread
+/// may still be looking at them. Every operation pins the current epoch of
+/// the list's epoch_reclaimer, which frees them once no thread can be. A
+/// thread that makes many calls can register with get_reclaimer() to make
+/// each of them a little cheaper:
+///
+///     epoch_reclaimer::registration registered(list.get_reclaimer());
+///
+/// size() is exact when the list is quiescent, and approximate otherwise.
+///
+/// @param T              Template type for kind of object held in the container.
+/// @param Compare        Template type describing the ordering comparator.
+/// @param Allocator      Template type for memory allocator for the contents of
+///                       the container. It must be safe to call from many
+///                       threads at once (std::allocator is;
+///                       skip_list_pool_allocator is not, and must not be
+///                       used here).
+/// @param LevelGenerator Each thread uses its own instance.
+///
+/// @see concurrent_skip_list_map
+/// @see skip_list
+template <typename T,
+          typename Compare         = std::less<T>,
+          typename Allocator       = std::allocator<T>,
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32> >
+class concurrent_skip_list
+{
+protected:
+    typedef typename detail::csl_impl<T,T,Compare,Allocator,LevelGenerator,detail::identity<T> > impl_type;
+
+public:
+
+    //======================================================================
+    // types
+
+    typedef T                                             value_type;
+    typedef Allocator                                     allocator_type;
+    typedef typename impl_type::size_type                 size_type;
+    typedef typename allocator_type::const_reference      const_reference;
+    typedef Compare                                       compare;
+
+    //======================================================================
+    // lifetime management
+
+    explicit concurrent_skip_list(const Allocator &alloc = Allocator()) : impl(alloc) {}
+
+    concurrent_skip_list(const concurrent_skip_list &) = delete;
+    concurrent_skip_list &operator=(const concurrent_skip_list &) = delete;
+
+    allocator_type get_allocator() const { return impl.get_allocator(); }
+
+    /// The reclaimer that frees erased nodes. Threads may register with it.
+    epoch_reclaimer &get_reclaimer() const { return impl.get_reclaimer(); }
+
+    //======================================================================
+    // capacity
+
+    bool      empty() const         { return impl.size() == 0; }
+    size_type size() const          { return impl.size(); }
+
+    //======================================================================
+    // modifiers
+
+    /// Returns true if value was inserted, false if an equivalent value
+    /// was already present.
+    bool      insert(const value_type &value)   { return impl.insert(value); }
+
+    /// Returns the number of values erased (0 or 1).
+    size_type erase(const value_type &value)    { return impl.erase(value); }
+
+    /// Erases every value. Values inserted concurrently may survive.
+    void      clear()                           { impl.clear(); }
+
+    //======================================================================
+    // lookup
+
+    bool      contains(const value_type &value) const { return impl.contains(value); }
+    size_type count(const value_type &value) const    { return impl.contains(value) ? 1 : 0; }
+
+    /// Call f(value) for each value, in order. Values inserted or erased
+    /// during the walk may or may not be seen. Each value is valid only
+    /// for the duration of its call.
+    template <typename Function>
+    void      for_each(Function f) const        { impl.for_each(f); }
+
+protected:
+    impl_type impl;
+};
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - concurrent_skip_list_map
+//==============================================================================
+
+namespace goodliffe {
+
+/// The concurrent_skip_list equivalent of skip_list_map.
+///
+/// Mapped values are copied out by find rather than referenced, since the
+/// node holding them may be erased and freed as soon as the call returns.
+/// To change a value, erase it and insert it again.
+///
+/// As for concurrent_skip_list, the allocator must be safe to call from
+/// many threads at once, so skip_list_pool_allocator must not be used.
+///
+/// @see concurrent_skip_list
+template <typename Key,
+          typename MappedTo,
+          typename KeyCompare      = std::less<Key>,
+          typename Allocator       = std::allocator<std::pair<const Key, MappedTo> >,
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32> >
+class concurrent_skip_list_map
+{
+public:
+
+    //======================================================================
+    // types
+
+    typedef Key                                           key_type;
+    typedef MappedTo                                      mapped_type;
+    typedef std::pair<const Key, MappedTo>                value_type;
+    typedef Allocator                                     allocator_type;
+
+protected:
+    typedef typename detail::csl_impl<value_type,Key,KeyCompare,Allocator,LevelGenerator,detail::select1st<value_type> > impl_type;
+
+public:
+    typedef typename impl_type::size_type                 size_type;
+    typedef KeyCompare                                    compare;
+
+    //======================================================================
+    // lifetime management
+
+    explicit concurrent_skip_list_map(const Allocator &alloc = Allocator()) : impl(alloc) {}
+
+    concurrent_skip_list_map(const concurrent_skip_list_map &) = delete;
+    concurrent_skip_list_map &operator=(const concurrent_skip_list_map &) = delete;
+
+    allocator_type get_allocator() const { return impl.get_allocator(); }
+
+    /// The reclaimer that frees erased nodes. Threads may register with it.
+    epoch_reclaimer &get_reclaimer() const { return impl.get_reclaimer(); }
+
+    //======================================================================
+    // capacity
+
+    bool      empty() const         { return impl.size() == 0; }
+    size_type size() const          { return impl.size(); }
+
+    //======================================================================
+    // modifiers
+
+    /// Returns true if value was inserted, false if its key was already
+    /// present (in which case the existing value is left alone).
+    bool      insert(const value_type &value)   { return impl.insert(value); }
+
+    /// Returns the number of values erased (0 or 1).
+    size_type erase(const key_type &key)        { return impl.erase(key); }
+
+    /// Erases every value. Values inserted concurrently may survive.
+    void      clear()                           { impl.clear(); }
+
+    //======================================================================
+    // lookup
+
+    bool      contains(const key_type &key) const { return impl.contains(key); }
+    size_type count(const key_type &key) const    { return impl.contains(key) ? 1 : 0; }
+
+    /// If key is present, copies its mapped value to result and returns
+    /// true. Otherwise returns false and leaves result alone.
+    bool      find(const key_type &key, mapped_type &result) const;
+
+    /// @see concurrent_skip_list::for_each
+    template <typename Function>
+    void      for_each(Function f) const        { impl.for_each(f); }
+
+protected:
+    impl_type impl;
+};
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool concurrent_skip_list_map<K,T,C,A,LG>::find(const key_type &key, mapped_type &result) const
+{
+    struct copy_mapped
+    {
+        mapped_type *result;
+        void operator()(const value_type &value) const { *result = value.second; }
+    };
+    copy_mapped copy = { &result };
+    return impl.find(key, copy);
+}
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - csl_impl
+//==============================================================================
+
+namespace goodliffe {
+namespace detail {
+
+/// A concurrent_skip_list node. The low bit of each next link marks the
+/// link as deleted.
+template <typename T>
+struct csl_node
+{
+    typedef csl_node<T> self_type;
+
+    enum
+    {
+        LINKED   = 1, ///< the inserter has finished with the node
+        UNLINKED = 2  ///< the eraser has finished with the node
+    };
+
+    T                          value;
+    unsigned                   level;
+    std::atomic<unsigned>      state;   ///< LINKED | UNLINKED: the last to finish retires it
+    std::atomic<std::uintptr_t> next[1]; ///< effectively next[level+1]
+
+    /// The number of bytes required for a node with the given level.
+    /// The next array trails the node, and is allocated in the same block.
+    static std::size_t bytes_for(unsigned level)
+        { return sizeof(self_type) + level*sizeof(std::atomic<std::uintptr_t>); }
+
+    static self_type     *ptr(std::uintptr_t link)    { return reinterpret_cast<self_type*>(link & ~std::uintptr_t(1)); }
+    static bool           marked(std::uintptr_t link) { return (link & 1) != 0; }
+    static std::uintptr_t link_to(self_type *node)    { return reinterpret_cast<std::uintptr_t>(node); }
+};
+
+/// Internal implementation of the concurrent skip list containers.
+///
+/// The lock-free algorithm follows Herlihy and Shavit ("The Art of
+/// Multiprocessor Programming", ch. 14) and Fraser ("Practical lock-freedom"),
+/// with null as the end of every level.
+///
+/// @internal
+template <typename T, typename KeyType, typename Compare,
+          typename Allocator, typename LevelGenerator,
+          typename KeyFromValue>
+class csl_impl
+{
+public:
+
+    typedef T                                   value_type;
+    typedef KeyType                             key_type;
+    typedef typename Allocator::size_type       size_type;
+    typedef Allocator                           allocator_type;
+    typedef Compare                             compare_type;
+    typedef LevelGenerator                      generator_type;
+    typedef csl_node<T>                         node_type;
+
+    static const unsigned num_levels = LevelGenerator::num_levels;
+
+    csl_impl(const Allocator &alloc = Allocator());
+    ~csl_impl();
+
+    Allocator   get_allocator() const { return alloc; }
+    epoch_reclaimer &get_reclaimer() const { return reclaimer; }
+    size_type   size() const          { return item_count.load(std::memory_order_relaxed); }
+
+    bool        insert(const value_type &value);
+    size_type   erase(const key_type &key);
+    void        clear();
+    bool        contains(const key_type &key) const;
+
+    /// If key is present, call f with its value and return true.
+    template <typename Function>
+    bool        find(const key_type &key, Function &f) const;
+
+    template <typename Function>
+    void        for_each(Function &f) const;
+
+    compare_type less;
+
+private:
+    typedef typename Allocator::template rebind<char>::other node_allocator;
+    typedef epoch_reclaimer::guard                           guard;
+
+    csl_impl(const csl_impl &other);
+    csl_impl &operator=(const csl_impl &other);
+
+    const key_type &key_of(const node_type *node) const { return KeyFromValue()(node->value); }
+
+    bool        find_path(const key_type &key, node_type **preds, node_type **succs) const;
+    node_type  *find_node(const key_type &key) const;
+    size_type   erase(const key_type &key, guard &g);
+    void        finished_with(node_type *node, unsigned state, guard &g);
+    unsigned    new_level();
+
+    node_type  *allocate(unsigned level);
+    void        deallocate(node_type *node);
+    static void free_nodes(void *impl, void **nodes, std::size_t count);
+
+    allocator_type          alloc;
+    node_type              *head;
+    std::atomic<unsigned>   levels;
+    std::atomic<size_type>  item_count;
+    mutable epoch_reclaimer reclaimer; ///< declared last, so its retired nodes go first
+};
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+csl_impl<T,K,C,A,LG,KFV>::csl_impl(const allocator_type &alloc_)
+:   alloc(alloc_),
+    head(allocate(num_levels-1)),
+    levels(1),
+    item_count(0)
+{
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+csl_impl<T,K,C,A,LG,KFV>::~csl_impl()
+{
+    // No other thread may be using the list now.
+    node_type *node = node_type::ptr(head->next[0].load(std::memory_order_acquire));
+    while (node)
+    {
+        node_type *next = node_type::ptr(node->next[0].load(std::memory_order_relaxed));
+        if (!node_type::marked(node->next[0].load(std::memory_order_relaxed)))
+        {
+            // marked nodes still linked here are freed by the reclaimer
+            deallocate(node);
+        }
+        node = next;
+    }
+    for (unsigned l = 0; l < num_levels; ++l) head->next[l].~atomic();
+    head->state.~atomic();
+    node_allocator(alloc).deallocate(reinterpret_cast<char*>(head), node_type::bytes_for(head->level));
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+typename csl_impl<T,K,C,A,LG,KFV>::node_type *
+csl_impl<T,K,C,A,LG,KFV>::allocate(unsigned level)
+{
+    node_type *node = reinterpret_cast<node_type*>(
+        node_allocator(alloc).allocate(node_type::bytes_for(level), (void*)0));
+    node->level = level;
+    new (&node->state) std::atomic<unsigned>(0);
+    for (unsigned l = 0; l <= level; ++l)
+    {
+        new (&node->next[l]) std::atomic<std::uintptr_t>(0);
+    }
+    return node;
+}
+
+/// Destroy the value and free the node. The head has no value, so does not
+/// come here.
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+void csl_impl<T,K,C,A,LG,KFV>::deallocate(node_type *node)
+{
+    std::allocator_traits<allocator_type>::destroy(alloc, &node->value);
+    for (unsigned l = 0; l <= node->level; ++l) node->next[l].~atomic();
+    node->state.~atomic();
+    node_allocator(alloc).deallocate(reinterpret_cast<char*>(node), node_type::bytes_for(node->level));
+}
+
+/// The reclaimer hands back erased nodes a batch at a time.
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+void csl_impl<T,K,C,A,LG,KFV>::free_nodes(void *impl, void **nodes, std::size_t count)
+{
+    csl_impl *self = static_cast<csl_impl*>(impl);
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        self->deallocate(static_cast<node_type*>(nodes[n]));
+    }
+}
+
+/// The level generator is not thread safe, so each thread has its own.
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+unsigned csl_impl<T,K,C,A,LG,KFV>::new_level()
+{
+    static thread_local generator_type generator;
+    const unsigned level = generator.new_level();
+    return level < num_levels ? level : num_levels-1;
+}
+
+/// Find the nodes either side of key on every live level, unlinking any
+/// marked node we pass on the way. Returns true if key is present.
+///
+/// If an unlink fails, something changed under us, so we start again.
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+bool csl_impl<T,K,C,A,LG,KFV>::find_path(const key_type &key, node_type **preds, node_type **succs) const
+{
+retry:
+    node_type *pred = head;
+    for (unsigned l = levels.load(std::memory_order_relaxed); l; )
+    {
+        --l;
+        node_type *curr = node_type::ptr(pred->next[l].load(std::memory_order_acquire));
+        while (curr)
+        {
+            std::uintptr_t succ = curr->next[l].load(std::memory_order_acquire);
+            if (node_type::marked(succ))
+            {
+                std::uintptr_t expected = node_type::link_to(curr);
+                if (!pred->next[l].compare_exchange_strong(expected, succ & ~std::uintptr_t(1),
+                                                           std::memory_order_acq_rel))
+                {
+                    goto retry;
+                }
+                curr = node_type::ptr(succ);
+                continue;
+            }
+            if (!less(key_of(curr), key)) break;
+            pred = curr;
+            curr = node_type::ptr(succ);
+        }
+        preds[l] = pred;
+        succs[l] = curr;
+    }
+    return succs[0] && !less(key, key_of(succs[0]));
+}
+
+/// Like find_path, but only reads: marked nodes are stepped over rather
+/// than unlinked. Returns the unmarked node holding key, or null.
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+typename csl_impl<T,K,C,A,LG,KFV>::node_type *
+csl_impl<T,K,C,A,LG,KFV>::find_node(const key_type &key) const
+{
+    node_type *pred = head;
+    node_type *curr = 0;
+    for (unsigned l = levels.load(std::memory_order_relaxed); l; )
+    {
+        --l;
+        curr = node_type::ptr(pred->next[l].load(std::memory_order_acquire));
+        while (curr)
+        {
+            std::uintptr_t succ = curr->next[l].load(std::memory_order_acquire);
+            if (!node_type::marked(succ) && !less(key_of(curr), key)) break;
+            if (!node_type::marked(succ)) pred = curr;
+            curr = node_type::ptr(succ);
+        }
+    }
+    return curr && !less(key, key_of(curr)) ? curr : 0;
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+bool csl_impl<T,K,C,A,LG,KFV>::insert(const value_type &value)
+{
+    guard g(reclaimer);
+
+    const unsigned level = new_level();
+    unsigned live = levels.load(std::memory_order_relaxed);
+    while (level >= live && !levels.compare_exchange_weak(live, level+1, std::memory_order_relaxed)) {}
+
+    node_type *new_node = allocate(level);
+    try
+    {
+        std::allocator_traits<allocator_type>::construct(alloc, &new_node->value, value);
+    }
+    catch (...)
+    {
+        for (unsigned l = 0; l <= level; ++l) new_node->next[l].~atomic();
+        new_node->state.~atomic();
+        node_allocator(alloc).deallocate(reinterpret_cast<char*>(new_node), node_type::bytes_for(level));
+        throw;
+    }
+    const key_type &key = key_of(new_node);
+
+    node_type *preds[num_levels];
+    node_type *succs[num_levels];
+
+    // Linking level 0 puts the node in the list
+    for (;;)
+    {
+        if (find_path(key, preds, succs))
+        {
+            deallocate(new_node); // never seen by anyone else
+            return false;
+        }
+        for (unsigned l = 0; l <= level; ++l)
+        {
+            new_node->next[l].store(node_type::link_to(succs[l]), std::memory_order_relaxed);
+        }
+        std::uintptr_t expected = node_type::link_to(succs[0]);
+        if (preds[0]->next[0].compare_exchange_strong(expected, node_type::link_to(new_node),
+                                                      std::memory_order_acq_rel))
+        {
+            break;
+        }
+    }
+    item_count.fetch_add(1, std::memory_order_relaxed);
+
+    // The rest of the tower is only a short cut, so we give up on it if the
+    // node is erased in the meantime.
+    for (unsigned l = 1; l <= level; ++l)
+    {
+        for (;;)
+        {
+            std::uintptr_t mine = new_node->next[l].load(std::memory_order_acquire);
+            if (node_type::marked(mine)) goto done;
+            if (mine != node_type::link_to(succs[l])
+                && !new_node->next[l].compare_exchange_strong(mine, node_type::link_to(succs[l]),
+                                                              std::memory_order_acq_rel))
+            {
+                goto done; // only an eraser's mark changes it
+            }
+
+            std::uintptr_t expected = node_type::link_to(succs[l]);
+            if (preds[l]->next[l].compare_exchange_strong(expected, node_type::link_to(new_node),
+                                                          std::memory_order_acq_rel))
+            {
+                break;
+            }
+
+            find_path(key, preds, succs);
+            if (succs[0] != new_node) goto done;
+        }
+    }
+
+done:
+    finished_with(new_node, node_type::LINKED, g);
+    return true;
+}
+
+/// The inserter of a node may still be linking its upper levels while an
+/// eraser unlinks it. Whichever of them finishes last sweeps the node out
+/// of every level once more (the other may have linked a level after the
+/// first sweep), and retires it.
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+void csl_impl<T,K,C,A,LG,KFV>::finished_with(node_type *node, unsigned state, guard &g)
+{
+    const unsigned other = state == node_type::LINKED ? node_type::UNLINKED : node_type::LINKED;
+    if (node->state.fetch_or(state, std::memory_order_acq_rel) & other)
+    {
+        node_type *preds[num_levels];
+        node_type *succs[num_levels];
+        find_path(key_of(node), preds, succs);
+        g.retire(node, &free_nodes, this);
+    }
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+typename csl_impl<T,K,C,A,LG,KFV>::size_type
+csl_impl<T,K,C,A,LG,KFV>::erase(const key_type &key)
+{
+    guard g(reclaimer);
+    return erase(key, g);
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+typename csl_impl<T,K,C,A,LG,KFV>::size_type
+csl_impl<T,K,C,A,LG,KFV>::erase(const key_type &key, guard &g)
+{
+    node_type *preds[num_levels];
+    node_type *succs[num_levels];
+    if (!find_path(key, preds, succs)) return 0;
+
+    node_type *node = succs[0];
+
+    // Mark the tower from the top down, so nothing more is linked to it...
+    for (unsigned l = node->level; l > 0; --l)
+    {
+        std::uintptr_t succ = node->next[l].load(std::memory_order_acquire);
+        while (!node_type::marked(succ)
+               && !node->next[l].compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel)) {}
+    }
+
+    // ...then level 0. Whoever marks that has erased the value.
+    std::uintptr_t succ = node->next[0].load(std::memory_order_acquire);
+    for (;;)
+    {
+        if (node_type::marked(succ)) return 0;
+        if (node->next[0].compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel)) break;
+    }
+    item_count.fetch_sub(1, std::memory_order_relaxed);
+
+    // Usually the inserter finished long ago, and one sweep will do
+    const bool linked = node->state.load(std::memory_order_acquire) & node_type::LINKED;
+    find_path(key, preds, succs);
+    if (linked)
+        g.retire(node, &free_nodes, this);
+    else
+        finished_with(node, node_type::UNLINKED, g);
+    return 1;
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+void csl_impl<T,K,C,A,LG,KFV>::clear()
+{
+    guard g(reclaimer);
+    for (;;)
+    {
+        node_type *first = node_type::ptr(head->next[0].load(std::memory_order_acquire));
+        while (first && node_type::marked(first->next[0].load(std::memory_order_acquire)))
+        {
+            first = node_type::ptr(first->next[0].load(std::memory_order_acquire));
+        }
+        if (!first) break;
+        erase(key_of(first), g);
+    }
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+inline
+bool csl_impl<T,K,C,A,LG,KFV>::contains(const key_type &key) const
+{
+    guard g(reclaimer);
+    return find_node(key) != 0;
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+template <typename Function>
+inline
+bool csl_impl<T,K,C,A,LG,KFV>::find(const key_type &key, Function &f) const
+{
+    guard g(reclaimer);
+    const node_type *node = find_node(key);
+    if (node) f(node->value);
+    return node != 0;
+}
+
+template <class T, class K, class C, class A, class LG, typename KFV>
+template <typename Function>
+inline
+void csl_impl<T,K,C,A,LG,KFV>::for_each(Function &f) const
+{
+    guard g(reclaimer);
+    const node_type *node = node_type::ptr(head->next[0].load(std::memory_order_acquire));
+    while (node)
+    {
+        const std::uintptr_t next = node->next[0].load(std::memory_order_acquire);
+        if (!node_type::marked(next)) f(node->value);
+        node = node_type::ptr(next);
+    }
+}
+
+} // namespace detail
+} // namespace goodliffe
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
@@ -25,7 +25,7 @@
 namespace goodliffe {
 namespace detail
 {
-    template <typename T,typename C,typename A,typename LG>
+    template <typename T,typename K,typename C,typename A,typename LG,bool D,typename KeyFromValue>
     class rasl_impl;
 
     template <typename LIST> class rasl_iterator;
@@ -54,12 +54,13 @@ namespace goodliffe {
 template <typename T,
           typename Compare        = std::less<T>,
           typename Allocator      = std::allocator<T>,
-          typename LevelGenerator = detail::skip_list_level_generator<32> >
+          typename LevelGenerator = detail::xorshift_skip_list_level_generator<32>,
+          bool AllowDuplicates    = false>
 class random_access_skip_list
 {
-private:
-    typedef typename detail::rasl_impl<T,Compare,Allocator,LevelGenerator> impl_type;
-    typedef typename impl_type::node_type                                  node_type;
+protected:
+    typedef typename detail::rasl_impl<T,T,Compare,Allocator,LevelGenerator,AllowDuplicates,detail::identity<T> > impl_type;
+    typedef typename impl_type::node_type                                                  node_type;
 
     template <typename T1> friend class detail::rasl_iterator;
     template <typename T1> friend class detail::rasl_const_iterator;
@@ -79,10 +80,10 @@ public:
     typedef typename allocator_type::const_pointer      const_pointer;
     typedef Compare                                     compare;
     
-    typedef typename detail::rasl_iterator<impl_type>   iterator;
-    typedef typename iterator::const_iterator           const_iterator;
-    typedef std::reverse_iterator<iterator>             reverse_iterator;
-    typedef std::reverse_iterator<const_iterator>       const_reverse_iterator;
+    typedef typename detail::rasl_const_iterator<impl_type> iterator;
+    typedef typename detail::rasl_const_iterator<impl_type> const_iterator;
+    typedef std::reverse_iterator<const_iterator>           reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>           const_reverse_iterator;
 
     //======================================================================
     // lifetime management
@@ -95,10 +96,11 @@ public:
     random_access_skip_list(const random_access_skip_list &other);
     random_access_skip_list(const random_access_skip_list &other, const Allocator &alloc);
 
-    // C++11
-    //random_access_skip_list(const random_access_skip_list &&other);
-    //random_access_skip_list(const random_access_skip_list &&other, const Allocator &alloc);
-    //random_access_skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+#if SKIP_LIST_CPP11
+    random_access_skip_list(random_access_skip_list &&other);
+    random_access_skip_list(random_access_skip_list &&other, const Allocator &alloc);
+    random_access_skip_list(std::initializer_list<value_type> init, const Allocator &alloc = Allocator());
+#endif
 
     allocator_type get_allocator() const { return impl.get_allocator(); }
 
@@ -106,11 +108,19 @@ public:
     // assignment
 
     random_access_skip_list &operator=(const random_access_skip_list &other);
-    //C++11 random_access_skip_list& operator=(random_access_skip_list&& other);
+#if SKIP_LIST_CPP11
+    random_access_skip_list &operator=(random_access_skip_list &&other);
+#endif
 
     template <typename InputIterator>
     void assign(InputIterator first, InputIterator last);
 
+    /// Replace the contents with [first,last), which must already be
+    /// sorted. The list is built in one pass, in linear time.
+    /// Of a run of equivalent values, only the first is kept.
+    template <typename InputIterator>
+    void assign_sorted(InputIterator first, InputIterator last);
+
     //======================================================================
     // element access
 
@@ -122,13 +132,13 @@ public:
     //======================================================================
     // iterators
 
-    iterator       begin()                  { return iterator(&impl, impl.front()); }
-    const_iterator begin() const            { return const_iterator(&impl, impl.front()); }
-    const_iterator cbegin() const           { return const_iterator(&impl, impl.front()); }
+    iterator       begin()                  { return iterator(&impl, impl.front(), 0); }
+    const_iterator begin() const            { return const_iterator(&impl, impl.front(), 0); }
+    const_iterator cbegin() const           { return const_iterator(&impl, impl.front(), 0); }
 
-    iterator       end()                    { return iterator(&impl, impl.one_past_end()); }
-    const_iterator end() const              { return const_iterator(&impl, impl.one_past_end()); }
-    const_iterator cend() const             { return const_iterator(&impl, impl.one_past_end()); }
+    iterator       end()                    { return iterator(&impl, impl.one_past_end(), impl.size()); }
+    const_iterator end() const              { return const_iterator(&impl, impl.one_past_end(), impl.size()); }
+    const_iterator cend() const             { return const_iterator(&impl, impl.one_past_end(), impl.size()); }
 
     reverse_iterator       rbegin()         { return reverse_iterator(end()); }
     const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
@@ -155,19 +165,43 @@ public:
     insert_by_value_result insert(const value_type &value);
     iterator insert(const_iterator hint, const value_type &value);
 
-    //C++11iterator insert(value_type &&value);
-    //C++11iterator insert(const_iterator hint, const value_type &&value);
+#if SKIP_LIST_CPP11
+    insert_by_value_result insert(value_type &&value);
+    iterator insert(const_iterator hint, value_type &&value);
+#endif
 
     template <class InputIterator>
     void insert(InputIterator first, InputIterator last);
 
-    //C++11iterator insert(std::initializer_list<value_type> ilist);
-    //C++11emplace
+#if SKIP_LIST_CPP11
+    void insert(std::initializer_list<value_type> ilist);
+
+    /// Construct a value in place from args, and insert it. The value is
+    /// discarded if an equivalent one is already present.
+    template <typename... Args>
+    insert_by_value_result emplace(Args&&... args);
+    template <typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
+#endif
 
     size_type erase(const value_type &value);
     iterator  erase(const_iterator position);
     iterator  erase(const_iterator first, const_iterator last);
 
+    /// Insert each value in [first, last), returning how many were added.
+    /// When they are sorted, each goes in from where the one before it
+    /// did, rather than from the front, so m of them cost O(m log(n/m))
+    /// rather than O(m log n); a batch as big as the list is just a linear
+    /// merge. Any order gives the right result, only more slowly.
+    template <typename InputIterator>
+    size_type insert_sorted_batch(InputIterator first, InputIterator last);
+
+    /// Erase the value equivalent to each of [first, last), returning how
+    /// many went. Sorted values are searched for from one another, as for
+    /// insert_sorted_batch, and the spans are kept up to date as it goes.
+    template <typename InputIterator>
+    size_type erase_sorted_batch(InputIterator first, InputIterator last);
+
     void swap(random_access_skip_list &other) { impl.swap(other.impl); }
 
     friend void swap(random_access_skip_list &lhs, random_access_skip_list &rhs) { lhs.swap(rhs); }
@@ -181,6 +215,23 @@ public:
     iterator       find(const value_type &value);
     const_iterator find(const value_type &value) const;
 
+    /// The returned iterators know their index, so index_of them is O(1).
+    iterator       lower_bound(const value_type &value);
+    const_iterator lower_bound(const value_type &value) const;
+    iterator       upper_bound(const value_type &value);
+    const_iterator upper_bound(const value_type &value) const;
+
+    /// Find each value in [first, last), writing the iterator find would
+    /// give for it to out. Returns out once past the last one written.
+    ///
+    /// The searches are interleaved, so that their cache misses overlap.
+    /// For a list much larger than the cache, that is quicker than calling
+    /// find for each value in turn.
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out);
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const;
+
     //======================================================================
     // random access
 
@@ -194,6 +245,13 @@ public:
 
     void erase_at(size_type index);
 
+    /// The number of values less than value: the index it has, or would
+    /// have, in the list. O(log n).
+    size_type rank(const value_type &value) const;
+
+    /// The number of values in [lo, hi). O(log n).
+    size_type count_range(const value_type &lo, const value_type &hi) const;
+
     //======================================================================
     // other operations
 
@@ -206,49 +264,155 @@ protected:
 
 } // namespace goodliffe
 
+//==============================================================================
+#pragma mark - random_access_multi_skip_list
+//==============================================================================
+
+namespace goodliffe {
+
+/// The random_access_multi_skip_list is to random_access_skip_list as
+/// multi_skip_list is to skip_list: it holds repeated values, and still
+/// provides O(log N) indexing, index_of and erase_at.
+///
+/// The spans count every node, so the values equivalent to one another
+/// occupy a run of indexes. equal_range finds both ends of the run in
+/// O(log N), and count is the difference between them, rather than a walk
+/// along the run.
+///
+/// A new value goes in before any values equivalent to it.
+///
+/// @see random_access_skip_list
+/// @see multi_skip_list
+template <typename T,
+          typename Compare        = std::less<T>,
+          typename Allocator      = std::allocator<T>,
+          typename LevelGenerator = detail::xorshift_skip_list_level_generator<32> >
+class random_access_multi_skip_list :
+    public random_access_skip_list<T,Compare,Allocator,LevelGenerator,true>
+{
+protected:
+    typedef random_access_skip_list<T,Compare,Allocator,LevelGenerator,true> parent_type;
+    using typename parent_type::node_type;
+    using typename parent_type::impl_type;
+    using parent_type::impl;
+
+public:
+
+    //======================================================================
+    // types
+
+    using typename parent_type::value_type;
+    using typename parent_type::allocator_type;
+    using typename parent_type::size_type;
+    using typename parent_type::difference_type;
+    using typename parent_type::reference;
+    using typename parent_type::const_reference;
+    using typename parent_type::pointer;
+    using typename parent_type::const_pointer;
+    using typename parent_type::compare;
+    using typename parent_type::iterator;
+    using typename parent_type::const_iterator;
+    using typename parent_type::reverse_iterator;
+    using typename parent_type::const_reverse_iterator;
+
+    typedef std::pair<size_type,size_type> index_range;
+
+    //======================================================================
+    // lifetime management
+
+    explicit random_access_multi_skip_list(const Allocator &alloc = Allocator())
+        : parent_type(alloc) {}
+    template <class InputIterator>
+    random_access_multi_skip_list(InputIterator first, InputIterator last, const Allocator &alloc = Allocator())
+        : parent_type(first, last, alloc) {}
+    random_access_multi_skip_list(const random_access_multi_skip_list &other)
+        : parent_type(other) {}
+    random_access_multi_skip_list(const random_access_multi_skip_list &other, const Allocator &alloc)
+        : parent_type(other, alloc) {}
+
+#if SKIP_LIST_CPP11
+    random_access_multi_skip_list(random_access_multi_skip_list &&other)
+        : parent_type(std::move(other)) {}
+    random_access_multi_skip_list(random_access_multi_skip_list &&other, const Allocator &alloc)
+        : parent_type(std::move(other), alloc) {}
+    random_access_multi_skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator())
+        : parent_type(init, alloc) {}
+
+    random_access_multi_skip_list &operator=(const random_access_multi_skip_list &other)
+        { parent_type::operator=(other); return *this; }
+    random_access_multi_skip_list &operator=(random_access_multi_skip_list &&other)
+        { parent_type::operator=(std::move(other)); return *this; }
+#endif
+
+    //======================================================================
+    // Overridden operations
+
+    /// Erase every value equivalent to value, in one pass.
+    size_type erase(const value_type &value);
+    using parent_type::erase;
+
+    /// Finds the first of the values equivalent to value.
+    iterator       find(const value_type &value);
+    const_iterator find(const value_type &value) const;
+
+    //======================================================================
+    // Additional "multi" operations
+
+    /// O(log n), however many there are.
+    size_type count(const value_type &value) const;
+
+    std::pair<iterator,iterator> equal_range(const value_type &value);
+    std::pair<const_iterator,const_iterator> equal_range(const value_type &value) const;
+
+    /// The indexes [first, second) of the values equivalent to value.
+    index_range equal_index_range(const value_type &value) const;
+};
+
+} // namespace goodliffe
+
 //==============================================================================
 #pragma mark - non-members
 
 namespace goodliffe {
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-bool operator==(const random_access_skip_list<T,C,A,LG> &lhs, const random_access_skip_list<T,C,A,LG> &rhs)
+bool operator==(const random_access_skip_list<T,C,A,LG,D> &lhs, const random_access_skip_list<T,C,A,LG,D> &rhs)
 {
     return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-bool operator!=(const random_access_skip_list<T,C,A,LG> &lhs, const random_access_skip_list<T,C,A,LG> &rhs)
+bool operator!=(const random_access_skip_list<T,C,A,LG,D> &lhs, const random_access_skip_list<T,C,A,LG,D> &rhs)
 {
     return !operator==(lhs, rhs);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-bool operator<(const random_access_skip_list<T,C,A,LG> &lhs, const random_access_skip_list<T,C,A,LG> &rhs)
+bool operator<(const random_access_skip_list<T,C,A,LG,D> &lhs, const random_access_skip_list<T,C,A,LG,D> &rhs)
 {
     return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-bool operator<=(const random_access_skip_list<T,C,A,LG> &lhs, const random_access_skip_list<T,C,A,LG> &rhs)
+bool operator<=(const random_access_skip_list<T,C,A,LG,D> &lhs, const random_access_skip_list<T,C,A,LG,D> &rhs)
 {
     return !(rhs < lhs);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-bool operator>(const random_access_skip_list<T,C,A,LG> &lhs, const random_access_skip_list<T,C,A,LG> &rhs)
+bool operator>(const random_access_skip_list<T,C,A,LG,D> &lhs, const random_access_skip_list<T,C,A,LG,D> &rhs)
 {
     return rhs < lhs;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-bool operator>=(const random_access_skip_list<T,C,A,LG> &lhs, const random_access_skip_list<T,C,A,LG> &rhs)
+bool operator>=(const random_access_skip_list<T,C,A,LG,D> &lhs, const random_access_skip_list<T,C,A,LG,D> &rhs)
 {
     return !(lhs < rhs);
 }
@@ -257,8 +421,8 @@ bool operator>=(const random_access_skip_list<T,C,A,LG> &lhs, const random_acces
 
 namespace std
 {
-    template <class T, class C, class A, class LG>
-    void swap(goodliffe::random_access_skip_list<T,C,A,LG> &lhs, goodliffe::random_access_skip_list<T,C,A,LG> &rhs)
+    template <class T, class C, class A, class LG, bool D>
+    void swap(goodliffe::random_access_skip_list<T,C,A,LG,D> &lhs, goodliffe::random_access_skip_list<T,C,A,LG,D> &rhs)
     {
         lhs.swap(rhs);
     }
@@ -276,8 +440,8 @@ class rasl_iterator
     : public std::iterator<std::random_access_iterator_tag,
                            typename RASL_IMPL::value_type,
                            typename RASL_IMPL::difference_type,
-                           typename RASL_IMPL::const_pointer,
-                           typename RASL_IMPL::const_reference>
+                           typename RASL_IMPL::pointer,
+                           typename RASL_IMPL::reference>
 {
 public:
     typedef RASL_IMPL                               impl_type;
@@ -285,45 +449,52 @@ public:
     typedef typename impl_type::node_type           node_type;
     typedef rasl_iterator<impl_type>                self_type;
 
+    typedef typename impl_type::size_type           size_type;
     typedef typename impl_type::difference_type     difference_type;
-    typedef typename impl_type::const_reference     const_reference;
-    typedef typename impl_type::const_pointer       const_pointer;
+    typedef typename impl_type::reference           reference;
+    typedef typename impl_type::pointer             pointer;
 
     rasl_iterator()
-        : impl(0), node(0) {}
+        : impl(0), node(0), cached_index(0), cached_version(0) {}
     rasl_iterator(impl_type *impl_, node_type *node_)
-        : impl(impl_), node(node_) {}
+        : impl(impl_), node(node_), cached_index(0), cached_version(0) {}
+    rasl_iterator(impl_type *impl_, node_type *node_, size_type index_)
+        : impl(impl_), node(node_), cached_index(index_), cached_version(impl_->version()) {}
     rasl_iterator(const rasl_iterator &other)
-        : impl(other.impl), node(other.node) {}
+        : impl(other.impl), node(other.node), cached_index(other.cached_index), cached_version(other.cached_version) {}
 
     self_type &operator++()
-        { node = node->next[0]; return *this; }
+        { node = node->next[0]; ++cached_index; return *this; }
     self_type operator++(int) // postincrement
-        { self_type old(*this); node = node->next[0]; return old; }
+        { self_type old(*this); operator++(); return old; }
 
     self_type &operator--()
-        { node = node->prev; return *this; }
+        { node = node->prev; --cached_index; return *this; }
     self_type operator--(int) // postdecrement
-        { self_type old(*this); node = node->prev; return old; }
+        { self_type old(*this); operator--(); return old; }
     
     self_type &operator+=(difference_type n)
-        { node = impl->at(impl->index_of(node)+n); return *this; }
+    {
+        if (n >= 0) { node = impl->advance(node, size_type(n)); cached_index += size_type(n); }
+        else        { cached_index = get_index() + n; node = impl->at(cached_index); }
+        return *this;
+    }
     self_type &operator-=(difference_type n)
-        { node = impl->at(impl->index_of(node)-n); return *this; }
+        { return operator+=(-n); }
 
     rasl_iterator operator+(difference_type rhs) const
         { return rasl_iterator(*this) += rhs; }
     rasl_iterator operator-(difference_type rhs) const
         { return rasl_iterator(*this) -= rhs; }
-    const_reference operator[](int index) const
+    reference operator[](int index) const
         { return *operator+(index); }
     bool operator<(const self_type &rhs) const
-        { return impl->index_of(node) < impl->index_of(rhs.node); }
+        { return get_index() < rhs.get_index(); }
     difference_type operator-(const self_type &rhs) const
-        { return impl->index_of(node) - impl->index_of(rhs.node); }
+        { return difference_type(get_index()) - difference_type(rhs.get_index()); }
 
-    const_reference operator*()  { return node->value; }
-    const_pointer   operator->() { return &(node->value); }
+    reference operator*() const  { return node->value; }
+    pointer   operator->() const { return &(node->value); }
     
     bool operator==(const self_type &rhs) const
         { return impl == rhs.impl && node == rhs.node; }
@@ -338,9 +509,25 @@ public:
     const impl_type *get_impl() const { return impl; } ///< @internal
     const node_type *get_node() const { return node; } ///< @internal
 
+    /// The iterator's index in the list. Cached until the list changes,
+    /// then found again by walking along the spans. @internal
+    size_type get_index() const
+    {
+        if (cached_version != impl->version())
+        {
+            cached_index   = impl->index_of(node);
+            cached_version = impl->version();
+        }
+        return cached_index;
+    }
+
 private:
-    impl_type *impl;
-    node_type *node;
+    friend class rasl_const_iterator<RASL_IMPL>;
+
+    impl_type             *impl;
+    node_type             *node;
+    mutable size_type      cached_index;   ///< valid while cached_version is current
+    mutable unsigned long  cached_version;
 };
 
 template <typename I>
@@ -362,33 +549,48 @@ public:
     typedef const typename impl_type::node_type node_type;
     typedef rasl_const_iterator<RASL_IMPL>      self_type;
 
+    typedef typename impl_type::size_type           size_type;
     typedef typename impl_type::difference_type     difference_type;
     typedef typename impl_type::const_reference     const_reference;
     typedef typename impl_type::const_pointer       const_pointer;
 
     rasl_const_iterator()
-        : impl(0), node(0) {}
+        : impl(0), node(0), cached_index(0), cached_version(0) {}
     rasl_const_iterator(const normal_iterator &i)
-        : impl(i.get_impl()), node(i.get_node()) {}
+        : impl(i.impl), node(i.node), cached_index(i.cached_index), cached_version(i.cached_version) {}
     rasl_const_iterator(const impl_type *impl_, node_type *node_)
-        : impl(impl_), node(node_) {}
+        : impl(impl_), node(node_), cached_index(0), cached_version(0) {}
+    rasl_const_iterator(const impl_type *impl_, node_type *node_, size_type index_)
+        : impl(impl_), node(node_), cached_index(index_), cached_version(impl_->version()) {}
     rasl_const_iterator(const rasl_const_iterator &other)
-        : impl(other.impl), node(other.node) {}
+        : impl(other.impl), node(other.node), cached_index(other.cached_index), cached_version(other.cached_version) {}
+    self_type &operator=(const self_type &other)
+    {
+        impl           = other.impl;
+        node           = other.node;
+        cached_index   = other.cached_index;
+        cached_version = other.cached_version;
+        return *this;
+    }
 
     self_type &operator++()
-        { node = node->next[0]; return *this; }
+        { node = node->next[0]; ++cached_index; return *this; }
     self_type operator++(int) // postincrement
-        { self_type old(*this); node = node->next[0]; return old; }
+        { self_type old(*this); operator++(); return old; }
 
     self_type &operator--()
-        { node = node->prev; return *this; }
+        { node = node->prev; --cached_index; return *this; }
     self_type operator--(int) // postdecrement
-        { self_type old(*this); node = node->prev; return old; }
+        { self_type old(*this); operator--(); return old; }
 
     self_type &operator+=(difference_type n)
-        { node = impl->at(impl->index_of(node)+n); return *this; }
+    {
+        if (n >= 0) { node = impl->advance(node, size_type(n)); cached_index += size_type(n); }
+        else        { cached_index = get_index() + n; node = impl->at(cached_index); }
+        return *this;
+    }
     self_type &operator-=(difference_type n)
-        { node = impl->at(impl->index_of(node)-n); return *this; }
+        { return operator+=(-n); }
 
     rasl_const_iterator operator+(difference_type rhs) const
         { return rasl_const_iterator(*this) += rhs; }
@@ -397,9 +599,9 @@ public:
     const_reference operator[](int index) const
         { return *operator+(index); }
     bool operator<(const self_type &rhs) const
-        { return impl->index_of(node) < impl->index_of(rhs.node); }
+        { return get_index() < rhs.get_index(); }
     difference_type operator-(const self_type &rhs) const
-        { return impl->index_of(node) - impl->index_of(rhs.node); }
+        { return difference_type(get_index()) - difference_type(rhs.get_index()); }
 
     const_reference operator*()  { return node->value; }
     const_pointer   operator->() { return &(node->value); }
@@ -417,9 +619,22 @@ public:
     const impl_type *get_impl() const { return impl; } ///< @internal
     const node_type *get_node() const { return node; } ///< @internal
 
+    /// @see rasl_iterator::get_index @internal
+    size_type get_index() const
+    {
+        if (cached_version != impl->version())
+        {
+            cached_index   = impl->index_of(node);
+            cached_version = impl->version();
+        }
+        return cached_index;
+    }
+
 private:
-    impl_type *impl;
-    node_type *node;
+    impl_type             *impl;
+    node_type             *node;
+    mutable size_type      cached_index;   ///< valid while cached_version is current
+    mutable unsigned long  cached_version;
 };
 
 template <typename I>
@@ -436,100 +651,150 @@ rasl_const_iterator<I> operator+(int lhs, rasl_const_iterator<I> rhs)
 
 namespace goodliffe {
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-random_access_skip_list<T,C,A,LG>::random_access_skip_list(const allocator_type &alloc_)
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(const allocator_type &alloc_)
 :   impl(alloc_)
 {
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 template <class InputIterator>
 inline
-random_access_skip_list<T,C,A,LG>::random_access_skip_list(InputIterator first, InputIterator last, const allocator_type &alloc_)
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(InputIterator first, InputIterator last, const allocator_type &alloc_)
 :   impl(alloc_)
 {
     assign(first, last);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-random_access_skip_list<T,C,A,LG>::random_access_skip_list(const random_access_skip_list &other)
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(const random_access_skip_list &other)
 :   impl(other.get_allocator())
-{    
-    assign(other.begin(), other.end());
+{
+    impl.assign_sorted(other.begin(), other.end());
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
+inline
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(const random_access_skip_list &other, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    impl.assign_sorted(other.begin(), other.end());
+}
+
+#if SKIP_LIST_CPP11
+
+template <class T, class C, class A, class LG, bool D>
+inline
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(random_access_skip_list &&other)
+:   impl(other.get_allocator())
+{
+    impl.swap(other.impl);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(random_access_skip_list &&other, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    // Nodes can only change hands if the allocators can free each other's
+    if (alloc_ == other.get_allocator())
+        impl.swap(other.impl);
+    else
+        impl.assign_sorted(other.begin(), other.end());
+}
+
+template <class T, class C, class A, class LG, bool D>
 inline
-random_access_skip_list<T,C,A,LG>::random_access_skip_list(const random_access_skip_list &other, const allocator_type &alloc_)
+random_access_skip_list<T,C,A,LG,D>::random_access_skip_list(std::initializer_list<value_type> init, const allocator_type &alloc_)
 :   impl(alloc_)
 {
-    assign(other.begin(), other.end());
+    assign(init.begin(), init.end());
 }
 
-// C++11
-//skip_list(const skip_list &&other);
-//skip_list(const skip_list &&other, const Allocator &alloc);
-//skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+#endif
 
 //==============================================================================
 #pragma mark assignment
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-random_access_skip_list<T,C,A,LG> &
-random_access_skip_list<T,C,A,LG>::operator=(const random_access_skip_list<T,C,A,LG> &other)
+random_access_skip_list<T,C,A,LG,D> &
+random_access_skip_list<T,C,A,LG,D>::operator=(const random_access_skip_list<T,C,A,LG,D> &other)
 {
-    assign(other.begin(), other.end());
+    if (this != &other) impl.assign_sorted(other.begin(), other.end());
     return *this;
 }
 
-//C++11 skip_list& operator=(skip_list&& other);
+#if SKIP_LIST_CPP11
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
+inline
+random_access_skip_list<T,C,A,LG,D> &
+random_access_skip_list<T,C,A,LG,D>::operator=(random_access_skip_list<T,C,A,LG,D> &&other)
+{
+    if (this != &other)
+    {
+        impl.swap(other.impl);
+        other.clear();
+    }
+    return *this;
+}
+
+#endif
+
+template <class T, class C, class A, class LG, bool D>
 template <typename InputIterator>
 inline
-void random_access_skip_list<T,C,A,LG>::assign(InputIterator first, InputIterator last)
+void random_access_skip_list<T,C,A,LG,D>::assign(InputIterator first, InputIterator last)
 {
     clear();
     while (first != last) insert(*first++);
 }
 
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator>
+inline
+void random_access_skip_list<T,C,A,LG,D>::assign_sorted(InputIterator first, InputIterator last)
+{
+    impl.assign_sorted(first, last);
+}
+
 //==============================================================================
 #pragma mark element access
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::reference
-random_access_skip_list<T,C,A,LG>::front()
+typename random_access_skip_list<T,C,A,LG,D>::reference
+random_access_skip_list<T,C,A,LG,D>::front()
 {
     assert_that(!empty());
     return impl.front()->value;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::const_reference
-random_access_skip_list<T,C,A,LG>::front() const
+typename random_access_skip_list<T,C,A,LG,D>::const_reference
+random_access_skip_list<T,C,A,LG,D>::front() const
 {
     assert_that(!empty());
     return impl.front()->value;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::reference
-random_access_skip_list<T,C,A,LG>::back()
+typename random_access_skip_list<T,C,A,LG,D>::reference
+random_access_skip_list<T,C,A,LG,D>::back()
 {
     assert_that(!empty());
     return impl.one_past_end()->prev->value;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::const_reference
-random_access_skip_list<T,C,A,LG>::back() const
+typename random_access_skip_list<T,C,A,LG,D>::const_reference
+random_access_skip_list<T,C,A,LG,D>::back() const
 {
     assert_that(!empty());
     return impl.one_past_end()->prev->value;
@@ -538,26 +803,27 @@ random_access_skip_list<T,C,A,LG>::back() const
 //==============================================================================
 #pragma mark modifiers
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-void random_access_skip_list<T,C,A,LG>::clear()
+void random_access_skip_list<T,C,A,LG,D>::clear()
 {
     impl.remove_all();
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::insert_by_value_result
-random_access_skip_list<T,C,A,LG>::insert(const value_type &value)
+typename random_access_skip_list<T,C,A,LG,D>::insert_by_value_result
+random_access_skip_list<T,C,A,LG,D>::insert(const value_type &value)
 {
-    node_type *node = impl.insert(value);
-    return std::make_pair(iterator(&impl, node), impl.is_valid(node));
+    bool inserted;
+    node_type *node = impl.insert(value, 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::iterator
-random_access_skip_list<T,C,A,LG>::insert(const_iterator hint, const value_type &value)
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::insert(const_iterator hint, const value_type &value)
 {
     assert_that(hint.get_impl() == &impl);
     
@@ -569,13 +835,40 @@ random_access_skip_list<T,C,A,LG>::insert(const_iterator hint, const value_type
         return iterator(&impl,impl.insert(value,const_cast<node_type*>(hint_node)));
 }
 
-//C++11iterator insert const_iterator pos, value_type &&value);
+#if SKIP_LIST_CPP11
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::insert_by_value_result
+random_access_skip_list<T,C,A,LG,D>::insert(value_type &&value)
+{
+    bool inserted;
+    node_type *node = impl.insert(std::move(value), 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::insert(const_iterator hint, value_type &&value)
+{
+    assert_that(hint.get_impl() == &impl);
+
+    const node_type *hint_node = hint.get_node();
+
+    if (impl.is_valid(hint_node) && detail::less_or_equal(value, hint_node->value, impl.less))
+        return iterator(&impl,impl.insert(std::move(value))); // bad hint, resort to "normal" insert
+    else
+        return iterator(&impl,impl.insert(std::move(value),const_cast<node_type*>(hint_node)));
+}
+
+#endif
+
+template <class T, class C, class A, class LG, bool D>
 template <class InputIterator>
 inline
 void
-random_access_skip_list<T,C,A,LG>::insert(InputIterator first, InputIterator last)
+random_access_skip_list<T,C,A,LG,D>::insert(InputIterator first, InputIterator last)
 {
     iterator last_inserted = end();
     while (first != last)
@@ -584,13 +877,43 @@ random_access_skip_list<T,C,A,LG>::insert(InputIterator first, InputIterator las
     }
 }
 
-//C++11iterator insert(std::initializer_list<value_type> ilist);
-// C++11 emplace
+#if SKIP_LIST_CPP11
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
+inline
+void
+random_access_skip_list<T,C,A,LG,D>::insert(std::initializer_list<value_type> ilist)
+{
+    insert(ilist.begin(), ilist.end());
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename... Args>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::insert_by_value_result
+random_access_skip_list<T,C,A,LG,D>::emplace(Args&&... args)
+{
+    bool inserted;
+    node_type *node = impl.emplace(0, &inserted, std::forward<Args>(args)...);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename... Args>
 inline
-typename random_access_skip_list<T,C,A,LG>::size_type
-random_access_skip_list<T,C,A,LG>::erase(const value_type &value)
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::emplace_hint(const_iterator hint, Args&&... args)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.emplace(const_cast<node_type*>(hint.get_node()), 0, std::forward<Args>(args)...));
+}
+
+#endif
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::erase(const value_type &value)
 {
     node_type *node = impl.find(value);
     if (impl.is_valid(node) && detail::equivalent(node->value, value, impl.less))
@@ -604,10 +927,10 @@ random_access_skip_list<T,C,A,LG>::erase(const value_type &value)
     }
 }    
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::iterator
-random_access_skip_list<T,C,A,LG>::erase(const_iterator position)
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::erase(const_iterator position)
 {
     assert_that(position.get_impl() == &impl);
     assert_that(impl.is_valid(position.get_node()));
@@ -617,10 +940,10 @@ random_access_skip_list<T,C,A,LG>::erase(const_iterator position)
     return iterator(&impl, next);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::iterator
-random_access_skip_list<T,C,A,LG>::erase(const_iterator first, const_iterator last)
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::erase(const_iterator first, const_iterator last)
 {
     assert_that(first.get_impl() == &impl);
     assert_that(last.get_impl() == &impl);
@@ -635,22 +958,40 @@ random_access_skip_list<T,C,A,LG>::erase(const_iterator first, const_iterator la
     return iterator(&impl, const_cast<node_type*>(last.get_node()));
 }
 
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::insert_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.insert_sorted(first, last);
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::erase_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.erase_sorted(first, last);
+}
+
 //==============================================================================
 #pragma mark lookup
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::size_type
-random_access_skip_list<T,C,A,LG>::count(const value_type &value) const
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::count(const value_type &value) const
 {
     const node_type *node = impl.find(value);
     return impl.is_valid(node) && detail::equivalent(node->value, value, impl.less);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::iterator
-random_access_skip_list<T,C,A,LG>::find(const value_type &value)
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::find(const value_type &value)
 {
     node_type *node = impl.find(value);
     return impl.is_valid(node) && detail::equivalent(node->value, value, impl.less)
@@ -658,106 +999,306 @@ random_access_skip_list<T,C,A,LG>::find(const value_type &value)
         : end();
 }
   
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::const_iterator
-random_access_skip_list<T,C,A,LG>::find(const value_type &value) const
+typename random_access_skip_list<T,C,A,LG,D>::const_iterator
+random_access_skip_list<T,C,A,LG,D>::find(const value_type &value) const
 {
     const node_type *node = impl.find(value);
     return impl.is_valid(node) && detail::equivalent(node->value, value, impl.less)
         ? const_iterator(&impl, node)
         : end();
 }
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::lower_bound(const value_type &value)
+{
+    size_type  index;
+    node_type *node = impl.lower_bound(value, &index);
+    return iterator(&impl, node, index);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::const_iterator
+random_access_skip_list<T,C,A,LG,D>::lower_bound(const value_type &value) const
+{
+    size_type        index;
+    const node_type *node = impl.lower_bound(value, &index);
+    return const_iterator(&impl, node, index);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::upper_bound(const value_type &value)
+{
+    size_type  index;
+    node_type *node = impl.upper_bound(value, &index);
+    return iterator(&impl, node, index);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::const_iterator
+random_access_skip_list<T,C,A,LG,D>::upper_bound(const value_type &value) const
+{
+    size_type        index;
+    const node_type *node = impl.upper_bound(value, &index);
+    return const_iterator(&impl, node, index);
+}
     
+template <class T, class C, class A, class LG, bool D>
+template <typename ForwardIterator, typename OutputIterator>
+inline
+OutputIterator random_access_skip_list<T,C,A,LG,D>::find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out)
+{
+    const value_type *values[impl_type::batch_width];
+    node_type        *nodes[impl_type::batch_width];
+    while (first != last)
+    {
+        unsigned count = 0;
+        for (; count < impl_type::batch_width && first != last; ++first) values[count++] = &*first;
+        impl.find_batch(values, nodes, count);
+        for (unsigned n = 0; n < count; ++n)
+        {
+            *out++ = impl.is_valid(nodes[n]) && detail::equivalent(nodes[n]->value, *values[n], impl.less)
+                         ? iterator(&impl, nodes[n])
+                         : end();
+        }
+    }
+    return out;
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename ForwardIterator, typename OutputIterator>
+inline
+OutputIterator random_access_skip_list<T,C,A,LG,D>::find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+{
+    const value_type *values[impl_type::batch_width];
+    node_type        *nodes[impl_type::batch_width];
+    while (first != last)
+    {
+        unsigned count = 0;
+        for (; count < impl_type::batch_width && first != last; ++first) values[count++] = &*first;
+        impl.find_batch(values, nodes, count);
+        for (unsigned n = 0; n < count; ++n)
+        {
+            *out++ = impl.is_valid(nodes[n]) && detail::equivalent(nodes[n]->value, *values[n], impl.less)
+                         ? const_iterator(&impl, nodes[n])
+                         : end();
+        }
+    }
+    return out;
+}
+
 //==============================================================================
 #pragma mark random access
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::const_reference
-random_access_skip_list<T,C,A,LG>::operator[](unsigned index) const
+typename random_access_skip_list<T,C,A,LG,D>::const_reference
+random_access_skip_list<T,C,A,LG,D>::operator[](unsigned index) const
 {
     const node_type *node = impl.at(index);
     assert_that(impl.is_valid(node));
     return node->value;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
 void
-random_access_skip_list<T,C,A,LG>::erase_at(size_type index)
+random_access_skip_list<T,C,A,LG,D>::erase_at(size_type index)
 {
     node_type *node = impl.at(index);
     assert_that(impl.is_valid(node));
     impl.remove(node);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::iterator
-random_access_skip_list<T,C,A,LG>::iterator_at(unsigned index)
+typename random_access_skip_list<T,C,A,LG,D>::iterator
+random_access_skip_list<T,C,A,LG,D>::iterator_at(unsigned index)
 {
     node_type *node = impl.at(index);
-    return iterator(&impl, node);
+    return iterator(&impl, node, index);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::const_iterator
-random_access_skip_list<T,C,A,LG>::iterator_at(unsigned index) const
+typename random_access_skip_list<T,C,A,LG,D>::const_iterator
+random_access_skip_list<T,C,A,LG,D>::iterator_at(unsigned index) const
 {
     const node_type *node = impl.at(index);
-    return const_iterator(&impl, node);
+    return const_iterator(&impl, node, index);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::index_of(const const_iterator &i) const
+{
+    return i.get_index();
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::rank(const value_type &value) const
+{
+    size_type index;
+    impl.lower_bound(value, &index);
+    return index;
+}
+
+template <class T, class C, class A, class LG, bool D>
 inline
-typename random_access_skip_list<T,C,A,LG>::size_type
-random_access_skip_list<T,C,A,LG>::index_of(const const_iterator &i) const
+typename random_access_skip_list<T,C,A,LG,D>::size_type
+random_access_skip_list<T,C,A,LG,D>::count_range(const value_type &lo, const value_type &hi) const
 {
-    return impl.index_of(i.get_node());
+    if (!impl.less(lo, hi)) return 0;
+    return rank(hi) - rank(lo);
 }
 
 } // namespace goodliffe
 
 //==============================================================================
-#pragma mark - rasl_impl
+#pragma mark - random_access_multi_skip_list
 //==============================================================================
 
 namespace goodliffe {
-namespace detail {
 
-template <typename T, typename SPAN>
-struct rasl_node
+template <class T, class C, class A, class LG>
+inline
+typename random_access_multi_skip_list<T,C,A,LG>::index_range
+random_access_multi_skip_list<T,C,A,LG>::equal_index_range(const value_type &value) const
 {
-    typedef SPAN size_type;
-    
-#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-    unsigned    magic;
-#endif
-    T           value;
-    unsigned    level;
-    rasl_node  *prev;
-    rasl_node **next; ///< effectively node_type *next[level+1];
-    size_type  *span; ///< effectively unsigned span[level+1];
-};
+    index_range range;
+    impl.lower_bound(value, &range.first);
+    impl.upper_bound(value, &range.second);
+    return range;
+}
 
-/// Internal implementation of skip_list data structure and methods for
-/// modifying it.
-///
-/// Not for "public" access.
-///
-/// @internal
-template <typename T, typename Compare, typename Allocator, typename LevelGenerator>
-class rasl_impl
-{
+template <class T, class C, class A, class LG>
+inline
+typename random_access_multi_skip_list<T,C,A,LG>::size_type
+random_access_multi_skip_list<T,C,A,LG>::count(const value_type &value) const
+{
+    const index_range range = equal_index_range(value);
+    return range.second - range.first;
+}
+
+template <class T, class C, class A, class LG>
+inline
+std::pair
+    <
+        typename random_access_multi_skip_list<T,C,A,LG>::iterator,
+        typename random_access_multi_skip_list<T,C,A,LG>::iterator
+    >
+random_access_multi_skip_list<T,C,A,LG>::equal_range(const value_type &value)
+{
+    return std::make_pair(this->lower_bound(value), this->upper_bound(value));
+}
+
+template <class T, class C, class A, class LG>
+inline
+std::pair
+    <
+        typename random_access_multi_skip_list<T,C,A,LG>::const_iterator,
+        typename random_access_multi_skip_list<T,C,A,LG>::const_iterator
+    >
+random_access_multi_skip_list<T,C,A,LG>::equal_range(const value_type &value) const
+{
+    return std::make_pair(this->lower_bound(value), this->upper_bound(value));
+}
+
+template <class T, class C, class A, class LG>
+inline
+typename random_access_multi_skip_list<T,C,A,LG>::iterator
+random_access_multi_skip_list<T,C,A,LG>::find(const value_type &value)
+{
+    iterator i = this->lower_bound(value);
+    return i != this->end() && !impl.less(value, *i) ? i : this->end();
+}
+
+template <class T, class C, class A, class LG>
+inline
+typename random_access_multi_skip_list<T,C,A,LG>::const_iterator
+random_access_multi_skip_list<T,C,A,LG>::find(const value_type &value) const
+{
+    const_iterator i = this->lower_bound(value);
+    return i != this->end() && !impl.less(value, *i) ? i : this->end();
+}
+
+template <class T, class C, class A, class LG>
+inline
+typename random_access_multi_skip_list<T,C,A,LG>::size_type
+random_access_multi_skip_list<T,C,A,LG>::erase(const value_type &value)
+{
+    size_type  first_index, last_index;
+    node_type *first = impl.lower_bound(value, &first_index);
+    node_type *last  = impl.upper_bound(value, &last_index);
+    if (first == last) return 0;
+
+    impl.remove_between(first, last->prev);
+    return last_index - first_index;
+}
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - rasl_impl
+//==============================================================================
+
+namespace goodliffe {
+namespace detail {
+
+template <typename T, typename SPAN>
+struct rasl_node
+{
+    typedef SPAN size_type;
+    
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    unsigned    magic;
+#endif
+    T           value;
+    unsigned    level;
+    rasl_node  *prev;
+    rasl_node  *next[1]; ///< effectively node_type *next[level+1];
+                         ///< followed by size_type span[level+1];
+
+    size_type       *span()       { return reinterpret_cast<size_type*>(next+level+1); }
+    const size_type *span() const { return reinterpret_cast<const size_type*>(next+level+1); }
+
+    /// The number of bytes required for a node with the given level.
+    /// The next and span arrays trail the node, in the same block.
+    static std::size_t bytes_for(unsigned level)
+        { return sizeof(rasl_node) + level*sizeof(rasl_node*) + (level+1)*sizeof(size_type); }
+};
+
+/// Internal implementation of skip_list data structure and methods for
+/// modifying it.
+///
+/// Not for "public" access.
+///
+/// @internal
+template <typename T, typename KeyType, typename Compare,
+          typename Allocator, typename LevelGenerator,
+          bool AllowDuplicates, typename KeyFromValue>
+class rasl_impl
+{
 public:
     
     typedef T                                   value_type;
+    typedef KeyType                             key_type;
     typedef typename Allocator::size_type       size_type;
     typedef typename Allocator::difference_type difference_type;
     typedef typename Allocator::const_reference const_reference;
     typedef typename Allocator::const_pointer   const_pointer;
+    typedef typename Allocator::reference       reference;
+    typedef typename Allocator::pointer         pointer;
     typedef Allocator                           allocator_type;
     typedef Compare                             compare_type;
     typedef LevelGenerator                      generator_type;    
@@ -765,6 +1306,13 @@ public:
 
     static const unsigned num_levels = LevelGenerator::num_levels;
 
+    /// The number of searches find_batch runs side by side.
+    static const unsigned batch_width = 16;
+
+    /// Below this size, the list probably fits in the cache, and
+    /// find_batch just calls lower_bound for each key.
+    static const unsigned batch_threshold = 16384;
+
     rasl_impl(const Allocator &alloc = Allocator());
     ~rasl_impl();
 
@@ -775,15 +1323,32 @@ public:
     const node_type *front() const                         { return head->next[0]; }
     node_type       *one_past_end()                        { return tail; }
     const node_type *one_past_end() const                  { return tail; }
-    node_type       *find(const value_type &value) const;
+    node_type       *find(const key_type &key) const;
+    node_type       *lower_bound(const key_type &key, size_type *index = 0) const;
+    node_type       *upper_bound(const key_type &key, size_type *index = 0) const;
+    void             find_batch(const key_type * const *keys, node_type **results, unsigned count) const;
     node_type       *at(size_type index);
     const node_type *at(size_type index) const;
-    node_type       *insert(const value_type &value, node_type *hint = 0);
+    node_type       *insert(const value_type &value, node_type *hint = 0, bool *inserted = 0);
+#if SKIP_LIST_CPP11
+    node_type       *insert(value_type &&value, node_type *hint = 0, bool *inserted = 0);
+    template <typename... Args>
+    node_type       *emplace(node_type *hint, bool *inserted, Args&&... args);
+#endif
     void             remove(node_type *value);
     void             remove_all();
     void             remove_between(node_type *first, node_type *last);
     void             swap(rasl_impl &other);
     size_type        index_of(const node_type *node) const;
+    node_type       *advance(const node_type *node, size_type n) const;
+    unsigned long    version() const                       { return modifications; }
+
+    template <typename InputIterator>
+    void             assign_sorted(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    size_type        insert_sorted(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    size_type        erase_sorted(InputIterator first, InputIterator last);
 
     template <typename STREAM>
     void        dump(STREAM &stream) const;
@@ -793,17 +1358,22 @@ public:
     compare_type less;
 
 private:
-    typedef typename Allocator::template rebind<node_type>::other    node_allocator;
-    typedef typename Allocator::template rebind<node_type*>::other   list_allocator;
-    typedef typename Allocator::template rebind<size_type>::other    span_allocator;
+    typedef typename Allocator::template rebind<char>::other         node_allocator;
 
     rasl_impl(const rasl_impl &other);
     rasl_impl &operator=(const rasl_impl &other);
     
-    size_type find_chain(const value_type &value, node_type **chain) const;
-    size_type find_chain(const value_type &value, node_type **chain, size_type *indexes) const;
+    size_type find_chain(const key_type &key, node_type **chain, size_type *indexes) const;
     size_type find_chain(const node_type *node, node_type **chain, size_type *indexes) const;
     size_type find_end_chain(node_type **chain, size_type *indexes) const;
+    size_type find_index_chain(size_type index, node_type **chain, size_type *indexes) const;
+    size_type advance_chain(const key_type &key, node_type **chain, size_type *indexes, unsigned &chained) const;
+    unsigned  new_level(node_type **chain, size_type *indexes);
+    unsigned  draw_level();
+    void      raise_levels(unsigned level, node_type **chain, size_type *indexes);
+    node_type *find_duplicate(const key_type &key, node_type **chain) const;
+    void       link(node_type *new_node, node_type **chain, size_type *indexes, size_type index);
+    void       unlink(node_type *node, node_type **chain);
 
     allocator_type  alloc;
     generator_type  generator;
@@ -811,14 +1381,14 @@ private:
     node_type      *head;
     node_type      *tail;
     size_type       item_count;
+    unsigned long   modifications; ///< bumped on every change; see version()
         
     node_type *allocate(unsigned level)
     {
-        node_type *node = node_allocator(alloc).allocate(1, (void*)0);
-        node->next  = list_allocator(alloc).allocate(level+1, (void*)0);
-        node->span  = span_allocator(alloc).allocate(level+1, (void*)0);
+        node_type *node = reinterpret_cast<node_type*>(
+            node_allocator(alloc).allocate(node_type::bytes_for(level), (void*)0));
         node->level = level;
-        for (unsigned n = 0; n <= level; ++n) node->span[n] = 1;
+        for (unsigned n = 0; n <= level; ++n) node->span()[n] = 1;
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
         for (unsigned n = 0; n <= level; ++n) node->next[n] = 0;
         node->magic = MAGIC_GOOD;
@@ -834,51 +1404,50 @@ private:
         for (unsigned n = 0; n <= node->level; ++n) node->next[n] = 0;
         node->prev = 0;
 #endif
-        span_allocator(alloc).deallocate(node->span, node->level+1);
-        list_allocator(alloc).deallocate(node->next, node->level+1);
-        node_allocator(alloc).deallocate(node, 1);
+        node_allocator(alloc).deallocate(reinterpret_cast<char*>(node), node_type::bytes_for(node->level));
     }
 };
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-rasl_impl<T,C,A,LG>::rasl_impl(const allocator_type &alloc_)
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::rasl_impl(const allocator_type &alloc_)
 :   alloc(alloc_),
     levels(0),
     head(allocate(num_levels)),
     tail(allocate(num_levels)),
-    item_count(0)
+    item_count(0),
+    modifications(1)
 {
     for (unsigned n = 0; n < num_levels; n++)
     {
         head->next[n] = tail;
         tail->next[n] = 0;
-        head->span[n] = 1;
+        head->span()[n] = 1;
     }
     head->prev = 0;
     tail->prev = head;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-rasl_impl<T,C,A,LG>::~rasl_impl()
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::~rasl_impl()
 {
     remove_all();
     deallocate(head);
     deallocate(tail);
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::node_type *
-rasl_impl<T,C,A,LG>::find(const value_type &value) const
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find(const key_type &key) const
 {
     // I could have a const and non-const overload, but this cast is simpler
     node_type *search = const_cast<node_type*>(head);
     for (unsigned l = levels; l; )
     {
         --l;
-        while (search->next[l] != tail && detail::less_or_equal(search->next[l]->value, value, less))
+        while (search->next[l] != tail && detail::less_or_equal(KeyFromValue()(search->next[l]->value), key, less))
         {
             search = search->next[l];
         }
@@ -886,21 +1455,126 @@ rasl_impl<T,C,A,LG>::find(const value_type &value) const
     return search;
 }
 
-template <class T, class C, class A, class LG>
+/// Returns the first node whose key is not less than key. If index is
+/// given, it is set to that node's index, which is also the number of
+/// nodes before key: the spans passed on the way down add up to it.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::size_type
-rasl_impl<T,C,A,LG>::find_chain(const value_type &value, node_type **chain, size_type *indexes) const
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::lower_bound(const key_type &key, size_type *index) const
+{
+    size_type  position = 0;
+    node_type *search   = const_cast<node_type*>(head);
+    for (unsigned l = levels; l; )
+    {
+        --l;
+        while (search->next[l] != tail && less(KeyFromValue()(search->next[l]->value), key))
+        {
+            position += search->span()[l];
+            search    = search->next[l];
+        }
+    }
+    if (index) *index = position;
+    return search->next[0];
+}
+
+/// Returns the first node whose key is greater than key, and its index as
+/// for lower_bound. Between the two bounds lie the index range of the
+/// values equivalent to key.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::upper_bound(const key_type &key, size_type *index) const
+{
+    size_type  position = 0;
+    node_type *search   = const_cast<node_type*>(head);
+    for (unsigned l = levels; l; )
+    {
+        --l;
+        while (search->next[l] != tail && detail::less_or_equal(KeyFromValue()(search->next[l]->value), key, less))
+        {
+            position += search->span()[l];
+            search    = search->next[l];
+        }
+    }
+    if (index) *index = position;
+    return search->next[0];
+}
+
+/// Does lower_bound for count values at once, interleaving the searches so
+/// that their cache misses overlap. Unlike sl_impl::find_batch, this lands
+/// on the first of a run of equivalents, which is what find gives in a
+/// random_access_multi_skip_list as well as in a random_access_skip_list.
+/// @see sl_impl::find_batch
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+void rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find_batch(const key_type * const *keys, node_type **results, unsigned count) const
+{
+    if (item_count < batch_threshold)
+    {
+        for (unsigned n = 0; n < count; ++n) results[n] = lower_bound(*keys[n]);
+        return;
+    }
+
+    node_type *search[batch_width];
+    unsigned   level[batch_width];
+
+    for (unsigned done = 0; done < count; done += batch_width)
+    {
+        const unsigned width = count-done < batch_width ? count-done : batch_width;
+        unsigned       active = 0;
+        for (unsigned n = 0; n < width; ++n)
+        {
+            search[n] = const_cast<node_type*>(head);
+            level[n]  = levels;
+            if (level[n]) ++active;
+        }
+
+        while (active)
+        {
+            for (unsigned n = 0; n < width; ++n)
+            {
+                if (!level[n]) continue;
+
+                const unsigned l = level[n]-1;
+                node_type *next = search[n]->next[l];
+                if (next != tail && less(KeyFromValue()(next->value), *keys[done+n]))
+                {
+                    search[n] = next;
+                    SKIP_LIST_PREFETCH(next->next[l]);
+                }
+                else if (--level[n])
+                {
+                    SKIP_LIST_PREFETCH(search[n]->next[l-1]);
+                }
+                else
+                {
+                    --active;
+                }
+            }
+        }
+
+        for (unsigned n = 0; n < width; ++n) results[done+n] = search[n]->next[0];
+    }
+}
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find_chain(const key_type &key, node_type **chain, size_type *indexes) const
 {
     size_type index = 0;
     node_type *cur = head;
-    unsigned l = num_levels;
+    unsigned l = levels;
+    chain[0]   = head; // for an empty list, with no levels yet
+    indexes[0] = 0;
     while (l)
     {
         --l;
         impl_assert_that(l <= cur->level);
-        while (cur->next[l] != tail && less(cur->next[l]->value, value))
+        while (cur->next[l] != tail && less(KeyFromValue()(cur->next[l]->value), key))
         {
-            index += cur->span[l];
+            index += cur->span()[l];
             cur = cur->next[l];
             impl_assert_that(l <= cur->level);
         }
@@ -909,7 +1583,7 @@ rasl_impl<T,C,A,LG>::find_chain(const value_type &value, node_type **chain, size
     }
     
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-    for (unsigned l1 = 0; l1 < num_levels; ++l1)
+    for (unsigned l1 = 0; l1 < levels; ++l1)
     {
         assert_that(chain[l1]->level >= l1);
     }
@@ -919,24 +1593,26 @@ rasl_impl<T,C,A,LG>::find_chain(const value_type &value, node_type **chain, size
 }
 
 // TODO: fold these down
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::size_type
-rasl_impl<T,C,A,LG>::find_chain(const node_type *node, node_type **chain, size_type *indexes) const
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find_chain(const node_type *node, node_type **chain, size_type *indexes) const
 {
     assert_that(node && node != head);
     if (node == tail) return find_end_chain(chain, indexes);
     assert_that(is_valid(node));
+    // Comparing values can't tell node from its equivalents
+    if (D) return find_index_chain(index_of(node), chain, indexes);
     size_type index = 0;
     node_type *cur = head;
-    unsigned l = num_levels;
+    unsigned l = levels;
     while (l)
     {
         --l;
         impl_assert_that(l <= cur->level);
-        while (cur->next[l] != tail && less(cur->next[l]->value, node->value))
+        while (cur->next[l] != tail && less(KeyFromValue()(cur->next[l]->value), KeyFromValue()(node->value)))
         {
-            index += cur->span[l];
+            index += cur->span()[l];
             cur = cur->next[l];
             impl_assert_that(l <= cur->level);
         }
@@ -944,7 +1620,7 @@ rasl_impl<T,C,A,LG>::find_chain(const node_type *node, node_type **chain, size_t
         indexes[l] = index;
     }
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-    for (unsigned l1 = 0; l1 < num_levels; ++l1)
+    for (unsigned l1 = 0; l1 < levels; ++l1)
     {
         assert_that(chain[l1]->level >= l1);
     }
@@ -953,21 +1629,21 @@ rasl_impl<T,C,A,LG>::find_chain(const node_type *node, node_type **chain, size_t
 }
 
 // TODO: fold these down, up, sideways
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::size_type
-rasl_impl<T,C,A,LG>::find_end_chain(node_type **chain, size_type *indexes) const
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find_end_chain(node_type **chain, size_type *indexes) const
 {
     size_type index = 0;
     node_type *cur = head;
-    unsigned l = num_levels;
+    unsigned l = levels;
     while (l)
     {
         --l;
         impl_assert_that(l <= cur->level);
         while (cur->next[l] != tail)
         {
-            index += cur->span[l];
+            index += cur->span()[l];
             cur = cur->next[l];
             impl_assert_that(l <= cur->level);
         }
@@ -975,7 +1651,7 @@ rasl_impl<T,C,A,LG>::find_end_chain(node_type **chain, size_type *indexes) const
         indexes[l] = index;
     }
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-    for (unsigned l1 = 0; l1 < num_levels; ++l1)
+    for (unsigned l1 = 0; l1 < levels; ++l1)
     {
         impl_assert_that(chain[l1]->level >= l1);
     }
@@ -983,84 +1659,213 @@ rasl_impl<T,C,A,LG>::find_end_chain(node_type **chain, size_type *indexes) const
     return index;
 }
 
+/// The chain for the node at index, found by the spans alone.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find_index_chain(size_type index, node_type **chain, size_type *indexes) const
+{
+    assert_that(index < item_count);
+    size_type position = 0;
+    node_type *cur = head;
+    unsigned l = levels;
+    while (l)
+    {
+        --l;
+        while (cur->next[l] != tail && position + cur->span()[l] <= index)
+        {
+            position += cur->span()[l];
+            cur = cur->next[l];
+        }
+        chain[l]   = cur;
+        indexes[l] = position;
+    }
+    return position;
+}
+
 // TODO: Hint is now ignored (has to be, for spans to work)
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::node_type*
-rasl_impl<T,C,A,LG>::insert(const value_type &value, node_type *hint)
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type*
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::insert(const value_type &value, node_type *hint, bool *inserted)
 {
     UNUSED(hint)
-    const unsigned level = new_level();
-
-    node_type *chain[num_levels]   = {0};
-    size_type  indexes[num_levels] = {0};
-    size_type  index               = find_chain(value, chain, indexes);
+    node_type *chain[num_levels];
+    size_type  indexes[num_levels];
+    size_type  index               = find_chain(KeyFromValue()(value), chain, indexes);
 
-    // Do not allow repeated values in the list (we could in a "multi_skip_list")
+    if (node_type *existing = find_duplicate(KeyFromValue()(value), chain))
     {
-        node_type *next = chain[0]->next[0];
-        if (next != tail && detail::equivalent(next->value, value, less))
-            return tail;
+        if (inserted) *inserted = false;
+        return existing;
     }
 
-    node_type *new_node = allocate(level);
+    node_type *new_node = allocate(new_level(chain, indexes));
     assert_that(new_node);
-    impl_assert_that(new_node->level == level);
     alloc.construct(&new_node->value, value);
+    link(new_node, chain, indexes, index);
 
-    for (unsigned l = 0; l < num_levels; ++l)
+    if (inserted) *inserted = true;
+    return new_node;
+}
+
+#if SKIP_LIST_CPP11
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type*
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::insert(value_type &&value, node_type *hint, bool *inserted)
+{
+    UNUSED(hint)
+    node_type *chain[num_levels];
+    size_type  indexes[num_levels];
+    size_type  index               = find_chain(KeyFromValue()(value), chain, indexes);
+
+    if (node_type *existing = find_duplicate(KeyFromValue()(value), chain))
+    {
+        if (inserted) *inserted = false;
+        return existing;
+    }
+
+    node_type *new_node = allocate(new_level(chain, indexes));
+    assert_that(new_node);
+    std::allocator_traits<allocator_type>::construct(alloc, &new_node->value, std::move(value));
+    link(new_node, chain, indexes, index);
+
+    if (inserted) *inserted = true;
+    return new_node;
+}
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+template <typename... Args>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type*
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::emplace(node_type *hint, bool *inserted, Args&&... args)
+{
+    UNUSED(hint)
+
+    // The value has to exist before we can search for it. Its level is
+    // drawn now, but the list only grows to fit it once it is linked in.
+    const unsigned level    = draw_level();
+    node_type     *new_node = allocate(level);
+    try
+    {
+        std::allocator_traits<allocator_type>::construct(alloc, &new_node->value, std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        deallocate(new_node);
+        throw;
+    }
+
+    node_type *chain[num_levels];
+    size_type  indexes[num_levels];
+    size_type  index               = find_chain(KeyFromValue()(new_node->value), chain, indexes);
+
+    if (node_type *existing = find_duplicate(KeyFromValue()(new_node->value), chain))
+    {
+        std::allocator_traits<allocator_type>::destroy(alloc, &new_node->value);
+        deallocate(new_node);
+        if (inserted) *inserted = false;
+        return existing;
+    }
+
+    raise_levels(level, chain, indexes);
+    link(new_node, chain, indexes, index);
+
+    if (inserted) *inserted = true;
+    return new_node;
+}
+
+#endif
+
+/// Unless AllowDuplicates, do not allow repeated values in the list.
+/// Returns the node equivalent to the one being inserted after chain, if
+/// any, which stops the insert. With duplicates the new node goes in before
+/// its equivalents, as in a multi_skip_list.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type*
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::find_duplicate(const key_type &key, node_type **chain) const
+{
+    if (D) return 0;
+    node_type *next = chain[0]->next[0];
+    return next != tail && detail::equivalent(KeyFromValue()(next->value), key, less) ? next : 0;
+}
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+void
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::link(node_type *new_node, node_type **chain, size_type *indexes, size_type index)
+{
+    const unsigned level = new_node->level;
+    assert_that(level < levels);
+    for (unsigned l = 0; l < levels; ++l)
     {
         if (l > level)
         {
             if (l>0)
-                ++chain[l]->span[l];
+                ++chain[l]->span()[l];
         }
         else
         {
             new_node->next[l] = chain[l]->next[l];
             chain[l]->next[l] = new_node;
-            size_type prev_span = chain[l]->span[l];
-            chain[l]->span[l] = index+1-indexes[l];
-            new_node->span[l] = prev_span - (index-indexes[l]);
+            size_type prev_span = chain[l]->span()[l];
+            chain[l]->span()[l] = index+1-indexes[l];
+            new_node->span()[l] = prev_span - (index-indexes[l]);
         }
     }
     new_node->next[0]->prev = new_node;
     new_node->prev          = chain[0];
     
     ++item_count;
+    ++modifications;
 
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
-
-    return new_node;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
 void
-rasl_impl<T,C,A,LG>::remove(node_type *node)
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::remove(node_type *node)
 {
     assert_that(is_valid(node));
     assert_that(node->next[0]);
     
-    node_type *chain[num_levels]   = {0};
-    size_type  indexes[num_levels] = {0};
+    node_type *chain[num_levels];
+    size_type  indexes[num_levels];
     find_chain(node, chain, indexes);
+    unlink(node, chain);
+    
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
 
+/// Take a node out of the list, given the nodes before it at every level,
+/// and free it.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+void
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::unlink(node_type *node, node_type **chain)
+{
+    assert_that(is_valid(node));
     node->next[0]->prev = node->prev;
     
-    for (unsigned l = 0; l < num_levels; ++l)
+    for (unsigned l = 0; l < levels; ++l)
     {
         if (chain[l]->next[l] == node)
         {
-            chain[l]->span[l] = chain[l]->span[l] + node->span[l]-1;
+            chain[l]->span()[l] = chain[l]->span()[l] + node->span()[l]-1;
             chain[l]->next[l] = node->next[l];
         }
-        else if (chain[l] == head || less(chain[l]->value, node->value))
+        else if (D || chain[l] == head || less(KeyFromValue()(chain[l]->value), KeyFromValue()(node->value)))
         {
             if (l > 0)
-                --chain[l]->span[l];
+                --chain[l]->span()[l];
         }
     }
 
@@ -1068,16 +1873,13 @@ rasl_impl<T,C,A,LG>::remove(node_type *node)
     deallocate(node);
 
     item_count--;
-    
-#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-    check();
-#endif
+    ++modifications;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
 void
-rasl_impl<T,C,A,LG>::remove_all()
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::remove_all()
 {
     node_type *node = head->next[0];
     while (node != tail)
@@ -1087,24 +1889,26 @@ rasl_impl<T,C,A,LG>::remove_all()
         deallocate(node);
         node = next;
     }
+    node_pool_traits<allocator_type>::release_unused(alloc);
 
-    for (unsigned l = 0; l < num_levels; ++l)
+    for (unsigned l = 0; l < levels; ++l)
     {
         head->next[l] = tail;
-        head->span[l] = 1;
     }
     tail->prev = head;
     item_count = 0;
+    levels     = 0;
+    ++modifications;
         
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
 void 
-rasl_impl<T,C,A,LG>::remove_between(node_type *first, node_type *last)
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::remove_between(node_type *first, node_type *last)
 {
     assert_that(is_valid(first));
     assert_that(is_valid(last));
@@ -1112,10 +1916,10 @@ rasl_impl<T,C,A,LG>::remove_between(node_type *first, node_type *last)
     node_type * const prev         = first->prev;
     node_type * const one_past_end = last->next[0];
 
-    node_type *first_chain[num_levels]   = {0};
-    node_type *last_chain[num_levels]    = {0};
-    size_type  first_indexes[num_levels] = {0};
-    size_type  last_indexes[num_levels]  = {0};
+    node_type *first_chain[num_levels];
+    node_type *last_chain[num_levels];
+    size_type  first_indexes[num_levels];
+    size_type  last_indexes[num_levels];
     size_type  first_index               = find_chain(first, first_chain, first_indexes);
     size_type  last_index                = one_past_end != tail
                                          ? find_chain(one_past_end, last_chain, last_indexes)
@@ -1128,10 +1932,10 @@ rasl_impl<T,C,A,LG>::remove_between(node_type *first, node_type *last)
         //<< "/" << first_indexes[n]
             << ", last=" << last_chain[n]->value
         //<< "/" << last_indexes[n]
-            << "  span=" << last_chain[n]->span[n] << "\n";
+            << "  span=" << last_chain[n]->span()[n] << "\n";
 */
     unsigned last_node_level = 0;
-    while (last_node_level+1 < num_levels
+    while (last_node_level+1 < levels
            && last_chain[last_node_level+1] == last) ++last_node_level;
     impl_assert_that(last_node_level == last->level);
 
@@ -1139,7 +1943,7 @@ rasl_impl<T,C,A,LG>::remove_between(node_type *first, node_type *last)
     one_past_end->prev = prev;
 
     // forwards pointers (and spans)
-    for (unsigned l = 0; l < num_levels; ++l)
+    for (unsigned l = 0; l < levels; ++l)
     {
         // forwards pointer
         if (l <= last_node_level)
@@ -1148,7 +1952,7 @@ rasl_impl<T,C,A,LG>::remove_between(node_type *first, node_type *last)
             first_chain[l]->next[l] = last_chain[l]->next[l];
 
         // span
-        first_chain[l]->span[l] = last_indexes[l]+last_chain[l]->span[l]-first_indexes[l]-size_reduction;
+        first_chain[l]->span()[l] = last_indexes[l]+last_chain[l]->span()[l]-first_indexes[l]-size_reduction;
     }
 
     // now delete all the nodes between [first,last]
@@ -1160,16 +1964,17 @@ rasl_impl<T,C,A,LG>::remove_between(node_type *first, node_type *last)
         item_count--;
         first = next;
     }
+    ++modifications;
         
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::node_type *
-rasl_impl<T,C,A,LG>::at(size_type index)
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::at(size_type index)
 {
     assert_that(index < item_count);
 
@@ -1180,9 +1985,9 @@ rasl_impl<T,C,A,LG>::at(size_type index)
     while (l)
     {
         --l;
-        while (node->span[l] <= index)
+        while (node->span()[l] <= index)
         {
-            index -= node->span[l];
+            index -= node->span()[l];
             node = node->next[l];
         }
     }
@@ -1190,40 +1995,290 @@ rasl_impl<T,C,A,LG>::at(size_type index)
     return node;
 }
 
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-const typename rasl_impl<T,C,A,LG>::node_type *
-rasl_impl<T,C,A,LG>::at(size_type index) const
+const typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::at(size_type index) const
 {
     return const_cast<rasl_impl*>(this)->at(index);
 }
 
-template <class T, class C, class A, class LG>
+/// The span of each node's top link counts the positions to the next node
+/// at least as tall, so the distance to tail can be summed from node with no
+/// comparisons, in expected O(log n) steps.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-typename rasl_impl<T,C,A,LG>::size_type
-rasl_impl<T,C,A,LG>::index_of(const node_type *node) const
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::index_of(const node_type *node) const
 {
-    node_type *chain[num_levels]   = {0};
-    size_type  indexes[num_levels] = {0};
-    return find_chain(node, chain, indexes);
+    assert_that(node && node != head);
+
+    size_type to_tail = 0;
+    while (node != tail)
+    {
+        to_tail += node->span()[node->level];
+        node     = node->next[node->level];
+    }
+    return item_count - to_tail;
 }
 
-template <class T, class C, class A, class LG>
+/// The node n positions after node, found by climbing while the spans fit
+/// and descending when they overshoot. Expected O(log n) steps, with no
+/// comparisons.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::advance(const node_type *node, size_type n) const
+{
+    unsigned l = 0;
+    while (n)
+    {
+        assert_that(node != tail);
+        while (l < node->level && node->span()[l+1] <= n) ++l;
+        while (node->span()[l] > n) --l;
+        n    -= node->span()[l];
+        node  = node->next[l];
+    }
+    return const_cast<node_type*>(node);
+}
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+template <typename InputIterator>
 inline
-unsigned rasl_impl<T,C,A,LG>::new_level()
-{    
+void
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::assign_sorted(InputIterator first, InputIterator last)
+{
+    remove_all();
+
+    // The last node at each level, and its position (head is position 0).
+    // Every new node is appended after all of them, and the span of each
+    // link is the difference between positions.
+    node_type *chain[num_levels];
+    size_type  positions[num_levels];
+    for (unsigned l = 0; l < num_levels; ++l)
+    {
+        chain[l]     = head;
+        positions[l] = 0;
+    }
+
+    for (; first != last; ++first)
+    {
+        const value_type &value = *first;
+        node_type *back = chain[0];
+
+        if (back != head)
+        {
+            assert_that(!less(KeyFromValue()(value), KeyFromValue()(back->value)));
+            if (!D && !less(KeyFromValue()(back->value), KeyFromValue()(value))) continue;
+        }
+
+        const unsigned level = new_level();
+        node_type *node = allocate(level);
+        alloc.construct(&node->value, value);
+
+        const size_type position = item_count+1;
+        for (unsigned l = 0; l <= level; ++l)
+        {
+            node->next[l]          = tail;
+            chain[l]->next[l]      = node;
+            chain[l]->span()[l]    = position - positions[l];
+            chain[l]               = node;
+            positions[l]           = position;
+        }
+        node->prev = back;
+        tail->prev = node;
+        ++item_count;
+    }
+
+    // The links that reach tail
+    for (unsigned l = 0; l < levels; ++l)
+    {
+        chain[l]->span()[l] = item_count+1 - positions[l];
+    }
+    ++modifications;
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+/// Insert each value in [first, last), returning how many were added. The
+/// chain (and its indexes) found for one value is moved on to the next by
+/// advance_chain, rather than searched for afresh, so sorted input costs
+/// O(m log(n/m)) for m values. Nodes in the chain all come before the new
+/// one, so linking it in leaves their indexes as they were.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+template <typename InputIterator>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::insert_sorted(InputIterator first, InputIterator last)
+{
+    node_type *chain[num_levels];
+    size_type  indexes[num_levels];
+    unsigned   chained = 0;
+    size_type  count   = 0;
+    for (; first != last; ++first)
+    {
+        const value_type &value = *first;
+        const key_type   &key   = KeyFromValue()(value);
+        const size_type   index = advance_chain(key, chain, indexes, chained);
+        if (find_duplicate(key, chain)) continue;
+
+        node_type *new_node = allocate(new_level(chain, indexes));
+        assert_that(new_node);
+        alloc.construct(&new_node->value, value);
+        link(new_node, chain, indexes, index);
+        ++count;
+    }
+    return count;
+}
+
+/// Erase the value equivalent to each of [first, last), returning how many
+/// went. As for insert_sorted, the chain is carried from one to the next.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+template <typename InputIterator>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::erase_sorted(InputIterator first, InputIterator last)
+{
+    if (!item_count) return 0;
+
+    node_type *chain[num_levels];
+    size_type  indexes[num_levels];
+    unsigned   chained = 0;
+    size_type  count   = 0;
+    for (; first != last; ++first)
+    {
+        const key_type &key = *first;
+        advance_chain(key, chain, indexes, chained);
+
+        node_type *node = chain[0]->next[0];
+        if (node != tail && !less(key, KeyFromValue()(node->value)))
+        {
+            unlink(node, chain);
+            ++count;
+        }
+    }
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+    return count;
+}
+
+/// Move a chain found for an earlier value on to the one for value, and
+/// return its index, as find_chain does. The first chained levels hold a
+/// chain already; any live levels above those start from head, as does
+/// everything when value comes before the chain (the input was not sorted).
+///
+/// This is a finger search: climb from the bottom for as long as the
+/// chain's next node is still before value, and search down from there.
+/// For a value d positions on that is expected O(log d) levels. The levels
+/// above where the climb stops need no change: their next nodes are beyond
+/// the one that stopped it.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+typename rasl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+rasl_impl<T,K,C,A,LG,D,KeyFromValue>::advance_chain(const key_type &key, node_type **chain, size_type *indexes, unsigned &chained) const
+{
+    if (chained && chain[0] != head && !less(KeyFromValue()(chain[0]->value), key)) chained = 0;
+    for (; chained < levels; ++chained)
+    {
+        chain[chained]   = head;
+        indexes[chained] = 0;
+    }
+    if (!levels)
+    {
+        chain[0]   = head;
+        indexes[0] = 0;
+        return 0;
+    }
+
+    unsigned l = 0;
+    while (l+1 < levels && chain[l]->next[l] != tail && less(KeyFromValue()(chain[l]->next[l]->value), key)) ++l;
+
+    node_type *cur   = chain[l];
+    size_type  index = indexes[l];
+    for (++l; l; )
+    {
+        --l;
+        // the chain below may already be further on than we are
+        if (indexes[l] > index)
+        {
+            cur   = chain[l];
+            index = indexes[l];
+        }
+        while (cur->next[l] != tail && less(KeyFromValue()(cur->next[l]->value), key))
+        {
+            index += cur->span()[l];
+            cur = cur->next[l];
+        }
+        chain[l]   = cur;
+        indexes[l] = index;
+    }
+    return index;
+}
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+unsigned rasl_impl<T,K,C,A,LG,D,KeyFromValue>::new_level()
+{
+    const unsigned level = draw_level();
+    raise_levels(level, 0, 0);
+    return level;
+}
+
+/// new_level, for a node to be linked in after chain. The level is drawn
+/// only once the insert is sure to go ahead, so a rejected duplicate never
+/// makes the list taller. If it grows a level, the chain starts from head
+/// there.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+unsigned rasl_impl<T,K,C,A,LG,D,KeyFromValue>::new_level(node_type **chain, size_type *indexes)
+{
+    const unsigned level = draw_level();
+    raise_levels(level, chain, indexes);
+    return level;
+}
+
+/// Pick a level for a new node, at most one above the live levels, without
+/// making the list any taller yet.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+unsigned rasl_impl<T,K,C,A,LG,D,KeyFromValue>::draw_level()
+{
     unsigned level = generator.new_level();
     if (level >= levels)
     {
-        level = levels;
-        ++levels;
+        level = levels < num_levels ? levels : num_levels-1;
     }
     return level;
 }
 
-template <class T, class C, class A, class LG>
+/// Make the list tall enough for a node of the given level from draw_level.
+/// A new level starts from head in chain, if there is one.
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
+inline
+void rasl_impl<T,K,C,A,LG,D,KeyFromValue>::raise_levels(unsigned level, node_type **chain, size_type *indexes)
+{
+    if (level < levels) return;
+    assert_that(level == levels);
+
+    // Above the live levels head links straight to tail, and its
+    // span is not kept up to date. Set it as the level comes alive.
+    assert_that(head->next[levels] == tail);
+    head->span()[levels] = item_count+1;
+    if (chain)
+    {
+        chain[levels]   = head;
+        indexes[levels] = 0;
+    }
+    ++levels;
+}
+
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-void rasl_impl<T,C,A,LG>::swap(rasl_impl &other)
+void rasl_impl<T,K,C,A,LG,D,KeyFromValue>::swap(rasl_impl &other)
 {
     using std::swap;
 
@@ -1234,6 +2289,8 @@ void rasl_impl<T,C,A,LG>::swap(rasl_impl &other)
     swap(head,       other.head);
     swap(tail,       other.tail);
     swap(item_count, other.item_count);
+    ++modifications;
+    ++other.modifications;
 
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
@@ -1241,13 +2298,13 @@ void rasl_impl<T,C,A,LG>::swap(rasl_impl &other)
 }
 
 // for diagnostics only
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 template <class STREAM>
 inline
-void rasl_impl<T,C,A,LG>::dump(STREAM &s) const
+void rasl_impl<T,K,C,A,LG,D,KeyFromValue>::dump(STREAM &s) const
 {
     s << "skip_list(size="<<item_count<<",levels=" << levels << ")\n";
-    for (unsigned l = 0; l < levels+1; ++l)
+    for (unsigned l = 0; l < levels; ++l)
     {
         s << "  [" << l << "]" ;
         const node_type *n = head;
@@ -1255,7 +2312,7 @@ void rasl_impl<T,C,A,LG>::dump(STREAM &s) const
         {
             impl_assert_that(l <= n->level);
             const node_type *next = n->next[l];
-            size_type span = n->span[l];
+            size_type span = n->span()[l];
             bool prev_ok = false;
             char prev_char = span > 1 ? '(' : 'X';
             if (next && span <= 1)
@@ -1273,7 +2330,8 @@ void rasl_impl<T,C,A,LG>::dump(STREAM &s) const
             
             if (n != tail)
             {
-                if (next != tail && !less(n->value, next->value))
+                if (next != tail && (D ? less(KeyFromValue()(next->value), KeyFromValue()(n->value))
+                                       : !less(KeyFromValue()(n->value), KeyFromValue()(next->value))))
                     s << "*XXXXXXXXX* ";
                 s << span << ">"
                   << " "
@@ -1287,9 +2345,9 @@ void rasl_impl<T,C,A,LG>::dump(STREAM &s) const
 
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
 // for diagnostics only
-template <class T, class C, class A, class LG>
+template <class T, class K, class C, class A, class LG, bool D, typename KeyFromValue>
 inline
-bool rasl_impl<T,C,A,LG>::check() const
+bool rasl_impl<T,K,C,A,LG,D,KeyFromValue>::check() const
 {
     for (unsigned l = 0; l < levels; ++l)
     {
@@ -1316,7 +2374,8 @@ bool rasl_impl<T,C,A,LG>::check() const
             node_type *next = n->next[l];
             if (n != head && next != tail)
             {
-                if (!(less(n->value, next->value)))
+                if (D ? less(KeyFromValue()(next->value), KeyFromValue()(n->value))
+                      : !less(KeyFromValue()(n->value), KeyFromValue()(next->value)))
                 {
                     assert_that(false && "value order error");
                     dump(std::cerr);
@@ -1334,6 +2393,24 @@ bool rasl_impl<T,C,A,LG>::check() const
             dump(std::cerr);
             return false;
         }
+
+        // each span must count the positions to the next node on this level
+        const node_type *from     = head;
+        size_type        from_pos = 0;
+        size_type        pos      = 0;
+        for (n = head->next[0]; n; n = n->next[0])
+        {
+            ++pos;
+            if (n != tail && n->level < l) continue;
+            if (from->next[l] != n || from->span()[l] != pos-from_pos)
+            {
+                assert_that(false && "span error");
+                dump(std::cerr);
+                return false;
+            }
+            from     = n;
+            from_pos = pos;
+        }
     }
     return true;
 }
@@ -0,0 +1,775 @@
+//==============================================================================
+// random_access_skip_list_map.h
+//==============================================================================
+
+#pragma once
+
+#include "random_access_skip_list.h"
+#include "skip_list_detail.h"
+
+#include <memory>     // for std::allocator
+#include <functional> // for std::less
+#include <iterator>   // for std::reverse_iterator
+#include <utility>    // for std::pair
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
+#endif
+
+//==============================================================================
+#pragma mark - random_access_skip_list_map
+//==============================================================================
+
+namespace goodliffe {
+
+/// A random_access_skip_list_map is to skip_list_map as
+/// random_access_skip_list is to skip_list: each link also records how
+/// many elements it spans, so that the position of a key, and the element
+/// at a position, are found in O(log N).
+///
+/// That answers "where does key K rank?" (rank), "which entry is r-th?"
+/// (nth) and "how many keys lie in [lo, hi)?" (count_range) without
+/// copying the map out into a vector.
+///
+/// The spans cost a little extra storage in each node, and a little time
+/// on each insert and erase, to keep up to date.
+///
+/// @see skip_list_map
+/// @see random_access_skip_list
+template <typename Key,
+          typename MappedTo,
+          typename KeyCompare      = std::less<Key>,
+          typename Allocator       = std::allocator<std::pair<const Key, MappedTo> >,
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32> >
+class random_access_skip_list_map
+{
+public:
+
+    //======================================================================
+    // types
+
+    typedef Key                                           key_type;
+    typedef MappedTo                                      mapped_type;
+    typedef std::pair<const Key, MappedTo>                value_type;
+    typedef Allocator                                     allocator_type;
+
+protected:
+    typedef typename detail::rasl_impl<value_type,Key,KeyCompare,Allocator,LevelGenerator,false,detail::select1st<value_type> > impl_type;
+    typedef typename impl_type::node_type node_type;
+
+    template <typename T1> friend class detail::rasl_iterator;
+    template <typename T1> friend class detail::rasl_const_iterator;
+
+public:
+    typedef typename impl_type::size_type                 size_type;
+    typedef typename allocator_type::difference_type      difference_type;
+    typedef typename allocator_type::reference            reference;
+    typedef typename allocator_type::const_reference      const_reference;
+    typedef typename allocator_type::pointer              pointer;
+    typedef typename allocator_type::const_pointer        const_pointer;
+    typedef KeyCompare                                    compare;
+
+    typedef typename detail::rasl_iterator<impl_type>       iterator;
+    typedef typename detail::rasl_const_iterator<impl_type> const_iterator;
+    typedef std::reverse_iterator<iterator>                 reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>           const_reverse_iterator;
+
+    //======================================================================
+    // lifetime management
+
+    explicit random_access_skip_list_map(const Allocator &alloc = Allocator());
+
+    template <class InputIterator>
+    random_access_skip_list_map(InputIterator first, InputIterator last, const Allocator &alloc = Allocator());
+
+    random_access_skip_list_map(const random_access_skip_list_map &other);
+    random_access_skip_list_map(const random_access_skip_list_map &other, const Allocator &alloc);
+
+#if SKIP_LIST_CPP11
+    random_access_skip_list_map(random_access_skip_list_map &&other);
+    random_access_skip_list_map(random_access_skip_list_map &&other, const Allocator &alloc);
+    random_access_skip_list_map(std::initializer_list<value_type> init, const Allocator &alloc = Allocator());
+#endif
+
+    allocator_type get_allocator() const { return impl.get_allocator(); }
+
+    //======================================================================
+    // assignment
+
+    random_access_skip_list_map &operator=(const random_access_skip_list_map &other);
+#if SKIP_LIST_CPP11
+    random_access_skip_list_map &operator=(random_access_skip_list_map &&other);
+#endif
+
+    template <typename InputIterator>
+    void assign(InputIterator first, InputIterator last);
+
+    /// Replace the contents with [first,last), which must already be
+    /// sorted. The map is built in one pass, in linear time.
+    /// Of a run of equivalent keys, only the first is kept.
+    template <typename InputIterator>
+    void assign_sorted(InputIterator first, InputIterator last);
+
+    //======================================================================
+    // element access
+
+    reference       front();
+    const_reference front() const;
+    reference       back();
+    const_reference back() const;
+
+    //======================================================================
+    // iterators
+
+    iterator       begin()                  { return iterator(&impl, impl.front(), 0); }
+    const_iterator begin() const            { return const_iterator(&impl, impl.front(), 0); }
+    const_iterator cbegin() const           { return const_iterator(&impl, impl.front(), 0); }
+
+    iterator       end()                    { return iterator(&impl, impl.one_past_end(), impl.size()); }
+    const_iterator end() const              { return const_iterator(&impl, impl.one_past_end(), impl.size()); }
+    const_iterator cend() const             { return const_iterator(&impl, impl.one_past_end(), impl.size()); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const  { return const_reverse_iterator(end()); }
+
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const     { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const    { return const_reverse_iterator(begin()); }
+
+    //======================================================================
+    // capacity
+
+    bool      empty() const         { return impl.size() == 0; }
+    size_type size() const          { return impl.size(); }
+    size_type max_size() const      { return impl.get_allocator().max_size(); }
+
+    //======================================================================
+    // modifiers
+
+    void clear();
+
+    typedef typename std::pair<iterator,bool> insert_by_value_result;
+
+    insert_by_value_result insert(const value_type &value);
+    iterator insert(const_iterator hint, const value_type &value);
+
+#if SKIP_LIST_CPP11
+    insert_by_value_result insert(value_type &&value);
+    iterator insert(const_iterator hint, value_type &&value);
+#endif
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last);
+
+#if SKIP_LIST_CPP11
+    void insert(std::initializer_list<value_type> ilist);
+
+    /// Construct a value in place from args, and insert it. The value is
+    /// discarded if an equivalent one is already present.
+    template <typename... Args>
+    insert_by_value_result emplace(Args&&... args);
+    template <typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
+#endif
+
+    size_type erase(const key_type &key);
+    iterator  erase(const_iterator position);
+    iterator  erase(const_iterator first, const_iterator last);
+
+    /// Insert each key/value pair in [first, last), returning how many
+    /// were added. Sorted input is merged in, as for
+    /// skip_list_map::insert_sorted_batch.
+    template <typename InputIterator>
+    size_type insert_sorted_batch(InputIterator first, InputIterator last);
+
+    /// Erase the element with each key in [first, last), returning how
+    /// many went.
+    template <typename InputIterator>
+    size_type erase_sorted_batch(InputIterator first, InputIterator last);
+
+    void swap(random_access_skip_list_map &other) { impl.swap(other.impl); }
+
+    friend void swap(random_access_skip_list_map &lhs, random_access_skip_list_map &rhs) { lhs.swap(rhs); }
+
+    //======================================================================
+    // lookup
+
+    bool           contains(const key_type &key) const { return count(key) != 0; }
+    size_type      count(const key_type &key) const;
+
+    iterator       find(const key_type &key);
+    const_iterator find(const key_type &key) const;
+
+    iterator       lower_bound(const key_type &key);
+    const_iterator lower_bound(const key_type &key) const;
+
+    iterator       upper_bound(const key_type &key);
+    const_iterator upper_bound(const key_type &key) const;
+
+    //======================================================================
+    // random access
+
+    /// The element at index, in key order. O(log n).
+    reference       nth(size_type index);
+    const_reference nth(size_type index) const;
+
+    iterator       iterator_at(size_type index);
+    const_iterator iterator_at(size_type index) const;
+    const_iterator citerator_at(size_type index) const { return iterator_at(index); }
+
+    size_type index_of(const const_iterator &i) const;
+
+    void erase_at(size_type index);
+
+    /// The number of keys less than key: the index it has, or would have,
+    /// in the map. O(log n).
+    size_type rank(const key_type &key) const;
+
+    /// The number of keys in [lo, hi). O(log n).
+    size_type count_range(const key_type &lo, const key_type &hi) const;
+
+    //======================================================================
+    // other operations
+
+    template <typename STREAM>
+    void dump(STREAM &stream) const { impl.dump(stream); }
+
+protected:
+    impl_type impl;
+
+    bool holds(const node_type *node, const key_type &key) const
+    {
+        return impl.is_valid(node) && detail::equivalent(node->value.first, key, impl.less);
+    }
+};
+
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - non-members
+
+namespace goodliffe {
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool operator==(const random_access_skip_list_map<K,T,C,A,LG> &lhs, const random_access_skip_list_map<K,T,C,A,LG> &rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool operator!=(const random_access_skip_list_map<K,T,C,A,LG> &lhs, const random_access_skip_list_map<K,T,C,A,LG> &rhs)
+{
+    return !operator==(lhs, rhs);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool operator<(const random_access_skip_list_map<K,T,C,A,LG> &lhs, const random_access_skip_list_map<K,T,C,A,LG> &rhs)
+{
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool operator<=(const random_access_skip_list_map<K,T,C,A,LG> &lhs, const random_access_skip_list_map<K,T,C,A,LG> &rhs)
+{
+    return !(rhs < lhs);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool operator>(const random_access_skip_list_map<K,T,C,A,LG> &lhs, const random_access_skip_list_map<K,T,C,A,LG> &rhs)
+{
+    return rhs < lhs;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool operator>=(const random_access_skip_list_map<K,T,C,A,LG> &lhs, const random_access_skip_list_map<K,T,C,A,LG> &rhs)
+{
+    return !(lhs < rhs);
+}
+
+} // namespace goodliffe
+
+namespace std
+{
+    template <class K, class T, class C, class A, class LG>
+    void swap(goodliffe::random_access_skip_list_map<K,T,C,A,LG> &lhs, goodliffe::random_access_skip_list_map<K,T,C,A,LG> &rhs)
+    {
+        lhs.swap(rhs);
+    }
+}
+
+//==============================================================================
+#pragma mark - lifetime management
+//==============================================================================
+
+namespace goodliffe {
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(const allocator_type &alloc_)
+:   impl(alloc_)
+{
+}
+
+template <class K, class T, class C, class A, class LG>
+template <class InputIterator>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(InputIterator first, InputIterator last, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    assign(first, last);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(const random_access_skip_list_map &other)
+:   impl(other.get_allocator())
+{
+    impl.assign_sorted(other.begin(), other.end());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(const random_access_skip_list_map &other, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    impl.assign_sorted(other.begin(), other.end());
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(random_access_skip_list_map &&other)
+:   impl(other.get_allocator())
+{
+    impl.swap(other.impl);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(random_access_skip_list_map &&other, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    // Nodes can only change hands if the allocators can free each other's
+    if (alloc_ == other.get_allocator())
+        impl.swap(other.impl);
+    else
+        impl.assign_sorted(other.begin(), other.end());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG>::random_access_skip_list_map(std::initializer_list<value_type> init, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    assign(init.begin(), init.end());
+}
+
+#endif
+
+//==============================================================================
+#pragma mark assignment
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG> &
+random_access_skip_list_map<K,T,C,A,LG>::operator=(const random_access_skip_list_map<K,T,C,A,LG> &other)
+{
+    if (this != &other) impl.assign_sorted(other.begin(), other.end());
+    return *this;
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+random_access_skip_list_map<K,T,C,A,LG> &
+random_access_skip_list_map<K,T,C,A,LG>::operator=(random_access_skip_list_map<K,T,C,A,LG> &&other)
+{
+    if (this != &other)
+    {
+        impl.swap(other.impl);
+        other.clear();
+    }
+    return *this;
+}
+
+#endif
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+void random_access_skip_list_map<K,T,C,A,LG>::assign(InputIterator first, InputIterator last)
+{
+    clear();
+    while (first != last) insert(*first++);
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+void random_access_skip_list_map<K,T,C,A,LG>::assign_sorted(InputIterator first, InputIterator last)
+{
+    impl.assign_sorted(first, last);
+}
+
+//==============================================================================
+#pragma mark element access
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::reference
+random_access_skip_list_map<K,T,C,A,LG>::front()
+{
+    assert_that(!empty());
+    return impl.front()->value;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_reference
+random_access_skip_list_map<K,T,C,A,LG>::front() const
+{
+    assert_that(!empty());
+    return impl.front()->value;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::reference
+random_access_skip_list_map<K,T,C,A,LG>::back()
+{
+    assert_that(!empty());
+    return impl.one_past_end()->prev->value;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_reference
+random_access_skip_list_map<K,T,C,A,LG>::back() const
+{
+    assert_that(!empty());
+    return impl.one_past_end()->prev->value;
+}
+
+//==============================================================================
+#pragma mark modifiers
+
+template <class K, class T, class C, class A, class LG>
+inline
+void random_access_skip_list_map<K,T,C,A,LG>::clear()
+{
+    impl.remove_all();
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::insert_by_value_result
+random_access_skip_list_map<K,T,C,A,LG>::insert(const value_type &value)
+{
+    bool inserted;
+    node_type *node = impl.insert(value, 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+// The spans must be counted from the front, so the hint is no help
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::insert(const_iterator hint, const value_type &value)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.insert(value));
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::insert_by_value_result
+random_access_skip_list_map<K,T,C,A,LG>::insert(value_type &&value)
+{
+    bool inserted;
+    node_type *node = impl.insert(std::move(value), 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::insert(const_iterator hint, value_type &&value)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.insert(std::move(value)));
+}
+
+#endif
+
+template <class K, class T, class C, class A, class LG>
+template <class InputIterator>
+inline
+void
+random_access_skip_list_map<K,T,C,A,LG>::insert(InputIterator first, InputIterator last)
+{
+    while (first != last) insert(*first++);
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+void
+random_access_skip_list_map<K,T,C,A,LG>::insert(std::initializer_list<value_type> ilist)
+{
+    insert(ilist.begin(), ilist.end());
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename... Args>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::insert_by_value_result
+random_access_skip_list_map<K,T,C,A,LG>::emplace(Args&&... args)
+{
+    bool inserted;
+    node_type *node = impl.emplace(0, &inserted, std::forward<Args>(args)...);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename... Args>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::emplace_hint(const_iterator hint, Args&&... args)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.emplace(0, 0, std::forward<Args>(args)...));
+}
+
+#endif
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::erase(const key_type &key)
+{
+    node_type *node = impl.find(key);
+    if (!holds(node, key)) return 0;
+    impl.remove(node);
+    return 1;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::erase(const_iterator position)
+{
+    assert_that(position.get_impl() == &impl);
+    assert_that(impl.is_valid(position.get_node()));
+    node_type *node = const_cast<node_type*>(position.get_node());
+    node_type *next = node->next[0];
+    impl.remove(node);
+    return iterator(&impl, next);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::erase(const_iterator first, const_iterator last)
+{
+    assert_that(first.get_impl() == &impl);
+    assert_that(last.get_impl() == &impl);
+
+    if (first != last)
+    {
+        node_type *first_node = const_cast<node_type*>(first.get_node());
+        node_type *last_node  = const_cast<node_type*>(last.get_node()->prev);
+        impl.remove_between(first_node, last_node);
+    }
+
+    return iterator(&impl, const_cast<node_type*>(last.get_node()));
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::insert_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.insert_sorted(first, last);
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::erase_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.erase_sorted(first, last);
+}
+
+//==============================================================================
+#pragma mark lookup
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::count(const key_type &key) const
+{
+    return holds(impl.find(key), key);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::find(const key_type &key)
+{
+    node_type *node = impl.find(key);
+    return holds(node, key) ? iterator(&impl, node) : end();
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_iterator
+random_access_skip_list_map<K,T,C,A,LG>::find(const key_type &key) const
+{
+    const node_type *node = impl.find(key);
+    return holds(node, key) ? const_iterator(&impl, node) : end();
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::lower_bound(const key_type &key)
+{
+    size_type  index;
+    node_type *node = impl.lower_bound(key, &index);
+    return iterator(&impl, node, index);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_iterator
+random_access_skip_list_map<K,T,C,A,LG>::lower_bound(const key_type &key) const
+{
+    size_type        index;
+    const node_type *node = impl.lower_bound(key, &index);
+    return const_iterator(&impl, node, index);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::upper_bound(const key_type &key)
+{
+    size_type  index;
+    node_type *node = impl.lower_bound(key, &index);
+    if (holds(node, key)) { node = node->next[0]; ++index; }
+    return iterator(&impl, node, index);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_iterator
+random_access_skip_list_map<K,T,C,A,LG>::upper_bound(const key_type &key) const
+{
+    size_type        index;
+    const node_type *node = impl.lower_bound(key, &index);
+    if (holds(node, key)) { node = node->next[0]; ++index; }
+    return const_iterator(&impl, node, index);
+}
+
+//==============================================================================
+#pragma mark random access
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::reference
+random_access_skip_list_map<K,T,C,A,LG>::nth(size_type index)
+{
+    node_type *node = impl.at(index);
+    assert_that(impl.is_valid(node));
+    return node->value;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_reference
+random_access_skip_list_map<K,T,C,A,LG>::nth(size_type index) const
+{
+    const node_type *node = impl.at(index);
+    assert_that(impl.is_valid(node));
+    return node->value;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::iterator
+random_access_skip_list_map<K,T,C,A,LG>::iterator_at(size_type index)
+{
+    node_type *node = impl.at(index);
+    return iterator(&impl, node, index);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::const_iterator
+random_access_skip_list_map<K,T,C,A,LG>::iterator_at(size_type index) const
+{
+    const node_type *node = impl.at(index);
+    return const_iterator(&impl, node, index);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::index_of(const const_iterator &i) const
+{
+    return i.get_index();
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+void
+random_access_skip_list_map<K,T,C,A,LG>::erase_at(size_type index)
+{
+    node_type *node = impl.at(index);
+    assert_that(impl.is_valid(node));
+    impl.remove(node);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::rank(const key_type &key) const
+{
+    size_type index;
+    impl.lower_bound(key, &index);
+    return index;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename random_access_skip_list_map<K,T,C,A,LG>::size_type
+random_access_skip_list_map<K,T,C,A,LG>::count_range(const key_type &lo, const key_type &hi) const
+{
+    if (!impl.less(lo, hi)) return 0;
+    return rank(hi) - rank(lo);
+}
+
+} // namespace goodliffe
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
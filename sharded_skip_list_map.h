@@ -0,0 +1,513 @@
+//==============================================================================
+// sharded_skip_list_map.h
+//==============================================================================
+
+#pragma once
+
+#include "skip_list_map.h"
+#include "skip_list_epoch_reclaimer.h"
+
+#if !SKIP_LIST_CPP11
+#error "sharded_skip_list_map needs C++11 (std::mutex and std::atomic)"
+#endif
+
+#include <algorithm>  // for std::upper_bound
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
+#endif
+
+//==============================================================================
+#pragma mark - sharded_skip_list_map
+//==============================================================================
+
+namespace goodliffe {
+
+/// A map that many threads can write to at once, by splitting the key
+/// space into ranges (shards), each a skip_list_map behind its own lock.
+/// Threads working on keys in different shards never contend.
+///
+/// Every member function except construction and destruction may be called
+/// concurrently from any number of threads.
+///
+/// The shard boundaries are given at construction, but they are not fixed.
+/// Each shard counts the operations routed to it, and every so often the
+/// map looks for a shard doing more than twice its share of the work. It
+/// then moves the boundary between that shard and its quieter neighbour,
+/// handing the neighbour a proportion of its keys. That happens online:
+/// only the two shards involved are locked while their keys move. You can
+/// also ask for it with rebalance().
+///
+/// Operations find their shard through a table of boundaries, which is
+/// replaced when a boundary moves. The old table is freed through an
+/// epoch_reclaimer, and each shard checks the key really is its own once
+/// locked, so a lookup racing with a rebalance just tries again.
+///
+/// Like concurrent_skip_list_map, there are no iterators: for_each visits
+/// every value in order, a shard at a time.
+///
+/// @param Key            Template type for the map's key.
+/// @param MappedTo       Template type for the mapped value.
+/// @param KeyCompare     Template type describing the ordering comparator.
+/// @param Allocator      Template type for memory allocator for the contents of
+///                       the container. The shards share copies of it behind
+///                       different locks, so it must be safe to call from
+///                       many threads at once (std::allocator is;
+///                       skip_list_pool_allocator is not, and must not be
+///                       used here).
+/// @param LevelGenerator Each shard has its own instance.
+///
+/// @see skip_list_map
+/// @see concurrent_skip_list_map
+template <typename Key,
+          typename MappedTo,
+          typename KeyCompare      = std::less<Key>,
+          typename Allocator       = std::allocator<std::pair<const Key, MappedTo> >,
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32> >
+class sharded_skip_list_map
+{
+public:
+
+    //======================================================================
+    // types
+
+    typedef skip_list_map<Key,MappedTo,KeyCompare,Allocator,LevelGenerator> shard_type;
+
+    typedef Key                                           key_type;
+    typedef MappedTo                                      mapped_type;
+    typedef std::pair<const Key, MappedTo>                value_type;
+    typedef Allocator                                     allocator_type;
+    typedef typename shard_type::size_type                size_type;
+    typedef KeyCompare                                    compare;
+
+    /// Operations on a shard between looks for a hot one.
+    static const unsigned long rebalance_interval = 1ul << 14;
+
+    //======================================================================
+    // lifetime management
+
+    /// Creates boundaries.size()+1 shards. The first holds the keys before
+    /// boundaries[0], the next those from boundaries[0] up to boundaries[1],
+    /// and so on. boundaries must be in increasing order.
+    explicit sharded_skip_list_map(const std::vector<key_type> &boundaries,
+                                   const Allocator &alloc = Allocator());
+    ~sharded_skip_list_map();
+
+    sharded_skip_list_map(const sharded_skip_list_map &) = delete;
+    sharded_skip_list_map &operator=(const sharded_skip_list_map &) = delete;
+
+    allocator_type get_allocator() const { return shards.front()->map.get_allocator(); }
+
+    /// The reclaimer that frees old routing tables. Threads may register
+    /// with it, to make each call a little cheaper.
+    epoch_reclaimer &get_reclaimer() const { return reclaimer; }
+
+    //======================================================================
+    // capacity
+
+    /// size() is exact when the map is quiescent, and approximate otherwise.
+    bool      empty() const                 { return size() == 0; }
+    size_type size() const;
+
+    //======================================================================
+    // modifiers
+
+    /// Returns true if value was inserted, false if its key was already
+    /// present (in which case the existing value is left alone).
+    bool      insert(const value_type &value);
+
+    /// Returns the number of values erased (0 or 1).
+    size_type erase(const key_type &key);
+
+    /// Erases every value, a shard at a time.
+    void      clear();
+
+    //======================================================================
+    // lookup
+
+    bool      contains(const key_type &key) const { return count(key) != 0; }
+    size_type count(const key_type &key) const;
+
+    /// If key is present, copies its mapped value to result and returns
+    /// true. Otherwise returns false and leaves result alone.
+    bool      find(const key_type &key, mapped_type &result) const;
+
+    /// Call f(value) for each value, in order. Each shard is locked while
+    /// it is visited, so f must not call back into the map. Boundaries do
+    /// not move during the walk, so a value present throughout is seen
+    /// exactly once.
+    template <typename Function>
+    void      for_each(Function f) const;
+
+    //======================================================================
+    // sharding
+
+    size_type             shard_count() const { return shards.size(); }
+
+    /// The current boundaries, as passed to the constructor.
+    std::vector<key_type> boundaries() const;
+
+    /// If one shard has had more than twice its share of the operations
+    /// since the last look, move a boundary to hand some of its keys to
+    /// its quieter neighbour. Returns true if a boundary moved.
+    bool                  rebalance();
+
+private:
+
+    struct shard
+    {
+        explicit shard(const Allocator &alloc) : map(alloc), count(0), ops(0) {}
+
+        std::mutex                 mutex;
+        shard_type                 map;
+        std::atomic<size_type>     count;   ///< map.size(), readable without the lock
+        std::atomic<unsigned long> ops;     ///< since the last rebalance
+
+        // The shard's range, [lower, upper), guarded by mutex
+        bool                       has_lower, has_upper;
+        key_type                   lower, upper;
+    };
+
+    /// Where a key is found: shard i holds keys from lower[i-1].
+    struct routing
+    {
+        std::vector<key_type> lower;
+    };
+
+    typedef std::unique_lock<std::mutex> lock_type;
+
+    size_type   route(const key_type &key) const;
+    shard      *lock_shard_for(const key_type &key, lock_type &lock) const;
+    bool        owns(const shard *s, const key_type &key) const;
+    void        operated_on(shard *s) const;
+    bool        rebalance(lock_type &rebalancing);
+    bool        move_keys(size_type from, size_type to, unsigned long from_ops, unsigned long to_ops);
+
+    static void free_routing(void *, void **tables, std::size_t count);
+
+    compare                        less;
+    std::vector<shard*>            shards;
+    std::atomic<const routing*>    table;
+    mutable std::mutex             rebalance_mutex;
+    mutable epoch_reclaimer        reclaimer;
+};
+
+template <class K, class T, class C, class A, class LG>
+inline
+sharded_skip_list_map<K,T,C,A,LG>::sharded_skip_list_map(const std::vector<key_type> &boundaries_,
+                                                         const allocator_type &alloc)
+:   table(0)
+{
+    routing *initial = new routing;
+    initial->lower = boundaries_;
+    table.store(initial);
+
+    for (size_type n = 0; n <= boundaries_.size(); ++n)
+    {
+        assert_that(n < 2 || less(boundaries_[n-2], boundaries_[n-1]));
+        shard *s = new shard(alloc);
+        s->has_lower = n > 0;
+        s->has_upper = n < boundaries_.size();
+        if (s->has_lower) s->lower = boundaries_[n-1];
+        if (s->has_upper) s->upper = boundaries_[n];
+        shards.push_back(s);
+    }
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+sharded_skip_list_map<K,T,C,A,LG>::~sharded_skip_list_map()
+{
+    for (size_type n = 0; n < shards.size(); ++n) delete shards[n];
+    delete table.load();
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+void sharded_skip_list_map<K,T,C,A,LG>::free_routing(void *, void **tables, std::size_t count)
+{
+    for (std::size_t n = 0; n < count; ++n) delete static_cast<routing*>(tables[n]);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool sharded_skip_list_map<K,T,C,A,LG>::owns(const shard *s, const key_type &key) const
+{
+    return (!s->has_lower || !less(key, s->lower))
+        && (!s->has_upper || less(key, s->upper));
+}
+
+/// Which shard the current table says key is in.
+template <class K, class T, class C, class A, class LG>
+inline
+typename sharded_skip_list_map<K,T,C,A,LG>::size_type
+sharded_skip_list_map<K,T,C,A,LG>::route(const key_type &key) const
+{
+    epoch_reclaimer::guard g(reclaimer);
+    const std::vector<key_type> &lower = table.load(std::memory_order_acquire)->lower;
+    return size_type(std::upper_bound(lower.begin(), lower.end(), key, less) - lower.begin());
+}
+
+/// Lock the shard that holds key. If a rebalance moved the key between
+/// routing and locking, the shard won't own it, and we route again; the
+/// new table was published before the shard was unlocked.
+template <class K, class T, class C, class A, class LG>
+inline
+typename sharded_skip_list_map<K,T,C,A,LG>::shard *
+sharded_skip_list_map<K,T,C,A,LG>::lock_shard_for(const key_type &key, lock_type &lock) const
+{
+    for (;;)
+    {
+        shard *s = shards[route(key)];
+        lock = lock_type(s->mutex);
+        if (owns(s, key)) return s;
+        lock.unlock();
+    }
+}
+
+/// Count an operation on s, and look for a hot shard every so often.
+/// Called once s is unlocked.
+template <class K, class T, class C, class A, class LG>
+inline
+void sharded_skip_list_map<K,T,C,A,LG>::operated_on(shard *s) const
+{
+    if ((s->ops.fetch_add(1, std::memory_order_relaxed)+1) % rebalance_interval == 0)
+    {
+        // A rebalance already under way will do
+        lock_type rebalancing(rebalance_mutex, std::try_to_lock);
+        if (rebalancing.owns_lock())
+        {
+            const_cast<sharded_skip_list_map*>(this)->rebalance(rebalancing);
+        }
+    }
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename sharded_skip_list_map<K,T,C,A,LG>::size_type
+sharded_skip_list_map<K,T,C,A,LG>::size() const
+{
+    size_type total = 0;
+    for (size_type n = 0; n < shards.size(); ++n)
+    {
+        total += shards[n]->count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool sharded_skip_list_map<K,T,C,A,LG>::insert(const value_type &value)
+{
+    lock_type lock;
+    shard *s = lock_shard_for(value.first, lock);
+    const bool inserted = s->map.insert(value).second;
+    if (inserted) s->count.store(s->map.size(), std::memory_order_relaxed);
+    lock.unlock();
+
+    operated_on(s);
+    return inserted;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename sharded_skip_list_map<K,T,C,A,LG>::size_type
+sharded_skip_list_map<K,T,C,A,LG>::erase(const key_type &key)
+{
+    lock_type lock;
+    shard *s = lock_shard_for(key, lock);
+    const size_type erased = s->map.erase(key);
+    if (erased) s->count.store(s->map.size(), std::memory_order_relaxed);
+    lock.unlock();
+
+    operated_on(s);
+    return erased;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+void sharded_skip_list_map<K,T,C,A,LG>::clear()
+{
+    for (size_type n = 0; n < shards.size(); ++n)
+    {
+        lock_type lock(shards[n]->mutex);
+        shards[n]->map.clear();
+        shards[n]->count.store(0, std::memory_order_relaxed);
+    }
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename sharded_skip_list_map<K,T,C,A,LG>::size_type
+sharded_skip_list_map<K,T,C,A,LG>::count(const key_type &key) const
+{
+    lock_type lock;
+    shard *s = lock_shard_for(key, lock);
+    const size_type result = s->map.count(key);
+    lock.unlock();
+
+    operated_on(s);
+    return result;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool sharded_skip_list_map<K,T,C,A,LG>::find(const key_type &key, mapped_type &result) const
+{
+    lock_type lock;
+    shard *s = lock_shard_for(key, lock);
+    typename shard_type::const_iterator i = s->map.find(key);
+    const bool found = i != s->map.end();
+    if (found) result = i->second;
+    lock.unlock();
+
+    operated_on(s);
+    return found;
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename Function>
+inline
+void sharded_skip_list_map<K,T,C,A,LG>::for_each(Function f) const
+{
+    lock_type rebalancing(rebalance_mutex);
+    for (size_type n = 0; n < shards.size(); ++n)
+    {
+        lock_type lock(shards[n]->mutex);
+        const shard_type &map = shards[n]->map;
+        for (typename shard_type::const_iterator i = map.begin(); i != map.end(); ++i)
+        {
+            f(*i);
+        }
+    }
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+std::vector<typename sharded_skip_list_map<K,T,C,A,LG>::key_type>
+sharded_skip_list_map<K,T,C,A,LG>::boundaries() const
+{
+    epoch_reclaimer::guard g(reclaimer);
+    return table.load(std::memory_order_acquire)->lower;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+bool sharded_skip_list_map<K,T,C,A,LG>::rebalance()
+{
+    lock_type rebalancing(rebalance_mutex);
+    return rebalance(rebalancing);
+}
+
+/// Operation counts are taken afresh each time, so a shard is only hot
+/// for what it did since the last look.
+template <class K, class T, class C, class A, class LG>
+inline
+bool sharded_skip_list_map<K,T,C,A,LG>::rebalance(lock_type &rebalancing)
+{
+    UNUSED(rebalancing)
+    assert_that(rebalancing.owns_lock());
+
+    std::vector<unsigned long> ops(shards.size());
+    unsigned long total = 0;
+    size_type     hottest = 0;
+    for (size_type n = 0; n < shards.size(); ++n)
+    {
+        ops[n] = shards[n]->ops.exchange(0, std::memory_order_relaxed);
+        total += ops[n];
+        if (ops[n] > ops[hottest]) hottest = n;
+    }
+
+    if (shards.size() < 2 || ops[hottest]*shards.size() <= 2*total) return false;
+
+    size_type quieter;
+    if (hottest == 0)
+        quieter = 1;
+    else if (hottest == shards.size()-1)
+        quieter = hottest-1;
+    else
+        quieter = ops[hottest-1] <= ops[hottest+1] ? hottest-1 : hottest+1;
+
+    return move_keys(hottest, quieter, ops[hottest], ops[quieter]);
+}
+
+/// Hand the keys of shard from nearest shard to over to it, in proportion
+/// to how much busier from has been, and move the boundary between them.
+/// Returns false if there were too few keys to move any.
+template <class K, class T, class C, class A, class LG>
+inline
+bool sharded_skip_list_map<K,T,C,A,LG>::move_keys(size_type from, size_type to,
+                                                  unsigned long from_ops, unsigned long to_ops)
+{
+    // Always lock the lower shard first
+    lock_type lower_lock(shards[std::min(from, to)]->mutex);
+    lock_type upper_lock(shards[std::max(from, to)]->mutex);
+
+    shard *source = shards[from];
+    shard *dest   = shards[to];
+
+    const size_type moving = size_type(
+        double(source->map.size()) * double(from_ops - to_ops) / double(2*from_ops));
+    if (moving == 0 || moving >= source->map.size()) return false;
+
+    typename shard_type::iterator first, last;
+    key_type boundary;
+    if (to > from)
+    {
+        // the top of source goes to the bottom of dest
+        first = source->map.end();
+        for (size_type n = 0; n < moving; ++n) --first;
+        last  = source->map.end();
+        boundary = first->first;
+
+        typename shard_type::iterator hint = dest->map.begin();
+        for (typename shard_type::iterator i = first; i != last; ++i)
+        {
+            hint = dest->map.insert(hint, *i);
+            ++hint;
+        }
+        source->upper = boundary;
+        dest->lower   = boundary;
+    }
+    else
+    {
+        // the bottom of source goes to the top of dest
+        first = source->map.begin();
+        last  = first;
+        for (size_type n = 0; n < moving; ++n) ++last;
+        boundary = last->first;
+
+        for (typename shard_type::iterator i = first; i != last; ++i)
+        {
+            dest->map.insert(dest->map.end(), *i);
+        }
+        source->lower = boundary;
+        dest->upper   = boundary;
+    }
+    source->map.erase(first, last);
+    source->count.store(source->map.size(), std::memory_order_relaxed);
+    dest->count.store(dest->map.size(), std::memory_order_relaxed);
+
+    // Publish the new table before the shards are unlocked
+    routing *updated = new routing(*table.load(std::memory_order_relaxed));
+    updated->lower[std::min(from, to)] = boundary;
+
+    epoch_reclaimer::guard g(reclaimer);
+    const routing *old = table.exchange(updated, std::memory_order_acq_rel);
+    g.retire(const_cast<routing*>(old), &free_routing, 0);
+    return true;
+}
+
+} // namespace goodliffe
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
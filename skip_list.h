@@ -44,7 +44,6 @@ namespace goodliffe {
 ///
 /// TODO:
 ///     * C++11: noexcept decls
-///     * C++11: move operations
 ///     * Document efficiency of operations (big-O notation)
 ///
 /// Following the freaky STL container names, this might be better named
@@ -61,7 +60,7 @@ namespace goodliffe {
 template <typename T,
           typename Compare         = std::less<T>,
           typename Allocator       = std::allocator<T>,
-          typename LevelGenerator  = detail::skip_list_level_generator<32>,
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32>,
           bool     AllowDuplicates = false>
 class skip_list
 {
@@ -71,6 +70,7 @@ protected:
 
     template <typename T1> friend class detail::sl_iterator;
     template <typename T1> friend class detail::sl_const_iterator;
+    template <class, class, class, class, bool> friend class skip_list;
 
 public:
 
@@ -92,6 +92,11 @@ public:
     typedef std::reverse_iterator<const_iterator>         reverse_iterator;
     typedef std::reverse_iterator<const_iterator>         const_reverse_iterator;
 
+#if SKIP_LIST_CPP11
+    typedef detail::sl_node_handle<T,Allocator,impl_type::num_levels> node_handle;
+    typedef detail::sl_insert_return_type<iterator,node_handle>      insert_return_type;
+#endif
+
     //======================================================================
     // lifetime management
 
@@ -103,10 +108,11 @@ public:
     skip_list(const skip_list &other);
     skip_list(const skip_list &other, const Allocator &alloc);
 
-    // C++11
-    //skip_list(const skip_list &&other);
-    //skip_list(const skip_list &&other, const Allocator &alloc);
-    //skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+#if SKIP_LIST_CPP11
+    skip_list(skip_list &&other);
+    skip_list(skip_list &&other, const Allocator &alloc);
+    skip_list(std::initializer_list<value_type> init, const Allocator &alloc = Allocator());
+#endif
 
     allocator_type get_allocator() const { return impl.get_allocator(); }
 
@@ -114,11 +120,20 @@ public:
     // assignment
 
     skip_list &operator=(const skip_list &other);
-    //C++11 skip_list& operator=(skip_list&& other);
+#if SKIP_LIST_CPP11
+    skip_list &operator=(skip_list &&other);
+#endif
 
     template <typename InputIterator>
     void assign(InputIterator first, InputIterator last);
 
+    /// Replace the contents with [first,last), which must already be
+    /// sorted. The list is built in one pass, in linear time.
+    /// Of a run of equivalent values, only a multi_skip_list keeps more
+    /// than the first.
+    template <typename InputIterator>
+    void assign_sorted(InputIterator first, InputIterator last);
+
     //======================================================================
     // element access
 
@@ -163,19 +178,58 @@ public:
     insert_by_value_result insert(const value_type &value);
     iterator insert(const_iterator hint, const value_type &value);
 
-    //C++11iterator insert(value_type &&value);
-    //C++11iterator insert(const_iterator hint, const value_type &&value);
+#if SKIP_LIST_CPP11
+    insert_by_value_result insert(value_type &&value);
+    iterator insert(const_iterator hint, value_type &&value);
+#endif
 
     template <class InputIterator>
     void insert(InputIterator first, InputIterator last);
 
-    //C++11iterator insert(std::initializer_list<value_type> ilist);
-    //C++11emplace
+#if SKIP_LIST_CPP11
+    void insert(std::initializer_list<value_type> ilist);
+
+    /// Construct a value in place from args, and insert it. The value is
+    /// discarded if an equivalent one is already present.
+    template <typename... Args>
+    insert_by_value_result emplace(Args&&... args);
+    template <typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
+#endif
 
     size_type erase(const value_type &value);
     iterator  erase(const_iterator position);
     iterator  erase(const_iterator first, const_iterator last);
 
+#if SKIP_LIST_CPP11
+    /// Take an element out of the list, handing over its node rather than
+    /// freeing it. The node can go back in with insert, into this list or
+    /// another of the same node_handle type (a multi_skip_list, say),
+    /// without allocating or copying anything.
+    node_handle extract(const_iterator position);
+    /// Extract the (first) element equivalent to value, if there is one.
+    node_handle extract(const value_type &value);
+
+    /// Insert the node that handle holds. If an equivalent element is
+    /// already present, the node comes back in the result's handle.
+    insert_return_type insert(node_handle &&handle);
+    iterator           insert(const_iterator hint, node_handle &&handle);
+#endif
+
+    /// Insert each value in [first, last), returning how many were added.
+    /// When they are sorted, each goes in from where the one before it
+    /// did, rather than from the front, so m of them cost O(m log(n/m))
+    /// rather than O(m log n); a batch as big as the list is just a linear
+    /// merge. Any order gives the right result, only more slowly.
+    template <typename InputIterator>
+    size_type insert_sorted_batch(InputIterator first, InputIterator last);
+
+    /// Erase every value equivalent to each of [first, last), returning
+    /// how many went. Sorted values are searched for from one another, as
+    /// for insert_sorted_batch.
+    template <typename InputIterator>
+    size_type erase_sorted_batch(InputIterator first, InputIterator last);
+
     void swap(skip_list &other) { impl.swap(other.impl); }
 
     friend void swap(skip_list &lhs, skip_list &rhs) { lhs.swap(rhs); }
@@ -189,18 +243,120 @@ public:
     iterator       find(const value_type &value);
     const_iterator find(const value_type &value) const;
 
+    /// Find each value in [first, last), writing the iterator find would
+    /// give for it to out. Returns out once past the last one written.
+    ///
+    /// The searches are interleaved, so that their cache misses overlap.
+    /// For a list much larger than the cache, that is quicker than calling
+    /// find for each value in turn.
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out);
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const;
+
     iterator       lower_bound(const value_type &value);
     const_iterator lower_bound(const value_type &value) const;
 
     iterator       upper_bound(const value_type &value);
     const_iterator upper_bound(const value_type &value) const;
 
+#if SKIP_LIST_CPP11
+    /// With a transparent Compare (one with an is_transparent member type,
+    /// like std::less<>), lookups and erase also take anything Compare can
+    /// order against the values, searching with it directly rather than
+    /// building a value_type first (a const char * for std::string, say).
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool           contains(const K &key) const { return count(key) != 0; }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type      count(const K &key) const { return find(key) != end() ? 1 : 0; }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator       find(const K &key) { return to_iterator(impl.find(key), key); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K &key) const { return to_iterator(static_cast<const node_type*>(impl.find(key)), key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator       lower_bound(const K &key) { return iterator(&impl, impl.lower_bound(key)); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &key) const { return const_iterator(&impl, impl.lower_bound(key)); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator       upper_bound(const K &key) { return iterator(&impl, impl.upper_bound(key)); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &key) const { return const_iterator(&impl, impl.upper_bound(key)); }
+
+    /// Iterators still go to erase(const_iterator).
+    template <typename K, typename C = Compare, typename = typename C::is_transparent,
+              typename = typename std::enable_if<!std::is_convertible<const K&, const_iterator>::value>::type>
+    size_type      erase(const K &key) { return impl.erase(key); }
+#endif
+
+    //======================================================================
+    // fingers
+
+    /// A finger remembers where in the list an operation through it ended.
+    /// Starting the next search from there costs O(log d) for an element d
+    /// positions away, rather than O(log n), which pays off when successive
+    /// operations are close together (e.g. nearly sorted input).
+    ///
+    /// A default-constructed finger starts from the front. A finger is
+    /// unaffected by inserts, and quietly starts again from the front after
+    /// any element has been erased from the list.
+    typedef typename impl_type::finger finger;
+
+    iterator       find(const value_type &value, finger &f);
+    const_iterator find(const value_type &value, finger &f) const;
+
+    iterator       lower_bound(const value_type &value, finger &f);
+    const_iterator lower_bound(const value_type &value, finger &f) const;
+
+    insert_by_value_result insert(finger &f, const value_type &value);
+
+    /// Find each value in [first, last) in turn, through one finger, and write
+    /// an iterator for each to out, as find (or lower_bound) would give.
+    /// Returns out once past the last one written.
+    ///
+    /// When the values are sorted, each search starts from where the one
+    /// before it ended, so m of them cost O(m log(n/m)) rather than
+    /// O(m log n). Any order gives the right answers, just more slowly.
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out);
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const;
+
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out);
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const;
+
     //======================================================================
     // other operations
 
+    /// Move the elements of other into this list. Their nodes are relinked
+    /// rather than copied, so nothing is allocated: m elements cost
+    /// O(m log(n/m)), which is a linear merge for lists of a size. Elements
+    /// with an equivalent already here stay in other (unless this is a
+    /// multi_skip_list, where they go after the equivalents). The lists'
+    /// allocators must compare equal. Iterators to the elements that moved
+    /// are no longer valid.
+    template <bool OtherDuplicates>
+    void merge(skip_list<T,Compare,Allocator,LevelGenerator,OtherDuplicates> &other);
+
+    /// Move the elements of [first, last), a range of other, into this
+    /// list, as merge does.
+    template <bool OtherDuplicates>
+    void splice(skip_list<T,Compare,Allocator,LevelGenerator,OtherDuplicates> &other,
+                typename skip_list<T,Compare,Allocator,LevelGenerator,OtherDuplicates>::const_iterator first,
+                typename skip_list<T,Compare,Allocator,LevelGenerator,OtherDuplicates>::const_iterator last);
+    template <bool OtherDuplicates>
+    void splice(skip_list<T,Compare,Allocator,LevelGenerator,OtherDuplicates> &other,
+                typename skip_list<T,Compare,Allocator,LevelGenerator,OtherDuplicates>::const_iterator position);
+
+    /// Take the elements of [first, last) out of this list, and return them
+    /// in a list of their own, without copying them.
+    skip_list extract(const_iterator first, const_iterator last);
+
     // std::list has:
-    //   * merge
-    //   * splice
     //   * remove
     //   * remove_if
     //   * reverse
@@ -213,13 +369,15 @@ public:
 protected:
     impl_type impl;
 
-    iterator to_iterator(node_type *node, const value_type &value)
+    template <typename KeyLike>
+    iterator to_iterator(node_type *node, const KeyLike &value)
     {
         return impl.is_valid(node) && detail::equivalent(node->value, value, impl.less)
             ? iterator(&impl, node)
             : end();
     }
-    const_iterator to_iterator(const node_type *node, const value_type &value) const
+    template <typename KeyLike>
+    const_iterator to_iterator(const node_type *node, const KeyLike &value) const
     {
         return impl.is_valid(node) && detail::equivalent(node->value, value, impl.less)
             ? const_iterator(&impl, node)
@@ -242,7 +400,7 @@ namespace goodliffe {
 template <typename T,
           typename Compare        = std::less<T>,
           typename Allocator      = std::allocator<T>,
-          typename LevelGenerator = detail::skip_list_level_generator<32> >
+          typename LevelGenerator = detail::xorshift_skip_list_level_generator<32> >
 class multi_skip_list :
     public skip_list<T,Compare,Allocator,LevelGenerator,true>
 {
@@ -285,16 +443,24 @@ public:
     multi_skip_list(const multi_skip_list &other, const Allocator &alloc)
         : parent_type(other, alloc) {}
     
-    // C++11
-    //multi_skip_list(const multi_skip_list &&other);
-    //multi_skip_list(const multi_skip_list &&other, const Allocator &alloc);
-    //multi_skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+#if SKIP_LIST_CPP11
+    multi_skip_list(multi_skip_list &&other)
+        : parent_type(std::move(other)) {}
+    multi_skip_list(multi_skip_list &&other, const Allocator &alloc)
+        : parent_type(std::move(other), alloc) {}
+    multi_skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator())
+        : parent_type(init, alloc) {}
+
+    multi_skip_list &operator=(const multi_skip_list &other)
+        { parent_type::operator=(other); return *this; }
+    multi_skip_list &operator=(multi_skip_list &&other)
+        { parent_type::operator=(std::move(other)); return *this; }
+#endif
     
     //======================================================================
     // Overridden operations
 
-    size_type erase(const value_type &value);
-    iterator  erase(const_iterator first, const_iterator last);
+    size_type erase(const value_type &value) { return erase_equivalent(value); }
     using parent_type::erase;
 
     //======================================================================
@@ -304,6 +470,30 @@ public:
 
     std::pair<iterator,iterator> equal_range(const value_type &value);
     std::pair<const_iterator,const_iterator> equal_range(const value_type &value) const;
+
+#if SKIP_LIST_CPP11
+    /// Transparent forms of the above, as for skip_list's lookups.
+    template <typename K, typename C = Compare, typename = typename C::is_transparent,
+              typename = typename std::enable_if<!std::is_convertible<const K&, const_iterator>::value>::type>
+    size_type erase(const K &key) { return erase_equivalent(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K &key) const { return impl.count(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator,iterator> equal_range(const K &key)
+        { return std::make_pair(this->lower_bound(key), this->upper_bound(key)); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator,const_iterator> equal_range(const K &key) const
+        { return std::make_pair(this->lower_bound(key), this->upper_bound(key)); }
+#endif
+
+    multi_skip_list extract(const_iterator first, const_iterator last);
+    using parent_type::extract;
+
+protected:
+    template <typename KeyLike>
+    size_type erase_equivalent(const KeyLike &key);
 };
 
 } // namespace goodliffe
@@ -392,8 +582,8 @@ template <class T, class C, class A, class LG, bool D>
 inline
 skip_list<T,C,A,LG,D>::skip_list(const skip_list &other)
 :   impl(other.get_allocator())
-{    
-    assign(other.begin(), other.end());
+{
+    impl.assign_sorted(other.begin(), other.end());
 }
 
 template <class T, class C, class A, class LG, bool D>
@@ -401,13 +591,40 @@ inline
 skip_list<T,C,A,LG,D>::skip_list(const skip_list &other, const allocator_type &alloc_)
 :   impl(alloc_)
 {
-    assign(other.begin(), other.end());
+    impl.assign_sorted(other.begin(), other.end());
 }
 
-// C++11
-//skip_list(const skip_list &&other);
-//skip_list(const skip_list &&other, const Allocator &alloc);
-//skip_list(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+#if SKIP_LIST_CPP11
+
+template <class T, class C, class A, class LG, bool D>
+inline
+skip_list<T,C,A,LG,D>::skip_list(skip_list &&other)
+:   impl(other.get_allocator())
+{
+    impl.swap(other.impl);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+skip_list<T,C,A,LG,D>::skip_list(skip_list &&other, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    // Nodes can only change hands if the allocators can free each other's
+    if (alloc_ == other.get_allocator())
+        impl.swap(other.impl);
+    else
+        impl.assign_sorted(other.begin(), other.end());
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+skip_list<T,C,A,LG,D>::skip_list(std::initializer_list<value_type> init, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    assign(init.begin(), init.end());
+}
+
+#endif
 
 //==============================================================================
 #pragma mark assignment
@@ -417,11 +634,26 @@ inline
 skip_list<T,C,A,LG,D> &
 skip_list<T,C,A,LG,D>::operator=(const skip_list<T,C,A,LG,D> &other)
 {
-    assign(other.begin(), other.end());
+    if (this != &other) impl.assign_sorted(other.begin(), other.end());
     return *this;
 }
 
-//C++11 skip_list& operator=(skip_list&& other);
+#if SKIP_LIST_CPP11
+
+template <class T, class C, class A, class LG, bool D>
+inline
+skip_list<T,C,A,LG,D> &
+skip_list<T,C,A,LG,D>::operator=(skip_list<T,C,A,LG,D> &&other)
+{
+    if (this != &other)
+    {
+        impl.swap(other.impl);
+        other.clear();
+    }
+    return *this;
+}
+
+#endif
 
 template <class T, class C, class A, class LG, bool D>
 template <typename InputIterator>
@@ -432,6 +664,14 @@ void skip_list<T,C,A,LG,D>::assign(InputIterator first, InputIterator last)
     while (first != last) insert(*first++);
 }
 
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator>
+inline
+void skip_list<T,C,A,LG,D>::assign_sorted(InputIterator first, InputIterator last)
+{
+    impl.assign_sorted(first, last);
+}
+
 //==============================================================================
 #pragma mark element access
 
@@ -486,8 +726,9 @@ inline
 typename skip_list<T,C,A,LG,D>::insert_by_value_result
 skip_list<T,C,A,LG,D>::insert(const value_type &value)
 {
-    node_type *node = impl.insert(value);
-    return std::make_pair(iterator(&impl, node), impl.is_valid(node));
+    bool inserted;
+    node_type *node = impl.insert(value, 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
 }
 
 template <class T, class C, class A, class LG, bool D>
@@ -499,7 +740,28 @@ skip_list<T,C,A,LG,D>::insert(const_iterator hint, const value_type &value)
     return iterator(&impl, impl.insert(value, const_cast<node_type*>(hint.get_node())));
 }
 
-//C++11iterator insert const_iterator pos, value_type &&value);
+#if SKIP_LIST_CPP11
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::insert_by_value_result
+skip_list<T,C,A,LG,D>::insert(value_type &&value)
+{
+    bool inserted;
+    node_type *node = impl.insert(std::move(value), 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::iterator
+skip_list<T,C,A,LG,D>::insert(const_iterator hint, value_type &&value)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.insert(std::move(value), const_cast<node_type*>(hint.get_node())));
+}
+
+#endif
 
 template <class T, class C, class A, class LG, bool D>
 template <class InputIterator>
@@ -507,15 +769,44 @@ inline
 void
 skip_list<T,C,A,LG,D>::insert(InputIterator first, InputIterator last)
 {
-    iterator last_inserted = end();
-    while (first != last)
-    {
-        last_inserted = insert(last_inserted, *first++);
-    }
+    // Through one finger, as insert_sorted_batch: each value is searched
+    // for from where the one before went, which costs O(1) for sorted
+    // input, and is never much worse than a search from the top.
+    impl.insert_sorted(first, last);
+}
+
+#if SKIP_LIST_CPP11
+
+template <class T, class C, class A, class LG, bool D>
+inline
+void
+skip_list<T,C,A,LG,D>::insert(std::initializer_list<value_type> ilist)
+{
+    insert(ilist.begin(), ilist.end());
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename... Args>
+inline
+typename skip_list<T,C,A,LG,D>::insert_by_value_result
+skip_list<T,C,A,LG,D>::emplace(Args&&... args)
+{
+    bool inserted;
+    node_type *node = impl.emplace(0, &inserted, std::forward<Args>(args)...);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename... Args>
+inline
+typename skip_list<T,C,A,LG,D>::iterator
+skip_list<T,C,A,LG,D>::emplace_hint(const_iterator hint, Args&&... args)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.emplace(const_cast<node_type*>(hint.get_node()), 0, std::forward<Args>(args)...));
 }
 
-//C++11iterator insert(std::initializer_list<value_type> ilist);
-// C++11 emplace
+#endif
 
 template <class T, class C, class A, class LG, bool D>
 inline
@@ -556,6 +847,83 @@ skip_list<T,C,A,LG,D>::erase(const_iterator first, const_iterator last)
     return iterator(&impl, const_cast<node_type*>(last.get_node()));
 }
   
+#if SKIP_LIST_CPP11
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::node_handle
+skip_list<T,C,A,LG,D>::extract(const_iterator position)
+{
+    assert_that(position.get_impl() == &impl);
+    assert_that(impl.is_valid(position.get_node()));
+    node_type *node = const_cast<node_type*>(position.get_node());
+    return node_handle(impl.extract(node), get_allocator());
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::node_handle
+skip_list<T,C,A,LG,D>::extract(const value_type &value)
+{
+    node_type *node = impl.lower_bound(value);
+    if (!impl.is_valid(node) || !detail::equivalent(node->value, value, impl.less))
+        return node_handle();
+    return node_handle(impl.extract(node), get_allocator());
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::insert_return_type
+skip_list<T,C,A,LG,D>::insert(node_handle &&handle)
+{
+    insert_return_type result;
+    result.position = end();
+    result.inserted = false;
+    if (handle.empty()) return result;
+
+    assert_that(handle.get_allocator() == get_allocator());
+    node_type *node = impl.insert_node(handle.get_node(), 0, &result.inserted);
+    result.position = iterator(&impl, node);
+    if (result.inserted) handle.release();
+    else                 result.node = std::move(handle);
+    return result;
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::iterator
+skip_list<T,C,A,LG,D>::insert(const_iterator hint, node_handle &&handle)
+{
+    assert_that(hint.get_impl() == &impl);
+    if (handle.empty()) return end();
+
+    assert_that(handle.get_allocator() == get_allocator());
+    bool inserted;
+    node_type *node = impl.insert_node(handle.get_node(), const_cast<node_type*>(hint.get_node()), &inserted);
+    if (inserted) handle.release();
+    return iterator(&impl, node);
+}
+
+#endif
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator>
+inline
+typename skip_list<T,C,A,LG,D>::size_type
+skip_list<T,C,A,LG,D>::insert_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.insert_sorted(first, last);
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator>
+inline
+typename skip_list<T,C,A,LG,D>::size_type
+skip_list<T,C,A,LG,D>::erase_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.erase_sorted(first, last);
+}
+
 //==============================================================================
 #pragma mark lookup
 
@@ -586,6 +954,40 @@ skip_list<T,C,A,LG,D>::find(const value_type &value) const
     return to_iterator(node, value);
 }
     
+template <class T, class C, class A, class LG, bool D>
+template <typename ForwardIterator, typename OutputIterator>
+inline
+OutputIterator skip_list<T,C,A,LG,D>::find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out)
+{
+    const value_type *values[impl_type::batch_width];
+    node_type        *nodes[impl_type::batch_width];
+    while (first != last)
+    {
+        unsigned count = 0;
+        for (; count < impl_type::batch_width && first != last; ++first) values[count++] = &*first;
+        impl.find_batch(values, nodes, count);
+        for (unsigned n = 0; n < count; ++n) *out++ = to_iterator(nodes[n], *values[n]);
+    }
+    return out;
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename ForwardIterator, typename OutputIterator>
+inline
+OutputIterator skip_list<T,C,A,LG,D>::find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+{
+    const value_type *values[impl_type::batch_width];
+    node_type        *nodes[impl_type::batch_width];
+    while (first != last)
+    {
+        unsigned count = 0;
+        for (; count < impl_type::batch_width && first != last; ++first) values[count++] = &*first;
+        impl.find_batch(values, nodes, count);
+        for (unsigned n = 0; n < count; ++n) *out++ = to_iterator(static_cast<const node_type*>(nodes[n]), *values[n]);
+    }
+    return out;
+}
+
 template <class T, class C, class A, class LG, bool D>
 inline
 typename skip_list<T,C,A,LG,D>::iterator
@@ -618,6 +1020,139 @@ skip_list<T,C,A,LG,D>::upper_bound(const value_type &value) const
     return const_iterator(&impl, impl.upper_bound(value));
 }
 
+//==============================================================================
+#pragma mark fingers
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::iterator
+skip_list<T,C,A,LG,D>::find(const value_type &value, finger &f)
+{
+    return to_iterator(impl.lower_bound(value, f), value);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::const_iterator
+skip_list<T,C,A,LG,D>::find(const value_type &value, finger &f) const
+{
+    const node_type *node = impl.lower_bound(value, f);
+    return to_iterator(node, value);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::iterator
+skip_list<T,C,A,LG,D>::lower_bound(const value_type &value, finger &f)
+{
+    return iterator(&impl, impl.lower_bound(value, f));
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::const_iterator
+skip_list<T,C,A,LG,D>::lower_bound(const value_type &value, finger &f) const
+{
+    return const_iterator(&impl, impl.lower_bound(value, f));
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+typename skip_list<T,C,A,LG,D>::insert_by_value_result
+skip_list<T,C,A,LG,D>::insert(finger &f, const value_type &value)
+{
+    bool inserted;
+    node_type *node = impl.insert(value, f, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list<T,C,A,LG,D>::find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out)
+{
+    finger f;
+    for (; first != last; ++first) *out++ = find(*first, f);
+    return out;
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list<T,C,A,LG,D>::find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const
+{
+    finger f;
+    for (; first != last; ++first) *out++ = find(*first, f);
+    return out;
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list<T,C,A,LG,D>::lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out)
+{
+    finger f;
+    for (; first != last; ++first) *out++ = lower_bound(*first, f);
+    return out;
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list<T,C,A,LG,D>::lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const
+{
+    finger f;
+    for (; first != last; ++first) *out++ = lower_bound(*first, f);
+    return out;
+}
+
+//==============================================================================
+#pragma mark other operations
+
+template <class T, class C, class A, class LG, bool D>
+template <bool OtherDuplicates>
+inline
+void skip_list<T,C,A,LG,D>::merge(skip_list<T,C,A,LG,OtherDuplicates> &other)
+{
+    impl.transfer(other.impl, other.impl.front(), other.impl.one_past_end());
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <bool OtherDuplicates>
+inline
+void skip_list<T,C,A,LG,D>::splice(skip_list<T,C,A,LG,OtherDuplicates> &other,
+                                   typename skip_list<T,C,A,LG,OtherDuplicates>::const_iterator first,
+                                   typename skip_list<T,C,A,LG,OtherDuplicates>::const_iterator last)
+{
+    assert_that(first.get_impl() == &other.impl);
+    assert_that(last.get_impl() == &other.impl);
+    impl.transfer(other.impl,
+                  const_cast<node_type*>(first.get_node()),
+                  const_cast<node_type*>(last.get_node()));
+}
+
+template <class T, class C, class A, class LG, bool D>
+template <bool OtherDuplicates>
+inline
+void skip_list<T,C,A,LG,D>::splice(skip_list<T,C,A,LG,OtherDuplicates> &other,
+                                   typename skip_list<T,C,A,LG,OtherDuplicates>::const_iterator position)
+{
+    assert_that(position.get_impl() == &other.impl);
+    assert_that(other.impl.is_valid(position.get_node()));
+    node_type *node = const_cast<node_type*>(position.get_node());
+    impl.transfer(other.impl, node, node->next[0]);
+}
+
+template <class T, class C, class A, class LG, bool D>
+inline
+skip_list<T,C,A,LG,D>
+skip_list<T,C,A,LG,D>::extract(const_iterator first, const_iterator last)
+{
+    skip_list extracted(get_allocator());
+    extracted.splice(*this, first, last);
+    return extracted;
+}
+
 } // namespace goodliffe
 
 //==============================================================================
@@ -659,39 +1194,36 @@ multi_skip_list<T,C,A,LG>::equal_range(const value_type &value) const
 }
 
 template <class T, class C, class A, class LG>
+template <typename KeyLike>
 inline
 typename multi_skip_list<T,C,A,LG>::size_type
-multi_skip_list<T,C,A,LG>::erase(const value_type &value)
+multi_skip_list<T,C,A,LG>::erase_equivalent(const KeyLike &key)
 {
-    size_type count = 0;
-
-    for (node_type *node = impl.find(value);
-         impl.is_valid(node) && detail::equivalent(node->value, value, impl.less);
-         node = impl.find(value))
+    // find gives the last of the run; the rest are just behind it
+    node_type *last = impl.find(key);
+    if (!impl.is_valid(last) || !detail::equivalent(last->value, key, impl.less))
+        return 0;
+
+    size_type  count = 1;
+    node_type *first = last;
+    while (impl.is_valid(first->prev) && detail::equivalent(first->prev->value, key, impl.less))
     {
-        impl.remove(node);
+        first = first->prev;
         ++count;
     }
 
+    impl.remove_between(first, last);
     return count;
 }
 
 template <class T, class C, class A, class LG>
 inline
-typename multi_skip_list<T,C,A,LG>::iterator
-multi_skip_list<T,C,A,LG>::erase(const_iterator first, const_iterator last)
+multi_skip_list<T,C,A,LG>
+multi_skip_list<T,C,A,LG>::extract(const_iterator first, const_iterator last)
 {
-    assert_that(first.get_impl() == &impl);
-    assert_that(last.get_impl() == &impl);
-    
-    while (first != last)
-    {
-        const_iterator to_remove = first++;
-        node_type *node = const_cast<node_type*>(to_remove.get_node());
-        impl.remove(node);
-    }
-
-    return iterator(&impl, const_cast<node_type*>(last.get_node()));
+    multi_skip_list extracted(this->get_allocator());
+    extracted.splice(*this, first, last);
+    return extracted;
 }
 
 } // namespace goodliffe
@@ -6,16 +6,50 @@
 #pragma once
 
 #include <cmath>      // for std::log
+#include <cstddef>    // for std::size_t
 #include <cstdlib>    // for std::rand
 #include <iterator>   // for std::reverse_iterator
 
 //==============================================================================
 
 #ifdef _MSC_VER
+#include <intrin.h>   // for _BitScanForward
 #pragma warning( push )
 #pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
 #endif
 #define UNUSED(x) (void)x;
+//==============================================================================
+#pragma mark - language support
+//==============================================================================
+
+// SKIP_LIST_CPP11 is 1 when the compiler supports the C++11 features the
+// containers use (rvalue references, variadic templates and initializer
+// lists). Define it to 0 beforehand to leave those operations out.
+#ifndef SKIP_LIST_CPP11
+    #if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1800)
+        #define SKIP_LIST_CPP11 1
+    #else
+        #define SKIP_LIST_CPP11 0
+    #endif
+#endif
+
+// SKIP_LIST_PREFETCH(address) hints that the memory at address will be read
+// soon. It does nothing where the compiler offers no way to say so.
+#ifndef SKIP_LIST_PREFETCH
+    #if defined(__GNUC__) || defined(__clang__)
+        #define SKIP_LIST_PREFETCH(address) __builtin_prefetch(address)
+    #else
+        #define SKIP_LIST_PREFETCH(address)
+    #endif
+#endif
+
+#if SKIP_LIST_CPP11
+#include <initializer_list>
+#include <memory>     // for std::allocator_traits
+#include <utility>    // for std::move, std::forward
+#include <type_traits> // for std::enable_if, std::is_convertible
+#endif
+
 //==============================================================================
 #pragma mark - internal forward declarations
 
@@ -27,6 +61,7 @@ namespace detail
 {
     template <unsigned NumLevels>   class bit_based_skip_list_level_generator;
     template <unsigned NumLevels>   class skip_list_level_generator;
+    template <unsigned NumLevels>   class xorshift_skip_list_level_generator;
 }
 }
 
@@ -118,6 +153,29 @@ public:
     unsigned new_level();
 };
 
+/// Generates the same distribution of levels as skip_list_level_generator,
+/// but much faster, and without touching any global state.
+///
+/// Each generator owns a 32-bit xorshift random number generator, seeded
+/// from its own address. The level is the number of trailing zero bits in
+/// each random number, which is a single instruction on most platforms.
+///
+/// This is the default level generator for all of the skip list containers.
+template <unsigned NumLevels>
+class xorshift_skip_list_level_generator
+{
+public:
+    static const unsigned num_levels = NumLevels;
+
+    xorshift_skip_list_level_generator();
+    explicit xorshift_skip_list_level_generator(unsigned seed);
+
+    unsigned new_level();
+
+private:
+    unsigned state;
+};
+
 } // namespace detail
 } // namespace goodliffe
 
@@ -130,14 +188,14 @@ namespace detail {
 
 #if 1
 
-template <typename Compare, typename T>
+template <typename Compare, typename T, typename U>
 inline
-bool equivalent(const T &lhs, const T &rhs, const Compare &less)
+bool equivalent(const T &lhs, const U &rhs, const Compare &less)
     { return !less(lhs, rhs) && !less(rhs, lhs); }
 
-template <typename Compare, typename T>
+template <typename Compare, typename T, typename U>
 inline
-bool less_or_equal(const T &lhs, const T &rhs, const Compare &less)
+bool less_or_equal(const T &lhs, const U &rhs, const Compare &less)
     { return !less(rhs, lhs); }
 
 #else
@@ -147,14 +205,14 @@ bool less_or_equal(const T &lhs, const T &rhs, const Compare &less)
 // There should be no appriciable difference in performance (at least, for
 // the built-in types).
 
-template <typename Compare, typename T>
+template <typename Compare, typename T, typename U>
 inline
-bool equivalent(const T &lhs, const T &rhs, Compare &less)
+bool equivalent(const T &lhs, const U &rhs, Compare &less)
     { return lhs == rhs; }
 
-template <typename Compare, typename T>
+template <typename Compare, typename T, typename U>
 inline
-bool less_or_equal(const T &lhs, const T &rhs, Compare &less)
+bool less_or_equal(const T &lhs, const U &rhs, Compare &less)
     { return lhs <= rhs; }
 
 #endif
@@ -194,6 +252,93 @@ unsigned skip_list_level_generator<ML>::new_level()
     return level < num_levels ? level : num_levels;
 }
 
+/// Returns the number of 0-bits below the lowest 1-bit in x.
+/// x must not be zero.
+inline
+unsigned count_trailing_zeros(unsigned x)
+{
+    assert_that(x != 0);
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctz(x));
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return unsigned(index);
+#else
+    static const unsigned char debruijn[32] =
+    {
+         0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+        31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+    };
+    return debruijn[(((x & (0u-x)) * 0x077CB531u) & 0xffffffffu) >> 27];
+#endif
+}
+
+/// Scrambles the bits of x (the MurmurHash3 finaliser).
+inline
+unsigned mix_bits(unsigned x)
+{
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x & 0xffffffffu;
+}
+
+template <unsigned ML>
+inline
+xorshift_skip_list_level_generator<ML>::xorshift_skip_list_level_generator()
+{
+    const std::size_t address = reinterpret_cast<std::size_t>(this);
+    state = mix_bits(unsigned(address) ^ unsigned((address >> 16) >> 16));
+    if (!state) state = 0x9e3779b9u;
+}
+
+template <unsigned ML>
+inline
+xorshift_skip_list_level_generator<ML>::xorshift_skip_list_level_generator(unsigned seed)
+:   state(mix_bits(seed))
+{
+    if (!state) state = 0x9e3779b9u;
+}
+
+template <unsigned ML>
+inline
+unsigned xorshift_skip_list_level_generator<ML>::new_level()
+{
+    // xorshift32 never yields zero from a non-zero state, so there is
+    // always a set bit to find.
+    state ^= (state << 13) & 0xffffffffu;
+    state ^= state >> 17;
+    state ^= (state << 5) & 0xffffffffu;
+
+    const unsigned level = count_trailing_zeros(state);
+    return level < num_levels ? level : num_levels-1;
+}
+
+} // namespace detail
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - allocator hooks
+//==============================================================================
+
+namespace goodliffe {
+namespace detail {
+
+/// Hooks that let an allocator find out about bulk operations on the
+/// nodes it has supplied. By default, these do nothing.
+///
+/// An allocator that pools node memory (e.g. skip_list_pool_allocator)
+/// specialises this to hand unused memory back when a list is cleared.
+template <typename Allocator>
+struct node_pool_traits
+{
+    /// Called once every node in a list has been deallocated.
+    static void release_unused(Allocator &) {}
+};
+
 } // namespace detail
 } // namespace goodliffe
 
@@ -358,9 +503,30 @@ struct sl_node
     T           value;
     unsigned    level;
     self_type  *prev;
-    self_type **next; ///< effectively node_type *next[level+1];
+    self_type  *next[1]; ///< effectively node_type *next[level+1];
+
+    /// The number of bytes required for a node with the given level.
+    /// The next array trails the node, and is allocated in the same block.
+    static std::size_t bytes_for(unsigned level)
+        { return sizeof(self_type) + level*sizeof(self_type*); }
 };
 
+/// Give a node's memory back to the allocator it came from. The value must
+/// already have been destroyed.
+template <typename Allocator, typename T>
+inline
+void deallocate_node(const Allocator &alloc, sl_node<T> *node)
+{
+    typedef typename Allocator::template rebind<char>::other node_allocator;
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    assert_that(node->magic == MAGIC_GOOD);
+    node->magic = MAGIC_BAD;
+    for (unsigned n = 0; n <= node->level; ++n) node->next[n] = 0;
+    node->prev = 0;
+#endif
+    node_allocator(alloc).deallocate(reinterpret_cast<char*>(node), sl_node<T>::bytes_for(node->level));
+}
+
 /// Internal implementation of skip_list data structure and methods for
 /// modifying it.
 ///
@@ -389,6 +555,26 @@ public:
 
     static const unsigned num_levels = LevelGenerator::num_levels;
 
+    /// The number of searches find_batch runs side by side.
+    static const unsigned batch_width = 16;
+
+    /// Below this size, the list probably fits in the cache, and
+    /// find_batch just calls find for each key.
+    static const unsigned batch_threshold = 16384;
+
+    /// The search path of an earlier operation, from which later searches
+    /// can start. Valid until a node is removed from the list.
+    class finger
+    {
+    public:
+        finger() : owner(0), erasures(0) {}
+    private:
+        friend class sl_impl;
+        const sl_impl *owner;
+        unsigned long  erasures;
+        node_type     *chain[num_levels];
+    };
+
     sl_impl(const Allocator &alloc = Allocator());
     ~sl_impl();
 
@@ -401,17 +587,41 @@ public:
     const node_type *one_past_front() const                { return head; }
     node_type       *one_past_end()                        { return tail; }
     const node_type *one_past_end() const                  { return tail; }
-    node_type       *find(const key_type &value) const;
-    node_type       *find_first(const key_type &value) const;
-    node_type       *lower_bound(const key_type &key) const;
-    node_type       *upper_bound(const key_type &key) const;
-    node_type       *insert(const value_type &value, node_type *hint = 0);
-    size_type        erase(const key_type &key);
+    template <typename KeyLike>
+    node_type       *find(const KeyLike &key) const;
+    void             find_batch(const key_type * const *keys, node_type **results, unsigned count) const;
+    template <typename KeyLike>
+    node_type       *lower_bound(const KeyLike &key) const;
+    template <typename KeyLike>
+    node_type       *upper_bound(const KeyLike &key) const;
+    node_type       *lower_bound(const key_type &key, finger &f) const;
+    node_type       *insert(const value_type &value, finger &f, bool *inserted = 0);
+    node_type       *insert(const value_type &value, node_type *hint = 0, bool *inserted = 0);
+#if SKIP_LIST_CPP11
+    node_type       *insert(value_type &&value, node_type *hint = 0, bool *inserted = 0);
+    template <typename... Args>
+    node_type       *emplace(node_type *hint, bool *inserted, Args&&... args);
+#endif
+    template <typename KeyLike>
+    size_type        erase(const KeyLike &key);
     void             remove(node_type *value);
     void             remove_all();
     void             remove_between(node_type *first, node_type *last);
     void             swap(sl_impl &other);
-    size_type        count(const key_type &value) const;
+    template <typename KeyLike>
+    size_type        count(const KeyLike &key) const;
+
+    template <typename InputIterator>
+    void             assign_sorted(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    size_type        insert_sorted(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    size_type        erase_sorted(InputIterator first, InputIterator last);
+    template <bool OtherDuplicates>
+    size_type        transfer(sl_impl<T,KeyType,KeyCompare,Allocator,LevelGenerator,OtherDuplicates,KeyFromValue> &other,
+                              node_type *first, node_type *last);
+    node_type       *extract(node_type *node);
+    node_type       *insert_node(node_type *node, node_type *hint = 0, bool *inserted = 0);
 
     template <typename STREAM>
     void        dump(STREAM &stream) const;
@@ -421,11 +631,33 @@ public:
     compare_type less;
 
 private:
-    typedef typename Allocator::template rebind<node_type>::other    node_allocator;
-    typedef typename Allocator::template rebind<node_type*>::other   list_allocator;
+    typedef typename Allocator::template rebind<char>::other         node_allocator;
+
+    template <typename, typename, typename, typename, typename, bool, typename>
+    friend class sl_impl;
 
     sl_impl(const sl_impl &other);
     sl_impl &operator=(const sl_impl &other);
+
+    /// Whether node goes before key: if it is less, or with
+    /// AfterEquivalents, if it is not greater.
+    template <bool AfterEquivalents>
+    bool precedes(const node_type *node, const key_type &key) const
+    {
+        return AfterEquivalents ? !less(key, KeyFromValue()(node->value))
+                                : less(KeyFromValue()(node->value), key);
+    }
+
+    void       start_finger(finger &f, node_type *from) const;
+    node_type *hint_predecessor(node_type *hint, const key_type &key) const;
+    template <bool AfterEquivalents>
+    node_type *climb_finger(finger &f, unsigned level, const key_type &key) const;
+    template <bool AfterEquivalents>
+    node_type *finger_search(const key_type &key, finger &f, unsigned top) const;
+    node_type *find_insert_point(const key_type &key, finger &f, unsigned level) const;
+    void       link(node_type *new_node, finger &f);
+    void       unlink(node_type *node, node_type * const *chain = 0);
+    void       detach(node_type *node, node_type * const *chain = 0);
     
     allocator_type  alloc;
     generator_type  generator;
@@ -433,11 +665,14 @@ private:
     node_type      *head;
     node_type      *tail;
     size_type       item_count;
+    unsigned long   erasures; ///< bumped when nodes are freed; invalidates fingers
     
     node_type *allocate(unsigned level)
     {
-        node_type *node = node_allocator(alloc).allocate(1, (void*)0);
-        node->next  = list_allocator(alloc).allocate(level+1, (void*)0);
+        // One block per node: the tower of next pointers lives at the end
+        // of the node, so a search hop needs no second dereference.
+        node_type *node = reinterpret_cast<node_type*>(
+            node_allocator(alloc).allocate(node_type::bytes_for(level), (void*)0));
         node->level = level;
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
         for (unsigned n = 0; n <= level; ++n) node->next[n] = 0;
@@ -448,14 +683,7 @@ private:
 
     void deallocate(node_type *node)
     {
-#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-        assert_that(node->magic == MAGIC_GOOD);
-        node->magic = MAGIC_BAD;
-        for (unsigned n = 0; n <= node->level; ++n) node->next[n] = 0;
-        node->prev = 0;
-#endif
-        list_allocator(alloc).deallocate(node->next, node->level+1);
-        node_allocator(alloc).deallocate(node, 1);
+        deallocate_node(alloc, node);
     }
 };
 
@@ -466,7 +694,8 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::sl_impl(const allocator_type &alloc_)
     levels(0),
     head(allocate(num_levels)),
     tail(allocate(num_levels)),
-    item_count(0)
+    item_count(0),
+    erasures(0)
 {
     for (unsigned n = 0; n < num_levels; n++)
     {
@@ -487,30 +716,19 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::~sl_impl()
 }
 
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <typename KeyLike>
 inline
 typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
-sl_impl<T,K,C,A,LG,D,KeyFromValue>::count(const key_type &key) const
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::count(const KeyLike &key) const
 {
     // only used in multi_skip_lists
     impl_assert_that(D);
 
-    const node_type *node = find(key);
+    // With no spans to sum, the run has to be walked; but only once, from
+    // its start. (random_access_multi_skip_list counts in O(log n).)
+    const node_type *node = lower_bound(key);
     size_type count = 0;
-
-    // backwards (find doesn't necessarily land on the first)
-    const node_type *back = node;
-    if (back != head)
-    {
-        back = back->prev;
-        while (back != head && detail::equivalent(KeyFromValue()(back->value), key, less))
-        {
-            ++count;
-            back = back->prev;
-        }
-    }
-
-    // forwards
-    while (is_valid(node) && detail::equivalent(KeyFromValue()(node->value), key, less))
+    while (node != tail && !less(key, KeyFromValue()(node->value)))
     {
         ++count;
         node = node->next[0];
@@ -519,9 +737,10 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::count(const key_type &key) const
 }
 
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <typename KeyLike>
 inline
 typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
-sl_impl<T,K,C,A,LG,D,KeyFromValue>::find(const key_type &key) const
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::find(const KeyLike &key) const
 {
     // I could have an identical const and non-const overload,
     // but this cast is simpler (and safe)
@@ -538,118 +757,412 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::find(const key_type &key) const
     return search;
 }
     
+/// Does find for count keys at once, putting what find(*keys[n]) would
+/// return in results[n].
+///
+/// Each step of a search depends on a node that is probably not in the
+/// cache, so a lone search spends most of its time waiting. Here up to
+/// batch_width searches take turns a step at a time, and each prefetches
+/// the node its next step will look at. By the time a search's turn comes
+/// round again, its node has usually arrived, and the misses overlap
+/// rather than follow one another. That only pays when there are misses:
+/// on a list small enough to stay in the cache, the extra bookkeeping
+/// makes it slower than plain finds, which is what it does there instead.
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
 inline
-typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
-sl_impl<T,K,C,A,LG,D,KeyFromValue>::find_first(const key_type &key) const
+void sl_impl<T,K,C,A,LG,D,KeyFromValue>::find_batch(const key_type * const *keys, node_type **results, unsigned count) const
 {
-    node_type *node = find(key);
-    
-    while (node != head && node->prev != head && detail::equivalent(KeyFromValue()(node->prev->value), key, less))
+    if (item_count < batch_threshold)
     {
-        node = node->prev;
+        for (unsigned n = 0; n < count; ++n) results[n] = find(*keys[n]);
+        return;
     }
-    if (node != head && node != tail && less(KeyFromValue()(node->value), key)) node = node->next[0];
 
-    return node;
+    node_type *search[batch_width];
+    unsigned   level[batch_width];
+
+    for (unsigned done = 0; done < count; done += batch_width)
+    {
+        const unsigned width = count-done < batch_width ? count-done : batch_width;
+        unsigned       active = 0;
+        for (unsigned n = 0; n < width; ++n)
+        {
+            search[n] = const_cast<node_type*>(head);
+            level[n]  = levels;
+            if (level[n]) ++active;
+        }
+
+        while (active)
+        {
+            for (unsigned n = 0; n < width; ++n)
+            {
+                if (!level[n]) continue;
+
+                const unsigned l = level[n]-1;
+                node_type *next = search[n]->next[l];
+                if (next != tail && detail::less_or_equal(KeyFromValue()(next->value), *keys[done+n], less))
+                {
+                    search[n] = next;
+                    SKIP_LIST_PREFETCH(next->next[l]);
+                }
+                else if (--level[n])
+                {
+                    SKIP_LIST_PREFETCH(search[n]->next[l-1]);
+                }
+                else
+                {
+                    --active;
+                }
+            }
+        }
+
+        for (unsigned n = 0; n < width; ++n) results[done+n] = search[n];
+    }
 }
 
+/// The first node not less than key. The descent passes only nodes less
+/// than key, so it stops in front of a run of equivalents rather than
+/// landing in it, and never walks the run.
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <typename KeyLike>
 inline
 typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
-sl_impl<T,K,C,A,LG,D,KeyFromValue>::lower_bound(const key_type &key) const
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::lower_bound(const KeyLike &key) const
 {
-    node_type *node = find_first(key);
-    if (node == one_past_front()) node = node->next[0];
-	return node;
+    node_type *search = const_cast<node_type*>(head);
+
+    for (unsigned l = levels; l; )
+    {
+        --l;
+        while (search->next[l] != tail && less(KeyFromValue()(search->next[l]->value), key))
+        {
+            search = search->next[l];
+        }
+    }
+    return search->next[0];
 }
 
+/// The first node greater than key. find's descent passes every node not
+/// greater than key, equivalents included, so this is the one after it.
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <typename KeyLike>
 inline
 typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
-sl_impl<T,K,C,A,LG,D,KeyFromValue>::upper_bound(const key_type &key) const
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::upper_bound(const KeyLike &key) const
+{
+    return find(key)->next[0];
+}
+
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::node_type*
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::insert(const value_type &value, finger &f, bool *inserted)
 {
-    node_type *node = find_first(key);
-    if (node == one_past_front()) node = node->next[0];
-    while (is_valid(node) && detail::equivalent(KeyFromValue()(node->value), key, less))
+    if (f.owner != this || f.erasures != erasures) start_finger(f, 0);
+
+    const unsigned level    = new_level();
+    node_type     *existing = find_insert_point(KeyFromValue()(value), f, level);
+    if (existing)
     {
-        node = node->next[0];
+        if (inserted) *inserted = false;
+        return existing;
     }
-    return node;
+
+    node_type *new_node = allocate(level);
+    assert_that(new_node);
+    alloc.construct(&new_node->value, value);
+    link(new_node, f);
+
+    if (inserted) *inserted = true;
+    return new_node;
 }
 
 template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
 inline
 typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::node_type*
-sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::insert(const value_type &value, node_type *hint)
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::insert(const value_type &value, node_type *hint, bool *inserted)
 {
-    const key_type& key = KeyFromValue()(value);
-    const unsigned level = new_level();
+    finger f;
+    start_finger(f, hint_predecessor(hint, KeyFromValue()(value)));
+    return insert(value, f, inserted);
+}
+
+#if SKIP_LIST_CPP11
+
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::node_type*
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::insert(value_type &&value, node_type *hint, bool *inserted)
+{
+    finger f;
+    start_finger(f, hint_predecessor(hint, KeyFromValue()(value)));
+
+    const unsigned level    = new_level();
+    node_type     *existing = find_insert_point(KeyFromValue()(value), f, level);
+    if (existing)
+    {
+        if (inserted) *inserted = false;
+        return existing;
+    }
 
     node_type *new_node = allocate(level);
     assert_that(new_node);
-    assert_that(new_node->level == level);
-    alloc.construct(&new_node->value, value);
+    std::allocator_traits<allocator_type>::construct(alloc, &new_node->value, std::move(value));
+    link(new_node, f);
 
-    const bool good_hint    = is_valid(hint) && hint->level == levels-1 && !detail::less_or_equal(key, KeyFromValue()(hint->value), less);
-    node_type *insert_point = good_hint ? hint : head;
-    unsigned   l            = levels;
+    if (inserted) *inserted = true;
+    return new_node;
+}
 
-    while (l)
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+template <typename... Args>
+inline
+typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::node_type*
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::emplace(node_type *hint, bool *inserted, Args&&... args)
+{
+    // We can't know the key until the value exists, so the node is built
+    // first, and thrown away again if the key is already present.
+    const unsigned level    = new_level();
+    node_type     *new_node = allocate(level);
+    try
+    {
+        std::allocator_traits<allocator_type>::construct(alloc, &new_node->value, std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        deallocate(new_node);
+        throw;
+    }
+
+    finger f;
+    start_finger(f, hint_predecessor(hint, KeyFromValue()(new_node->value)));
+    node_type *existing = find_insert_point(KeyFromValue()(new_node->value), f, level);
+    if (existing)
+    {
+        std::allocator_traits<allocator_type>::destroy(alloc, &new_node->value);
+        deallocate(new_node);
+        if (inserted) *inserted = false;
+        return existing;
+    }
+
+    link(new_node, f);
+
+    if (inserted) *inserted = true;
+    return new_node;
+}
+
+#endif
+
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::lower_bound(const key_type &key, finger &f) const
+{
+    if (f.owner != this || f.erasures != erasures) start_finger(f, 0);
+    return finger_search<false>(key, f, 0)->next[0];
+}
+
+/// Point a finger at a node: every level of its tower starts from it. The
+/// levels above are left empty, and are filled in only when a search climbs
+/// that high (see climb_finger). With no node, everything starts from head.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+void sl_impl<T,K,C,A,LG,D,KeyFromValue>::start_finger(finger &f, node_type *from) const
+{
+    f.owner    = this;
+    f.erasures = erasures;
+
+    if (!is_valid(from))
+    {
+        for (unsigned l = 0; l < num_levels; ++l) f.chain[l] = head;
+        return;
+    }
+
+    for (unsigned l = 0; l < num_levels; ++l)
+    {
+        f.chain[l] = l <= from->level ? from : 0;
+    }
+}
+
+/// The node key goes straight after, if an insert hint says where that is,
+/// or 0. The hint may be that node, or the one key goes before (end() for
+/// the back of the list); it is checked, at a cost of two comparisons, so
+/// that a finger is only ever started from a node next to key. A hint
+/// anywhere else is no use, and the search starts from head instead.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::hint_predecessor(node_type *hint, const key_type &key) const
+{
+    if (!hint || hint == head) return 0;
+
+    if (hint != tail && precedes<false>(hint, key))
+    {
+        node_type *next = hint->next[0];
+        return next == tail || !precedes<false>(next, key) ? hint : 0;
+    }
+
+    node_type *before = hint->prev;
+    return before == head || precedes<false>(before, key) ? before : 0;
+}
+
+/// Fill in the empty levels of a finger, those above the tower of the node
+/// next to key it was started from (see hint_predecessor), and return the
+/// node at the given level. The nodes there are found by a search down
+/// from head, through those levels only: below them the finger already
+/// has key's predecessor. If that is the back of the list, every node
+/// precedes key, and the search needs no comparisons at all.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <bool AfterEquivalents>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::climb_finger(finger &f, unsigned level, const key_type &key) const
+{
+    assert_that(level > 0);
+    assert_that(f.chain[level-1]);
+    assert_that(!f.chain[level]);
+
+    const bool at_back = f.chain[level-1]->next[0] == tail;
+    node_type *search  = const_cast<node_type*>(head);
+    for (unsigned l = num_levels; l > level; )
     {
         --l;
-        assert_that(l <= insert_point->level);
-        while (insert_point->next[l] != tail && less(KeyFromValue()(insert_point->next[l]->value), key))
+        if (l < levels)
         {
-            insert_point = insert_point->next[l];
-            assert_that(l <= insert_point->level);
+            while (search->next[l] != tail && (at_back || precedes<AfterEquivalents>(search->next[l], key)))
+            {
+                search = search->next[l];
+            }
         }
-        
-        if (l <= level)
+        f.chain[l] = search;
+    }
+    return search;
+}
+
+/// Search for the nodes preceding key, starting from the finger rather than
+/// from the top of head. Afterwards the finger holds exactly the node
+/// preceding key at every level up to top. Returns the level 0 predecessor.
+/// With AfterEquivalents, nodes equivalent to key count as preceding it.
+/// Levels above the list's top can only start at head, and are left for
+/// link to fill in.
+///
+/// The finger only needs to hold, at each level, a node of that height or
+/// more (or nothing, above a node next to key, for climb_finger to fill
+/// in): it need not be the predecessor of anything in particular. We climb
+/// from level top until the finger's node there (or the one after it) is
+/// before key and its successor is not, and search down from there. For a
+/// key d elements from the finger, that is expected O(log d) levels.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <bool AfterEquivalents>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::finger_search(const key_type &key, finger &f, unsigned top) const
+{
+    assert_that(f.owner == this);
+    if (!levels) return head;
+    if (top >= levels) top = levels-1;
+
+    for (unsigned l = 1; l <= top; ++l)
+    {
+        if (!f.chain[l]) climb_finger<AfterEquivalents>(f, l, key);
+    }
+
+    unsigned   l = top;
+    node_type *search;
+    for (;; ++l)
+    {
+        search = f.chain[l] ? f.chain[l] : climb_finger<AfterEquivalents>(f, l, key);
+        if (search == head || precedes<AfterEquivalents>(search, key))
         {
-            node_type *next = insert_point->next[l];
-            assert_that(next);
-        
-            new_node->next[l]     = next;
-            insert_point->next[l] = new_node;
+            // A nearby key is often just one step along
+            node_type *next = search->next[l];
+            if (next != tail && precedes<AfterEquivalents>(next, key))
+            {
+                search = next;
+                next   = search->next[l];
+            }
+            if (next == tail || !precedes<AfterEquivalents>(next, key) || l+1 == levels)
+                break;
+        }
+        else if (l+1 == levels)
+        {
+            search = head;
+            break;
         }
     }
-    
-    // By the time we get here, insert_point is the level 0 node immediately
-    // preceding new_node
-    assert_that(insert_point->next[0] == new_node);
-    node_type *next = new_node->next[0];
-    assert_that(next);
-    new_node->prev = insert_point;
-    next->prev = new_node;
 
-    ++item_count;
-          
-#if defined SKIP_LIST_IMPL_DIAGNOSTICS
-      for (unsigned n = 0; n < level; ++n)
-      {
-          assert_that(new_node->next[n] != 0);
-      }
-#endif
+    for (++l; l; )
+    {
+        --l;
+        assert_that(l <= search->level);
+        while (search->next[l] != tail && precedes<AfterEquivalents>(search->next[l], key))
+        {
+            search = search->next[l];
+        }
+        f.chain[l] = search;
+    }
+    return search;
+}
 
-    // Do not allow repeated values in the list
-    if (!AllowDuplicates && next != tail && detail::equivalent(KeyFromValue()(next->value), key, less))
+/// Fill the finger with the nodes a new node of the given level will follow.
+/// If duplicates are not allowed and key is already present, returns the
+/// node holding it; otherwise returns 0.
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::node_type*
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::find_insert_point(const key_type &key, finger &f, unsigned level) const
+{
+    node_type *insert_point = finger_search<false>(key, f, level);
+
+    // Do not allow repeated values in the list. We know before allocating
+    // anything: an equivalent node can only be the next one along.
+    if (!AllowDuplicates)
     {
-        remove(new_node);
-        new_node = tail;
+        node_type *next = insert_point->next[0];
+        if (next != tail && detail::equivalent(KeyFromValue()(next->value), key, less))
+            return next;
     }
+    return 0;
+}
+
+/// Link a node with a constructed value in after the nodes in the finger,
+/// and move the finger on to it.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+void sl_impl<T,K,C,A,LG,D,KeyFromValue>::link(node_type *new_node, finger &f)
+{
+    // The list only grows taller once a node is actually linked, so a
+    // rejected insert leaves levels alone
+    for (unsigned l = levels; l <= new_node->level; ++l) f.chain[l] = head;
+    if (new_node->level >= levels) levels = new_node->level+1;
+
+    for (unsigned l = 0; l <= new_node->level; ++l)
+    {
+        node_type *next = f.chain[l]->next[l];
+        assert_that(next);
+
+        new_node->next[l]  = next;
+        f.chain[l]->next[l] = new_node;
+        if (!l)
+        {
+            new_node->prev = f.chain[0];
+            next->prev     = new_node;
+        }
+        f.chain[l] = new_node;
+    }
+
+    ++item_count;
 
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
-
-    return new_node;
 }
 
 template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+template <typename KeyLike>
 inline
 typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::size_type
-sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::erase(const key_type &key)
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::erase(const KeyLike &key)
 {
     node_type *node = find(key);
     if (is_valid(node) && detail::equivalent(KeyFromValue()(node->value), key, less))
@@ -667,56 +1180,58 @@ template <class T, class K, class C, class A, class LG, bool AllowDuplicates, ty
 inline
 void
 sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::remove(node_type *node)
+{
+    unlink(node);
+    ++erasures;
+    
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+/// Take a node out of the list and free it. The nodes before it at each
+/// level can be given in chain, if the caller already knows them. Fingers
+/// are left alone: one that doesn't hold this node is still good, so it is
+/// up to the caller to bump erasures if it can't be sure of that.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+void
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::unlink(node_type *node, node_type * const *chain)
+{
+    detach(node, chain);
+    alloc.destroy(&node->value);
+    deallocate(node);
+}
+
+/// Take a node out of the list, as unlink does, but leave it allocated.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+void
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::detach(node_type *node, node_type * const *chain)
 {
     assert_that(is_valid(node));
     assert_that(node->next[0]);
 
-    const key_type& key = KeyFromValue()(node->value);
     node->next[0]->prev = node->prev;
 
-    // patch up all next pointers
-    node_type *cur = head;
-    for (unsigned l = levels; l; )
+    // Patch up all next pointers. The predecessor at level l is the nearest
+    // node before this one whose tower reaches level l, so we can find each
+    // by walking back along level 0 without comparing any keys (this also
+    // picks the right node out of a run of duplicates).
+    node_type *cur = node->prev;
+    for (unsigned l = 0; l <= node->level; ++l)
     {
-        --l;
-        assert_that(l <= cur->level);
-        while (cur->next[l] != tail && less(KeyFromValue()(cur->next[l]->value), key))
+        if (chain) cur = chain[l];
+        while (cur->level < l)
         {
-            cur = cur->next[l];
-        }
-        if (AllowDuplicates)
-        {
-            node_type *cur2 = cur;
-
-            while (cur2 != tail)
-            {
-                node_type *next = cur2->next[l];
-                if (next == tail) break;
-                if (next == node)
-                {
-                    cur = cur2;
-                    break;
-                }
-                if (detail::equivalent(KeyFromValue()(cur2->next[l]->value), key, less))
-                    cur2 = next;
-                else
-                    break;
-            }
-        }
-        if (cur->next[l] == node)
-        {
-            cur->next[l] = node->next[l];
+            cur = cur->prev;
+            assert_that(cur);
         }
+        assert_that(cur->next[l] == node);
+        cur->next[l] = node->next[l];
     }
 
-    alloc.destroy(&node->value);
-    deallocate(node);
-
     item_count--;
-    
-#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
-    check();
-#endif
 }
 
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
@@ -732,17 +1247,28 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::remove_all()
         deallocate(node);
         node = next;
     }
+    node_pool_traits<allocator_type>::release_unused(alloc);
 
     for (unsigned l = 0; l < num_levels; ++l)
         head->next[l] = tail;
     tail->prev = head;
     item_count = 0;
+    ++erasures;
         
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
 }
 
+/// Remove the nodes [first, last]. They are found by identity rather than
+/// by key, so this works within a run of duplicates too.
+///
+/// One walk along the range notes, for each level, the first and last
+/// node whose tower reaches it: only those levels have pointers into the
+/// range. A search for first's key then goes down from the top, and from
+/// the tallest level of the range down, steps along each level until the
+/// next node is the range's first there. That costs O(log n + k) for k
+/// nodes, plus the duplicates of first's key ahead of it, if any.
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
 inline
 void 
@@ -750,35 +1276,43 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::remove_between(node_type *first, node_type *
 {
     assert_that(is_valid(first));
     assert_that(is_valid(last));
-    assert_that(!D);
 
-    node_type       * const prev         = first->prev;
     node_type       * const one_past_end = last->next[0];
-        
-    const key_type& first_key = KeyFromValue()(first->value);
-    const key_type& last_key = KeyFromValue()(last->value);
+
+    node_type *firsts[num_levels];
+    node_type *lasts[num_levels];
+    unsigned   top = 0; // the number of levels the range reaches
+    for (node_type *node = first; node != one_past_end; node = node->next[0])
+    {
+        assert_that(is_valid(node));
+        for (; top <= node->level; ++top) firsts[top] = node;
+        for (unsigned l = 0; l <= node->level; ++l) lasts[l] = node;
+    }
 
     // backwards pointer
-    one_past_end->prev = prev;
+    one_past_end->prev = first->prev;
 
     // forwards pointers
+    const key_type &first_key = KeyFromValue()(first->value);
     node_type *cur = head;
     for (unsigned l = levels; l; )
     {
         --l;
-        assert_that(l < cur->level);
-        while (cur->next[l] != tail && less(KeyFromValue()(cur->next[l]->value), first_key))
+        if (l >= top)
         {
-            cur = cur->next[l];
+            while (cur->next[l] != tail && less(KeyFromValue()(cur->next[l]->value), first_key))
+            {
+                cur = cur->next[l];
+            }
         }
-        if (cur->next[l] != tail
-            && detail::less_or_equal(KeyFromValue()(cur->next[l]->value), last_key, less))
+        else
         {
-            // patch up next[l] pointer
-            node_type *end = cur->next[l];
-            while (end != tail && detail::less_or_equal(KeyFromValue()(end->value), last_key, less))
-                end = end->next[l];
-            cur->next[l] = end;
+            while (cur->next[l] != firsts[l])
+            {
+                assert_that(cur->next[l] != tail);
+                cur = cur->next[l];
+            }
+            cur->next[l] = lasts[l]->next[l];
         }
     }
 
@@ -791,12 +1325,262 @@ sl_impl<T,K,C,A,LG,D,KeyFromValue>::remove_between(node_type *first, node_type *
         item_count--;
         first = next;
     }
+    ++erasures;
     
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
 }
 
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+template <typename InputIterator>
+inline
+void
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::assign_sorted(InputIterator first, InputIterator last)
+{
+    remove_all();
+
+    // The last node at each level: as the input is in order, every new node
+    // is appended after all of them, so no searching is needed.
+    node_type *chain[num_levels];
+    for (unsigned l = 0; l < num_levels; ++l) chain[l] = head;
+
+    for (; first != last; ++first)
+    {
+        const value_type &value = *first;
+        node_type *back = chain[0];
+
+        if (back != head)
+        {
+            assert_that(!less(KeyFromValue()(value), KeyFromValue()(back->value)));
+            if (!AllowDuplicates && !less(KeyFromValue()(back->value), KeyFromValue()(value)))
+                continue;
+        }
+
+        const unsigned level = new_level();
+        if (level >= levels) levels = level+1;
+        node_type *node = allocate(level);
+        alloc.construct(&node->value, value);
+
+        for (unsigned l = 0; l <= level; ++l)
+        {
+            node->next[l]     = tail;
+            chain[l]->next[l] = node;
+            chain[l]          = node;
+        }
+        node->prev = back;
+        tail->prev = node;
+        ++item_count;
+    }
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+}
+
+/// Merge the values in [first, last) into the list, returning how many were
+/// added. One finger is carried through the whole run: for sorted input,
+/// each insertion point is searched for from the last one, with the
+/// predecessors at every level to hand, so m values cost O(m log(n/m)).
+/// When m is close to n that is a plain linear merge.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <typename InputIterator>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::insert_sorted(InputIterator first, InputIterator last)
+{
+    finger    f;
+    size_type count = 0;
+    for (; first != last; ++first)
+    {
+        bool inserted;
+        insert(*first, f, &inserted);
+        if (inserted) ++count;
+    }
+    return count;
+}
+
+/// Remove every value equivalent to each key in [first, last), returning
+/// how many went. As for insert_sorted, sorted keys are searched for from
+/// one another. The finger only ever holds nodes before the key, so none
+/// of them goes, and it stays good throughout.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+template <typename InputIterator>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::size_type
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::erase_sorted(InputIterator first, InputIterator last)
+{
+    finger    f;
+    size_type count = 0;
+    start_finger(f, 0);
+    for (; first != last; ++first)
+    {
+        const key_type &key  = *first;
+        node_type      *node = finger_search<false>(key, f, 0)->next[0];
+        while (node != tail && !less(key, KeyFromValue()(node->value)))
+        {
+            // The finger holds the nodes before this one at the levels the
+            // search came down through. Above those it may be a step or so
+            // behind, but it is a walk along the level, with no comparing,
+            // to the node before, which is what unlink needs.
+            for (unsigned l = 1; l <= node->level; ++l)
+            {
+                while (f.chain[l]->next[l] != node) f.chain[l] = f.chain[l]->next[l];
+            }
+
+            node_type *next = node->next[0];
+            unlink(node, f.chain);
+            ++count;
+            node = next;
+        }
+    }
+    if (count) ++erasures;
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+    return count;
+}
+
+/// Move the nodes of [first, last), in other, into this list, and return
+/// how many moved. Nothing is allocated or copied: each node is unlinked
+/// from other and linked in here, tower and all. If this list does not
+/// allow duplicates, a node equivalent to one already here stays in other.
+/// Nodes from other go after any equivalents here, in the order they were.
+///
+/// The range is walked in order, and linked in through one finger, so
+/// moving m nodes into a list of n costs O(m log(n/m)): a linear merge
+/// when the lists are of a size, and much less for a few nodes into a big
+/// list. The nodes before first in other are found with one search for
+/// its key, and those that stay in other are chained back together as the
+/// walk goes, so other costs O(log n + m), plus the duplicates of first's
+/// key ahead of it, if any.
+///
+/// The two lists' allocators must compare equal, since the nodes change
+/// hands.
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+template <bool OtherDuplicates>
+inline
+typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::size_type
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::transfer(
+    sl_impl<T,K,C,A,LG,OtherDuplicates,KeyFromValue> &other, node_type *first, node_type *last)
+{
+    assert_that(alloc == other.alloc);
+    if (static_cast<void*>(&other) == static_cast<void*>(this) || first == last) return 0;
+    assert_that(other.is_valid(first));
+
+    // keep[l] is the last node staying in other at level l, and after[l]
+    // the node other's level l goes on to after the range. A search for
+    // first's key stops before any equivalents of it; walking those by
+    // identity finds the nodes just before first itself.
+    node_type *keep[num_levels];
+    node_type *after[num_levels];
+    const key_type &first_key = KeyFromValue()(first->value);
+    node_type      *cur       = other.head;
+    for (unsigned l = other.levels; l; )
+    {
+        --l;
+        while (cur->next[l] != other.tail && other.less(KeyFromValue()(cur->next[l]->value), first_key))
+        {
+            cur = cur->next[l];
+        }
+        keep[l] = cur;
+    }
+    for (cur = cur->next[0]; cur != first; cur = cur->next[0])
+    {
+        assert_that(other.is_valid(cur));
+        for (unsigned l = 0; l <= cur->level; ++l) keep[l] = cur;
+    }
+    for (unsigned l = 0; l < other.levels; ++l) after[l] = keep[l]->next[l];
+
+    finger    f;
+    size_type moved = 0;
+    start_finger(f, 0);
+    for (node_type *node = first; node != last; )
+    {
+        assert_that(other.is_valid(node));
+        node_type *next = node->next[0];
+        for (unsigned l = 0; l <= node->level; ++l) after[l] = node->next[l];
+
+        const key_type &key    = KeyFromValue()(node->value);
+        node_type      *before = finger_search<true>(key, f, node->level);
+        if (!AllowDuplicates && before != head && !less(KeyFromValue()(before->value), key))
+        {
+            node->prev = keep[0];
+            for (unsigned l = 0; l <= node->level; ++l)
+            {
+                keep[l]->next[l] = node;
+                keep[l]          = node;
+            }
+        }
+        else
+        {
+            link(node, f);
+            ++moved;
+        }
+        node = next;
+    }
+
+    for (unsigned l = 0; l < other.levels; ++l) keep[l]->next[l] = after[l];
+    after[0]->prev = keep[0];
+
+    if (moved)
+    {
+        other.item_count -= moved;
+        ++other.erasures;
+    }
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    other.check();
+#endif
+    return moved;
+}
+
+/// Take a node out of the list without freeing it, and return it. It can
+/// be given to insert_node later, of this list or another with the same
+/// allocator.
+template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,D,KeyFromValue>::node_type *
+sl_impl<T,K,C,A,LG,D,KeyFromValue>::extract(node_type *node)
+{
+    detach(node);
+    ++erasures;
+
+#ifdef SKIP_LIST_IMPL_DIAGNOSTICS
+    check();
+#endif
+    return node;
+}
+
+/// Link in a node that already holds a value, one that extract took out,
+/// as insert would link in a new one. The node keeps its tower. If
+/// duplicates are not allowed and the key is already present, the node is
+/// left alone and the one holding the key is returned.
+template <class T, class K, class C, class A, class LG, bool AllowDuplicates, typename KeyFromValue>
+inline
+typename sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::node_type*
+sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::insert_node(node_type *node, node_type *hint, bool *inserted)
+{
+    assert_that(node->level < num_levels);
+
+    finger f;
+    start_finger(f, hint_predecessor(hint, KeyFromValue()(node->value)));
+
+    // link raises levels for a tall node, once it is sure to go in
+    node_type *existing = find_insert_point(KeyFromValue()(node->value), f, node->level);
+    if (existing)
+    {
+        if (inserted) *inserted = false;
+        return existing;
+    }
+
+    link(node, f);
+
+    if (inserted) *inserted = true;
+    return node;
+}
+
 template <class T, class K, class C, class A, class LG, bool D,typename KeyFromValue>
 inline
 unsigned sl_impl<T,K,C,A,LG,D,KeyFromValue>::new_level()
@@ -804,8 +1588,7 @@ unsigned sl_impl<T,K,C,A,LG,D,KeyFromValue>::new_level()
     unsigned level = generator.new_level();
     if (level >= levels)
     {
-        level = levels;
-        ++levels;
+        level = levels < num_levels ? levels : num_levels-1;
     }
     return level;
 }
@@ -824,6 +1607,10 @@ void sl_impl<T,K,C,A,LG,D,KeyFromValue>::swap(sl_impl &other)
     swap(tail,       other.tail);
     swap(item_count, other.item_count);
 
+    // Fingers now refer to the other list's nodes
+    ++erasures;
+    ++other.erasures;
+
 #ifdef SKIP_LIST_IMPL_DIAGNOSTICS
     check();
 #endif
@@ -858,12 +1645,12 @@ void sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::dump(STREAM &s) const
             {
                 if (AllowDuplicates)
                 {
-                    if (next != tail && !detail::less_or_equal(n->value, next->value, less))
+                    if (next != tail && !detail::less_or_equal(KeyFromValue()(n->value), KeyFromValue()(next->value), less))
                         s << "*XXXXXXXXX*";
                 }
                 else
                 {
-                    if (next != tail && !less(n->value, next->value))
+                    if (next != tail && !less(KeyFromValue()(n->value), KeyFromValue()(next->value)))
                         s << "*XXXXXXXXX*";
                 }
             }
@@ -909,8 +1696,8 @@ bool sl_impl<T,K,C,A,LG,AllowDuplicates,KeyFromValue>::check() const
             node_type *next = n->next[l];
             if (n != head && next != tail)
             {
-                if ((!AllowDuplicates && !(less(n->value, next->value)))
-                    || (AllowDuplicates && !(detail::less_or_equal(n->value, next->value, less))))
+                if ((!AllowDuplicates && !(less(KeyFromValue()(n->value), KeyFromValue()(next->value))))
+                    || (AllowDuplicates && !(detail::less_or_equal(KeyFromValue()(n->value), KeyFromValue()(next->value), less))))
                 {
                     assert_that(false && "value order error");
                     dump(std::cerr);
@@ -949,6 +1736,133 @@ template <typename P> struct select1st
 } // namespace detail
 } // namespace goodliffe
 
+//==============================================================================
+#pragma mark - node handles
+//==============================================================================
+
+#if SKIP_LIST_CPP11
+
+namespace goodliffe {
+namespace detail {
+
+/// Owns a node that extract has taken out of a list, so that it can go
+/// into a list again without freeing, allocating or copying anything.
+/// Handles move, but do not copy. An empty handle owns nothing.
+///
+/// A node's tower can't change height, so lists exchange nodes only when
+/// they agree on the value type, allocator and number of levels: the
+/// handle type says so.
+template <typename T, typename Allocator, unsigned NumLevels>
+class sl_node_handle
+{
+public:
+    typedef T           value_type;
+    typedef Allocator   allocator_type;
+    typedef sl_node<T>  node_type;
+
+    static const unsigned num_levels = NumLevels;
+
+    sl_node_handle() : node(0), alloc() {}
+    sl_node_handle(node_type *node_, const Allocator &alloc_) ///< @internal
+        : node(node_), alloc(alloc_) {}
+    sl_node_handle(sl_node_handle &&other)
+        : node(other.node), alloc(other.alloc) { other.node = 0; }
+    ~sl_node_handle() { reset(); }
+
+    sl_node_handle &operator=(sl_node_handle &&other);
+
+    bool           empty() const          { return node == 0; }
+    explicit       operator bool() const  { return node != 0; }
+    allocator_type get_allocator() const  { return alloc; }
+    value_type    &value() const          { assert_that(node); return node->value; }
+
+    void swap(sl_node_handle &other);
+
+    node_type *get_node() const { return node; } ///< @internal
+    node_type *release()                         ///< @internal
+        { node_type *released = node; node = 0; return released; }
+
+private:
+    void reset();
+
+    node_type *node;
+    Allocator  alloc;
+};
+
+/// A node handle for skip_list_map, which can change the key while the
+/// node is out of the map.
+template <typename Key, typename Mapped, typename Allocator, unsigned NumLevels>
+class sl_map_node_handle
+    : public sl_node_handle<std::pair<const Key, Mapped>, Allocator, NumLevels>
+{
+    typedef sl_node_handle<std::pair<const Key, Mapped>, Allocator, NumLevels> parent_type;
+
+public:
+    typedef Key    key_type;
+    typedef Mapped mapped_type;
+
+    sl_map_node_handle() {}
+    sl_map_node_handle(typename parent_type::node_type *node_, const Allocator &alloc_) ///< @internal
+        : parent_type(node_, alloc_) {}
+    sl_map_node_handle(sl_map_node_handle &&other)
+        : parent_type(std::move(other)) {}
+
+    sl_map_node_handle &operator=(sl_map_node_handle &&other)
+        { parent_type::operator=(std::move(other)); return *this; }
+
+    key_type    &key() const    { return const_cast<key_type&>(this->value().first); }
+    mapped_type &mapped() const { return this->value().second; }
+};
+
+/// What inserting a node handle returns: where the element is, whether
+/// the node went in, and, if it didn't, the handle still holding it.
+template <typename Iterator, typename NodeHandle>
+struct sl_insert_return_type
+{
+    Iterator   position;
+    bool       inserted;
+    NodeHandle node;
+};
+
+template <typename T, typename A, unsigned NL>
+inline
+sl_node_handle<T,A,NL> &sl_node_handle<T,A,NL>::operator=(sl_node_handle &&other)
+{
+    if (&other != this)
+    {
+        reset();
+        node       = other.node;
+        alloc      = other.alloc;
+        other.node = 0;
+    }
+    return *this;
+}
+
+template <typename T, typename A, unsigned NL>
+inline
+void sl_node_handle<T,A,NL>::swap(sl_node_handle &other)
+{
+    std::swap(node, other.node);
+    std::swap(alloc, other.alloc);
+}
+
+template <typename T, typename A, unsigned NL>
+inline
+void sl_node_handle<T,A,NL>::reset()
+{
+    if (node)
+    {
+        alloc.destroy(&node->value);
+        deallocate_node(alloc, node);
+        node = 0;
+    }
+}
+
+} // namespace detail
+} // namespace goodliffe
+
+#endif
+
 //==============================================================================
 
 #ifdef _MSC_VER
@@ -0,0 +1,405 @@
+//==============================================================================
+// skip_list_epoch_reclaimer.h
+//==============================================================================
+
+#pragma once
+
+#include "skip_list_detail.h"
+
+#if !SKIP_LIST_CPP11
+#error "epoch_reclaimer needs C++11 (std::atomic and thread_local)"
+#endif
+
+#include <atomic>
+#include <cstddef>    // for std::size_t
+#include <vector>
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
+#endif
+
+//==============================================================================
+#pragma mark - epoch_reclaimer
+//==============================================================================
+
+namespace goodliffe {
+
+/// Defers freeing memory until no thread can still be reading it. This is
+/// what lets the concurrent containers erase nodes that other threads may
+/// be in the middle of walking over.
+///
+/// A thread pins the current epoch, with a guard, for the length of each
+/// operation. Anything it unlinks is retired, stamped with the epoch of its
+/// retirement, instead of being freed. The global epoch only moves on once
+/// every pinned thread has seen the current one, so by the time it has
+/// moved on twice, nobody can still hold a pointer to something retired
+/// two epochs ago, and that is freed.
+///
+/// Each thread works through a record, which holds its pinned epoch and
+/// its list of retired objects. By default a guard borrows a record from
+/// the reclaimer and hands it back when it goes, which costs a couple of
+/// atomic exchanges per operation. A thread that will make many calls can
+/// register instead: it keeps a record to itself until the registration
+/// goes, and its guards are then little more than a store each.
+///
+/// Retired objects are freed in batches: a run of objects retired together
+/// with the same free_function goes back in a single call, so a node
+/// allocator can take them all at once.
+///
+/// Guards nest. The reclaimer itself must outlive every guard and
+/// registration, and frees whatever is still retired when it goes.
+///
+/// @see concurrent_skip_list
+class epoch_reclaimer
+{
+    struct batch
+    {
+        typedef void (*free_function)(void *context, void **objects, std::size_t count);
+
+        free_function  free;
+        void          *context;
+        unsigned long  epoch;
+        std::size_t    count;
+    };
+
+    struct record
+    {
+        record() : in_use(true), epoch(0), next(0), pins(0), since_collect(0) {}
+
+        std::atomic<bool>          in_use;
+        std::atomic<unsigned long> epoch;   ///< pinned epoch, or 0 if not pinned
+        record                    *next;    ///< fixed once published
+
+        // Only touched by the thread that holds the record
+        unsigned                   pins;
+        std::size_t                since_collect;
+        std::vector<void*>         retired;
+        std::vector<batch>         batches; ///< runs of retired, oldest first
+    };
+
+public:
+
+    /// Frees count objects, all retired with the same context.
+    typedef batch::free_function free_function;
+
+    epoch_reclaimer();
+    ~epoch_reclaimer();
+
+    /// Pins the current epoch for the calling thread while it exists.
+    class guard
+    {
+    public:
+        explicit guard(epoch_reclaimer &reclaimer);
+        ~guard();
+
+        /// Arrange for free(context, ...) to be called with object once no
+        /// thread can be reading it. It must already be unreachable to any
+        /// thread that pins after this call.
+        void retire(void *object, free_function free, void *context);
+
+    private:
+        guard(const guard &);
+        guard &operator=(const guard &);
+
+        epoch_reclaimer &reclaimer;
+        record          *rec;
+    };
+
+    /// Registers the calling thread with the reclaimer while it exists, so
+    /// its guards needn't claim a record each time. It must be destroyed on
+    /// the thread that created it, with no guards outstanding.
+    class registration
+    {
+    public:
+        explicit registration(epoch_reclaimer &reclaimer);
+        ~registration();
+
+    private:
+        registration(const registration &);
+        registration &operator=(const registration &);
+
+        epoch_reclaimer &reclaimer;
+        record          *rec;
+    };
+
+    /// Try to move the epoch on, and free whatever is now safe to. That
+    /// covers everything retired by the calling thread, and by any thread
+    /// that has handed its record back; a registered thread frees its own.
+    /// Guards do this for their own thread every so often anyway.
+    void collect();
+
+private:
+    friend class guard;
+    friend class registration;
+
+    epoch_reclaimer(const epoch_reclaimer &);
+    epoch_reclaimer &operator=(const epoch_reclaimer &);
+
+    /// The record a thread used last, for the reclaimer it used last.
+    struct thread_cache
+    {
+        unsigned long  id;
+        record        *rec;
+        bool           held;        ///< the thread still has rec claimed
+        bool           registered;  ///< ...and won't give it back after a guard
+    };
+
+    /// Objects a record retires between attempts to free some.
+    static const std::size_t retire_threshold = 64;
+
+    static thread_cache &cache();
+    static unsigned long next_id();
+
+    record *held_record() const;
+    record *claim();
+    void    release(record *rec);
+    bool    try_advance();
+    void    collect(record *rec);
+    void    free_retired(record *rec, unsigned long safe_before);
+
+    const unsigned long        id;       ///< tells thread caches apart
+    std::atomic<unsigned long> global_epoch;
+    std::atomic<record*>       records;
+};
+
+inline
+epoch_reclaimer::epoch_reclaimer()
+:   id(next_id()),
+    global_epoch(1),
+    records(0)
+{
+}
+
+inline
+epoch_reclaimer::~epoch_reclaimer()
+{
+    record *rec = records.load(std::memory_order_acquire);
+    while (rec)
+    {
+        assert_that(rec->epoch.load() == 0);
+        record *next = rec->next;
+        free_retired(rec, ~0ul);
+        delete rec;
+        rec = next;
+    }
+
+    thread_cache &c = cache();
+    if (c.id == id) c.id = 0;
+}
+
+inline
+epoch_reclaimer::thread_cache &epoch_reclaimer::cache()
+{
+    static thread_local thread_cache c = { 0, 0, false, false };
+    return c;
+}
+
+inline
+unsigned long epoch_reclaimer::next_id()
+{
+    static std::atomic<unsigned long> ids(0);
+    return ++ids;
+}
+
+/// The record the calling thread already holds, if any: from an enclosing
+/// guard, or a registration.
+inline
+epoch_reclaimer::record *epoch_reclaimer::held_record() const
+{
+    const thread_cache &c = cache();
+    return c.id == id && c.held ? c.rec : 0;
+}
+
+/// Claim a free record, trying the one this thread used last first.
+inline
+epoch_reclaimer::record *epoch_reclaimer::claim()
+{
+    thread_cache &c = cache();
+
+    record *rec = 0;
+    if (c.id == id
+        && !c.rec->in_use.load(std::memory_order_relaxed)
+        && !c.rec->in_use.exchange(true, std::memory_order_acquire))
+    {
+        rec = c.rec;
+    }
+
+    for (record *r = records.load(std::memory_order_acquire); !rec && r; r = r->next)
+    {
+        if (!r->in_use.load(std::memory_order_relaxed)
+            && !r->in_use.exchange(true, std::memory_order_acquire))
+        {
+            rec = r;
+        }
+    }
+
+    if (!rec)
+    {
+        rec = new record;
+        record *head = records.load(std::memory_order_relaxed);
+        do
+        {
+            rec->next = head;
+        }
+        while (!records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    c.id         = id;
+    c.rec        = rec;
+    c.held       = true;
+    c.registered = false;
+    return rec;
+}
+
+/// Hand a record back. Whatever it still has retired waits for the next
+/// thread to claim it.
+inline
+void epoch_reclaimer::release(record *rec)
+{
+    thread_cache &c = cache();
+    if (c.id == id && c.rec == rec)
+    {
+        c.held       = false;
+        c.registered = false;
+    }
+    rec->in_use.store(false, std::memory_order_release);
+}
+
+/// Move the global epoch on, if every pinned thread has seen it.
+inline
+bool epoch_reclaimer::try_advance()
+{
+    unsigned long epoch = global_epoch.load();
+    for (record *rec = records.load(std::memory_order_acquire); rec; rec = rec->next)
+    {
+        const unsigned long pinned = rec->epoch.load();
+        if (pinned && pinned != epoch) return false;
+    }
+    return global_epoch.compare_exchange_strong(epoch, epoch+1);
+}
+
+inline
+void epoch_reclaimer::collect(record *rec)
+{
+    try_advance();
+    const unsigned long epoch = global_epoch.load();
+    if (epoch > 2) free_retired(rec, epoch-1);
+}
+
+inline
+void epoch_reclaimer::collect()
+{
+    try_advance();
+    const unsigned long epoch = global_epoch.load();
+    if (epoch <= 2) return;
+
+    record *held = held_record();
+    for (record *rec = records.load(std::memory_order_acquire); rec; rec = rec->next)
+    {
+        if (rec == held)
+        {
+            free_retired(rec, epoch-1);
+        }
+        else if (!rec->in_use.load(std::memory_order_relaxed)
+                 && !rec->in_use.exchange(true, std::memory_order_acquire))
+        {
+            free_retired(rec, epoch-1);
+            rec->in_use.store(false, std::memory_order_release);
+        }
+    }
+}
+
+/// Free the retired objects stamped with an epoch before safe_before.
+/// They were retired in order, so they are at the front.
+inline
+void epoch_reclaimer::free_retired(record *rec, unsigned long safe_before)
+{
+    std::size_t batches = 0;
+    std::size_t objects = 0;
+    while (batches < rec->batches.size() && rec->batches[batches].epoch < safe_before)
+    {
+        const batch &b = rec->batches[batches];
+        b.free(b.context, &rec->retired[objects], b.count);
+        objects += b.count;
+        ++batches;
+    }
+    rec->batches.erase(rec->batches.begin(), rec->batches.begin()+batches);
+    rec->retired.erase(rec->retired.begin(), rec->retired.begin()+objects);
+}
+
+inline
+epoch_reclaimer::guard::guard(epoch_reclaimer &reclaimer_)
+:   reclaimer(reclaimer_),
+    rec(reclaimer_.held_record())
+{
+    if (!rec) rec = reclaimer.claim();
+
+    // seq_cst, so that try_advance either sees us pinned, or we see the
+    // epoch it moved to.
+    if (rec->pins++ == 0) rec->epoch.store(reclaimer.global_epoch.load());
+}
+
+inline
+epoch_reclaimer::guard::~guard()
+{
+    if (--rec->pins) return;
+
+    rec->epoch.store(0, std::memory_order_release);
+
+    const thread_cache &c = cache();
+    if (!(c.id == reclaimer.id && c.rec == rec && c.registered))
+    {
+        reclaimer.release(rec);
+    }
+}
+
+inline
+void epoch_reclaimer::guard::retire(void *object, free_function free, void *context)
+{
+    const unsigned long epoch = reclaimer.global_epoch.load();
+    if (rec->batches.empty()
+        || rec->batches.back().free != free
+        || rec->batches.back().context != context
+        || rec->batches.back().epoch != epoch)
+    {
+        const batch b = { free, context, epoch, 0 };
+        rec->batches.push_back(b);
+    }
+    rec->retired.push_back(object);
+    ++rec->batches.back().count;
+
+    if (++rec->since_collect == retire_threshold)
+    {
+        rec->since_collect = 0;
+        reclaimer.collect(rec);
+    }
+}
+
+inline
+epoch_reclaimer::registration::registration(epoch_reclaimer &reclaimer_)
+:   reclaimer(reclaimer_),
+    rec(reclaimer_.held_record())
+{
+    assert_that(rec == 0); // no guards, nor another registration
+    rec = reclaimer.claim();
+    cache().registered = true;
+}
+
+inline
+epoch_reclaimer::registration::~registration()
+{
+    assert_that(rec->pins == 0);
+    reclaimer.collect(rec);
+    reclaimer.release(rec);
+}
+
+} // namespace goodliffe
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
@@ -24,7 +24,7 @@ template <typename Key,
           typename MappedTo,
           typename KeyCompare      = std::less<Key>,
           typename Allocator       = std::allocator<std::pair<const Key, MappedTo> >,
-          typename LevelGenerator  = detail::skip_list_level_generator<32> >
+          typename LevelGenerator  = detail::xorshift_skip_list_level_generator<32> >
 class skip_list_map
 {
 public:
@@ -57,6 +57,11 @@ public:
     typedef std::reverse_iterator<iterator>               reverse_iterator;
     typedef std::reverse_iterator<const_iterator>         const_reverse_iterator;
 
+#if SKIP_LIST_CPP11
+    typedef detail::sl_map_node_handle<Key,MappedTo,Allocator,impl_type::num_levels> node_handle;
+    typedef detail::sl_insert_return_type<iterator,node_handle>                     insert_return_type;
+#endif
+
     //======================================================================
     // lifetime management
 
@@ -68,10 +73,11 @@ public:
     skip_list_map(const skip_list_map &other);
     skip_list_map(const skip_list_map &other, const Allocator &alloc);
 
-    // C++11
-    //skip_list_map(const skip_list_map &&other);
-    //skip_list_map(const skip_list_map &&other, const Allocator &alloc);
-    //skip_list_map(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+#if SKIP_LIST_CPP11
+    skip_list_map(skip_list_map &&other);
+    skip_list_map(skip_list_map &&other, const Allocator &alloc);
+    skip_list_map(std::initializer_list<value_type> init, const Allocator &alloc = Allocator());
+#endif
 
     allocator_type get_allocator() const { return impl.get_allocator(); }
 
@@ -79,11 +85,19 @@ public:
     // assignment
 
     skip_list_map &operator=(const skip_list_map &other);
-    //C++11 skip_list_map& operator=(skip_list_map&& other);
+#if SKIP_LIST_CPP11
+    skip_list_map &operator=(skip_list_map &&other);
+#endif
 
     template <typename InputIterator>
     void assign(InputIterator first, InputIterator last);
 
+    /// Replace the contents with [first,last), which must already be
+    /// sorted. The list is built in one pass, in linear time.
+    /// Of a run of equivalent keys, only the first is kept.
+    template <typename InputIterator>
+    void assign_sorted(InputIterator first, InputIterator last);
+
     //======================================================================
     // element access
 
@@ -128,19 +142,57 @@ public:
     insert_by_value_result insert(const value_type &value);
     iterator insert(const_iterator hint, const value_type &value);
 
-    //C++11iterator insert(value_type &&value);
-    //C++11iterator insert(const_iterator hint, const value_type &&value);
+#if SKIP_LIST_CPP11
+    insert_by_value_result insert(value_type &&value);
+    iterator insert(const_iterator hint, value_type &&value);
+#endif
 
     template <class InputIterator>
     void insert(InputIterator first, InputIterator last);
 
-    //C++11iterator insert(std::initializer_list<value_type> ilist);
-    //C++11emplace
+#if SKIP_LIST_CPP11
+    void insert(std::initializer_list<value_type> ilist);
+
+    /// Construct a value in place from args, and insert it. The value is
+    /// discarded if an equivalent one is already present.
+    template <typename... Args>
+    insert_by_value_result emplace(Args&&... args);
+    template <typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args);
+#endif
 
     size_type erase(const key_type &key);
     iterator  erase(const_iterator position);
     iterator  erase(const_iterator first, const_iterator last);
 
+#if SKIP_LIST_CPP11
+    /// Take an element out of the map, handing over its node rather than
+    /// freeing it. The key can be changed through the handle, and the node
+    /// put back with insert, into this map or another, without allocating
+    /// or copying anything.
+    node_handle extract(const_iterator position);
+    node_handle extract(const key_type &key);
+
+    /// Insert the node that handle holds. If the key is already present,
+    /// the node comes back in the result's handle.
+    insert_return_type insert(node_handle &&handle);
+    iterator           insert(const_iterator hint, node_handle &&handle);
+#endif
+
+    /// Insert each key/value pair in [first, last), returning how many were added.
+    /// When they are sorted, each goes in from where the one before it
+    /// did, rather than from the front, so m of them cost O(m log(n/m))
+    /// rather than O(m log n); a batch as big as the list is just a linear
+    /// merge. Any order gives the right result, only more slowly.
+    template <typename InputIterator>
+    size_type insert_sorted_batch(InputIterator first, InputIterator last);
+
+    /// Erase the element with each key in [first, last), returning how
+    /// many went. Sorted keys are searched for from one another, as for
+    /// insert_sorted_batch.
+    template <typename InputIterator>
+    size_type erase_sorted_batch(InputIterator first, InputIterator last);
+
     void swap(skip_list_map &other) { impl.swap(other.impl); }
 
     friend void swap(skip_list_map &lhs, skip_list_map &rhs) { lhs.swap(rhs); }
@@ -154,18 +206,110 @@ public:
     iterator       find(const key_type &key);
     const_iterator find(const key_type &key) const;
 
+    /// Find each key in [first, last), writing the iterator find would
+    /// give for it to out. Returns out once past the last one written.
+    ///
+    /// The searches are interleaved, so that their cache misses overlap.
+    /// For a list much larger than the cache, that is quicker than calling
+    /// find for each key in turn.
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out);
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const;
+
     iterator       lower_bound(const key_type &key);
     const_iterator lower_bound(const key_type &key) const;
 
     iterator       upper_bound(const key_type &key);
     const_iterator upper_bound(const key_type &key) const;
 
+#if SKIP_LIST_CPP11
+    /// With a transparent KeyCompare (one with an is_transparent member
+    /// type, like std::less<>), lookups and erase also take anything it can
+    /// order against the keys, so no key_type is built just to search with.
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    bool           contains(const K &key) const { return count(key) != 0; }
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    size_type      count(const K &key) const { return find(key) != end() ? 1 : 0; }
+
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    iterator       find(const K &key) { return to_iterator(impl.find(key), key); }
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    const_iterator find(const K &key) const { return to_iterator(static_cast<const node_type*>(impl.find(key)), key); }
+
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    iterator       lower_bound(const K &key) { return iterator(&impl, impl.lower_bound(key)); }
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &key) const { return const_iterator(&impl, impl.lower_bound(key)); }
+
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    iterator       upper_bound(const K &key) { return iterator(&impl, impl.upper_bound(key)); }
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &key) const { return const_iterator(&impl, impl.upper_bound(key)); }
+
+    /// Iterators still go to erase(const_iterator).
+    template <typename K, typename C = KeyCompare, typename = typename C::is_transparent,
+              typename = typename std::enable_if<!std::is_convertible<const K&, const_iterator>::value>::type>
+    size_type      erase(const K &key) { return impl.erase(key); }
+#endif
+
+    //======================================================================
+    // fingers
+
+    /// A finger remembers where in the list an operation through it ended.
+    /// Starting the next search from there costs O(log d) for an element d
+    /// positions away, rather than O(log n), which pays off when successive
+    /// operations are close together (e.g. nearly sorted input).
+    ///
+    /// A default-constructed finger starts from the front. A finger is
+    /// unaffected by inserts, and quietly starts again from the front after
+    /// any element has been erased from the list.
+    typedef typename impl_type::finger finger;
+
+    iterator       find(const key_type &key, finger &f);
+    const_iterator find(const key_type &key, finger &f) const;
+
+    iterator       lower_bound(const key_type &key, finger &f);
+    const_iterator lower_bound(const key_type &key, finger &f) const;
+
+    insert_by_value_result insert(finger &f, const value_type &value);
+
+    /// Find each key in [first, last) in turn, through one finger, and write
+    /// an iterator for each to out, as find (or lower_bound) would give.
+    /// Returns out once past the last one written.
+    ///
+    /// When the keys are sorted, each search starts from where the one
+    /// before it ended, so m of them cost O(m log(n/m)) rather than
+    /// O(m log n). Any order gives the right answers, just more slowly.
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out);
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const;
+
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out);
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const;
+
     //======================================================================
     // other operations
 
+    /// Move the elements of other into this map. Their nodes are relinked
+    /// rather than copied, so nothing is allocated. Elements whose key is
+    /// already here stay in other. The maps' allocators must compare equal.
+    /// Iterators to the elements that moved are no longer valid.
+    void merge(skip_list_map &other);
+
+    /// Move the elements of [first, last), a range of other, into this
+    /// map, as merge does.
+    void splice(skip_list_map &other, const_iterator first, const_iterator last);
+    void splice(skip_list_map &other, const_iterator position);
+
+    /// Take the elements of [first, last) out of this map, and return them
+    /// in a map of their own, without copying them.
+    skip_list_map extract(const_iterator first, const_iterator last);
+
     // std::list has:
-    //   * merge
-    //   * splice
     //   * remove
     //   * remove_if
     //   * reverse
@@ -178,13 +322,15 @@ public:
 protected:
     impl_type impl;
 
-    iterator to_iterator(node_type *node, const key_type &key)
+    template <typename KeyLike>
+    iterator to_iterator(node_type *node, const KeyLike &key)
     {
         return impl.is_valid(node) && detail::equivalent(node->value.first, key, impl.less)
             ? iterator(&impl, node)
             : end();
     }
-    const_iterator to_iterator(const node_type *node, const key_type &key) const
+    template <typename KeyLike>
+    const_iterator to_iterator(const node_type *node, const KeyLike &key) const
     {
         return impl.is_valid(node) && detail::equivalent(node->value.first, key, impl.less)
             ? const_iterator(&impl, node)
@@ -278,8 +424,8 @@ template <class K, class T, class C, class A, class LG>
 inline
 skip_list_map<K,T,C,A,LG>::skip_list_map(const skip_list_map &other)
 :   impl(other.get_allocator())
-{    
-    assign(other.begin(), other.end());
+{
+    impl.assign_sorted(other.begin(), other.end());
 }
 
 template <class K, class T, class C, class A, class LG>
@@ -287,13 +433,40 @@ inline
 skip_list_map<K,T,C,A,LG>::skip_list_map(const skip_list_map &other, const allocator_type &alloc_)
 :   impl(alloc_)
 {
-    assign(other.begin(), other.end());
+    impl.assign_sorted(other.begin(), other.end());
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+skip_list_map<K,T,C,A,LG>::skip_list_map(skip_list_map &&other)
+:   impl(other.get_allocator())
+{
+    impl.swap(other.impl);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+skip_list_map<K,T,C,A,LG>::skip_list_map(skip_list_map &&other, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    // Nodes can only change hands if the allocators can free each other's
+    if (alloc_ == other.get_allocator())
+        impl.swap(other.impl);
+    else
+        impl.assign_sorted(other.begin(), other.end());
 }
 
-// C++11
-//skip_list_map(const skip_list_map &&other);
-//skip_list_map(const skip_list_map &&other, const Allocator &alloc);
-//skip_list_map(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+template <class K, class T, class C, class A, class LG>
+inline
+skip_list_map<K,T,C,A,LG>::skip_list_map(std::initializer_list<value_type> init, const allocator_type &alloc_)
+:   impl(alloc_)
+{
+    assign(init.begin(), init.end());
+}
+
+#endif
 
 //==============================================================================
 #pragma mark assignment
@@ -303,11 +476,26 @@ inline
 skip_list_map<K,T,C,A,LG> &
 skip_list_map<K,T,C,A,LG>::operator=(const skip_list_map<K,T,C,A,LG> &other)
 {
-    assign(other.begin(), other.end());
+    if (this != &other) impl.assign_sorted(other.begin(), other.end());
+    return *this;
+}
+
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+skip_list_map<K,T,C,A,LG> &
+skip_list_map<K,T,C,A,LG>::operator=(skip_list_map<K,T,C,A,LG> &&other)
+{
+    if (this != &other)
+    {
+        impl.swap(other.impl);
+        other.clear();
+    }
     return *this;
 }
 
-//C++11 skip_list_map& operator=(skip_list_map&& other);
+#endif
 
 template <class K, class T, class C, class A, class LG>
 template <typename InputIterator>
@@ -318,6 +506,14 @@ void skip_list_map<K,T,C,A,LG>::assign(InputIterator first, InputIterator last)
     while (first != last) insert(*first++);
 }
 
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+void skip_list_map<K,T,C,A,LG>::assign_sorted(InputIterator first, InputIterator last)
+{
+    impl.assign_sorted(first, last);
+}
+
 //==============================================================================
 #pragma mark element access
 
@@ -372,8 +568,9 @@ inline
 typename skip_list_map<K,T,C,A,LG>::insert_by_value_result
 skip_list_map<K,T,C,A,LG>::insert(const value_type &value)
 {
-    node_type *node = impl.insert(value);
-    return std::make_pair(iterator(&impl, node), impl.is_valid(node));
+    bool inserted;
+    node_type *node = impl.insert(value, 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
 }
 
 template <class K, class T, class C, class A, class LG>
@@ -385,7 +582,28 @@ skip_list_map<K,T,C,A,LG>::insert(const_iterator hint, const value_type &value)
     return iterator(&impl,impl.insert(value,const_cast<node_type*>(hint.get_node())));
 }
 
-//C++11iterator insert const_iterator pos, value_type &&value);
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::insert_by_value_result
+skip_list_map<K,T,C,A,LG>::insert(value_type &&value)
+{
+    bool inserted;
+    node_type *node = impl.insert(std::move(value), 0, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::iterator
+skip_list_map<K,T,C,A,LG>::insert(const_iterator hint, value_type &&value)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.insert(std::move(value), const_cast<node_type*>(hint.get_node())));
+}
+
+#endif
 
 template <class K, class T, class C, class A, class LG>
 template <class InputIterator>
@@ -393,15 +611,44 @@ inline
 void
 skip_list_map<K,T,C,A,LG>::insert(InputIterator first, InputIterator last)
 {
-    iterator last_inserted = end();
-    while (first != last)
-    {
-        last_inserted = insert(last_inserted, *first++);
-    }
+    // Through one finger, as insert_sorted_batch: each value is searched
+    // for from where the one before went, which costs O(1) for sorted
+    // input, and is never much worse than a search from the top.
+    impl.insert_sorted(first, last);
 }
 
-//C++11iterator insert(std::initializer_list<value_type> ilist);
-// C++11 emplace
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+void
+skip_list_map<K,T,C,A,LG>::insert(std::initializer_list<value_type> ilist)
+{
+    insert(ilist.begin(), ilist.end());
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename... Args>
+inline
+typename skip_list_map<K,T,C,A,LG>::insert_by_value_result
+skip_list_map<K,T,C,A,LG>::emplace(Args&&... args)
+{
+    bool inserted;
+    node_type *node = impl.emplace(0, &inserted, std::forward<Args>(args)...);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename... Args>
+inline
+typename skip_list_map<K,T,C,A,LG>::iterator
+skip_list_map<K,T,C,A,LG>::emplace_hint(const_iterator hint, Args&&... args)
+{
+    assert_that(hint.get_impl() == &impl);
+    return iterator(&impl, impl.emplace(const_cast<node_type*>(hint.get_node()), 0, std::forward<Args>(args)...));
+}
+
+#endif
 
 template <class K, class T, class C, class A, class LG>
 inline
@@ -442,6 +689,83 @@ skip_list_map<K,T,C,A,LG>::erase(const_iterator first, const_iterator last)
     return iterator(&impl, const_cast<node_type*>(last.get_node()));
 }
   
+#if SKIP_LIST_CPP11
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::node_handle
+skip_list_map<K,T,C,A,LG>::extract(const_iterator position)
+{
+    assert_that(position.get_impl() == &impl);
+    assert_that(impl.is_valid(position.get_node()));
+    node_type *node = const_cast<node_type*>(position.get_node());
+    return node_handle(impl.extract(node), get_allocator());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::node_handle
+skip_list_map<K,T,C,A,LG>::extract(const key_type &key)
+{
+    node_type *node = impl.find(key);
+    if (!impl.is_valid(node) || !detail::equivalent(node->value.first, key, impl.less))
+        return node_handle();
+    return node_handle(impl.extract(node), get_allocator());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::insert_return_type
+skip_list_map<K,T,C,A,LG>::insert(node_handle &&handle)
+{
+    insert_return_type result;
+    result.position = end();
+    result.inserted = false;
+    if (handle.empty()) return result;
+
+    assert_that(handle.get_allocator() == get_allocator());
+    node_type *node = impl.insert_node(handle.get_node(), 0, &result.inserted);
+    result.position = iterator(&impl, node);
+    if (result.inserted) handle.release();
+    else                 result.node = std::move(handle);
+    return result;
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::iterator
+skip_list_map<K,T,C,A,LG>::insert(const_iterator hint, node_handle &&handle)
+{
+    assert_that(hint.get_impl() == &impl);
+    if (handle.empty()) return end();
+
+    assert_that(handle.get_allocator() == get_allocator());
+    bool inserted;
+    node_type *node = impl.insert_node(handle.get_node(), const_cast<node_type*>(hint.get_node()), &inserted);
+    if (inserted) handle.release();
+    return iterator(&impl, node);
+}
+
+#endif
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+typename skip_list_map<K,T,C,A,LG>::size_type
+skip_list_map<K,T,C,A,LG>::insert_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.insert_sorted(first, last);
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator>
+inline
+typename skip_list_map<K,T,C,A,LG>::size_type
+skip_list_map<K,T,C,A,LG>::erase_sorted_batch(InputIterator first, InputIterator last)
+{
+    return impl.erase_sorted(first, last);
+}
+
 //==============================================================================
 #pragma mark lookup
 
@@ -472,6 +796,40 @@ skip_list_map<K,T,C,A,LG>::find(const key_type &key) const
     return to_iterator(node, key);
 }
 
+template <class K, class T, class C, class A, class LG>
+template <typename ForwardIterator, typename OutputIterator>
+inline
+OutputIterator skip_list_map<K,T,C,A,LG>::find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out)
+{
+    const key_type *keys[impl_type::batch_width];
+    node_type      *nodes[impl_type::batch_width];
+    while (first != last)
+    {
+        unsigned count = 0;
+        for (; count < impl_type::batch_width && first != last; ++first) keys[count++] = &*first;
+        impl.find_batch(keys, nodes, count);
+        for (unsigned n = 0; n < count; ++n) *out++ = to_iterator(nodes[n], *keys[n]);
+    }
+    return out;
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename ForwardIterator, typename OutputIterator>
+inline
+OutputIterator skip_list_map<K,T,C,A,LG>::find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+{
+    const key_type *keys[impl_type::batch_width];
+    node_type      *nodes[impl_type::batch_width];
+    while (first != last)
+    {
+        unsigned count = 0;
+        for (; count < impl_type::batch_width && first != last; ++first) keys[count++] = &*first;
+        impl.find_batch(keys, nodes, count);
+        for (unsigned n = 0; n < count; ++n) *out++ = to_iterator(static_cast<const node_type*>(nodes[n]), *keys[n]);
+    }
+    return out;
+}
+
 template <class K, class T, class C, class A, class LG>
 inline
 typename skip_list_map<K,T,C,A,LG>::iterator
@@ -504,5 +862,133 @@ skip_list_map<K,T,C,A,LG>::upper_bound(const key_type &key) const
     return const_iterator(&impl, impl.upper_bound(key));
 }
 
+//==============================================================================
+#pragma mark fingers
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::iterator
+skip_list_map<K,T,C,A,LG>::find(const key_type &key, finger &f)
+{
+    return to_iterator(impl.lower_bound(key, f), key);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::const_iterator
+skip_list_map<K,T,C,A,LG>::find(const key_type &key, finger &f) const
+{
+    const node_type *node = impl.lower_bound(key, f);
+    return to_iterator(node, key);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::iterator
+skip_list_map<K,T,C,A,LG>::lower_bound(const key_type &key, finger &f)
+{
+    return iterator(&impl, impl.lower_bound(key, f));
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::const_iterator
+skip_list_map<K,T,C,A,LG>::lower_bound(const key_type &key, finger &f) const
+{
+    return const_iterator(&impl, impl.lower_bound(key, f));
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+typename skip_list_map<K,T,C,A,LG>::insert_by_value_result
+skip_list_map<K,T,C,A,LG>::insert(finger &f, const value_type &value)
+{
+    bool inserted;
+    node_type *node = impl.insert(value, f, &inserted);
+    return std::make_pair(iterator(&impl, node), inserted);
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list_map<K,T,C,A,LG>::find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out)
+{
+    finger f;
+    for (; first != last; ++first) *out++ = find(*first, f);
+    return out;
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list_map<K,T,C,A,LG>::find_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const
+{
+    finger f;
+    for (; first != last; ++first) *out++ = find(*first, f);
+    return out;
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list_map<K,T,C,A,LG>::lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out)
+{
+    finger f;
+    for (; first != last; ++first) *out++ = lower_bound(*first, f);
+    return out;
+}
+
+template <class K, class T, class C, class A, class LG>
+template <typename InputIterator, typename OutputIterator>
+inline
+OutputIterator skip_list_map<K,T,C,A,LG>::lower_bound_sorted_batch(InputIterator first, InputIterator last, OutputIterator out) const
+{
+    finger f;
+    for (; first != last; ++first) *out++ = lower_bound(*first, f);
+    return out;
+}
+
+
+//==============================================================================
+#pragma mark other operations
+
+template <class K, class T, class C, class A, class LG>
+inline
+void skip_list_map<K,T,C,A,LG>::merge(skip_list_map &other)
+{
+    impl.transfer(other.impl, other.impl.front(), other.impl.one_past_end());
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+void skip_list_map<K,T,C,A,LG>::splice(skip_list_map &other, const_iterator first, const_iterator last)
+{
+    assert_that(first.get_impl() == &other.impl);
+    assert_that(last.get_impl() == &other.impl);
+    impl.transfer(other.impl,
+                  const_cast<node_type*>(first.get_node()),
+                  const_cast<node_type*>(last.get_node()));
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+void skip_list_map<K,T,C,A,LG>::splice(skip_list_map &other, const_iterator position)
+{
+    assert_that(position.get_impl() == &other.impl);
+    assert_that(other.impl.is_valid(position.get_node()));
+    node_type *node = const_cast<node_type*>(position.get_node());
+    impl.transfer(other.impl, node, node->next[0]);
+}
+
+template <class K, class T, class C, class A, class LG>
+inline
+skip_list_map<K,T,C,A,LG>
+skip_list_map<K,T,C,A,LG>::extract(const_iterator first, const_iterator last)
+{
+    skip_list_map extracted(get_allocator());
+    extracted.splice(*this, first, last);
+    return extracted;
+}
+
 }
 
@@ -0,0 +1,339 @@
+//==============================================================================
+// skip_list_pool_allocator.h
+//==============================================================================
+
+#pragma once
+
+#include "skip_list_detail.h"
+
+#include <cstddef>    // for std::size_t
+#include <new>        // for operator new, placement new
+#include <limits>     // for std::numeric_limits
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning (disable : 4068 ) /* disable unknown pragma warnings */
+#endif
+
+//==============================================================================
+#pragma mark - sl_node_pool
+//==============================================================================
+
+namespace goodliffe {
+namespace detail {
+
+template <typename T>
+struct alignment_of_helper { char c; T t; };
+
+/// The alignment of T, the C++03 way.
+template <typename T>
+struct alignment_of
+{
+    static const std::size_t value = sizeof(alignment_of_helper<T>) - sizeof(T);
+};
+
+/// The memory pool shared by all copies (and rebinds) of a
+/// skip_list_pool_allocator.
+///
+/// Blocks are handed out from slabs, and returned blocks are kept on a free
+/// list for their size. A skip list node's size grows by a fixed amount for
+/// each level of its tower, so in practice each free list holds the nodes of
+/// exactly one tower height.
+///
+/// Requests larger than the biggest bucket go directly to operator new.
+///
+/// Like the containers themselves, a pool is not thread safe.
+///
+/// @internal
+class sl_node_pool
+{
+public:
+    explicit sl_node_pool(std::size_t alignment);
+    ~sl_node_pool();
+
+    void *allocate(std::size_t bytes);
+    void  deallocate(void *block, std::size_t bytes);
+
+    /// Return the slabs of every bucket that has no blocks in use.
+    void  release_unused();
+
+    std::size_t blocks_in_use() const;
+    std::size_t slabs_allocated() const;
+
+    void add_ref()     { ++references; }
+    bool remove_ref()  { return --references == 0; }
+
+private:
+    sl_node_pool(const sl_node_pool &);
+    sl_node_pool &operator=(const sl_node_pool &);
+
+    struct free_block { free_block *next; };
+    struct slab       { slab *next; };
+
+    struct bucket
+    {
+        free_block  *free;
+        slab        *slabs;
+        std::size_t  in_use;
+    };
+
+    enum
+    {
+        num_buckets = 64,
+        slab_bytes  = 4096,
+        min_blocks  = 8
+    };
+
+    std::size_t granule;
+    std::size_t header_bytes;
+    unsigned    references;
+    bucket      buckets[num_buckets];
+
+    std::size_t block_bytes(std::size_t bytes) const
+        { return bytes ? (bytes+granule-1)/granule*granule : granule; }
+    void refill(bucket &b, std::size_t block_size);
+    void release(bucket &b);
+};
+
+inline
+sl_node_pool::sl_node_pool(std::size_t alignment)
+:   granule(alignment > sizeof(void*) ? alignment : sizeof(void*)),
+    header_bytes((sizeof(slab)+granule-1)/granule*granule),
+    references(1)
+{
+    for (unsigned n = 0; n < num_buckets; ++n)
+    {
+        buckets[n].free   = 0;
+        buckets[n].slabs  = 0;
+        buckets[n].in_use = 0;
+    }
+}
+
+inline
+sl_node_pool::~sl_node_pool()
+{
+    for (unsigned n = 0; n < num_buckets; ++n)
+    {
+        assert_that(buckets[n].in_use == 0);
+        release(buckets[n]);
+    }
+}
+
+inline
+void *sl_node_pool::allocate(std::size_t bytes)
+{
+    const std::size_t size  = block_bytes(bytes);
+    const std::size_t index = size/granule - 1;
+    if (index >= num_buckets) return ::operator new(bytes);
+
+    bucket &b = buckets[index];
+    if (!b.free) refill(b, size);
+
+    free_block *block = b.free;
+    b.free = block->next;
+    ++b.in_use;
+    return block;
+}
+
+inline
+void sl_node_pool::deallocate(void *block, std::size_t bytes)
+{
+    const std::size_t index = block_bytes(bytes)/granule - 1;
+    if (index >= num_buckets) { ::operator delete(block); return; }
+
+    bucket &b = buckets[index];
+    assert_that(b.in_use);
+    free_block *freed = static_cast<free_block*>(block);
+    freed->next = b.free;
+    b.free = freed;
+    --b.in_use;
+}
+
+inline
+void sl_node_pool::release_unused()
+{
+    for (unsigned n = 0; n < num_buckets; ++n)
+    {
+        if (!buckets[n].in_use) release(buckets[n]);
+    }
+}
+
+inline
+std::size_t sl_node_pool::blocks_in_use() const
+{
+    std::size_t count = 0;
+    for (unsigned n = 0; n < num_buckets; ++n) count += buckets[n].in_use;
+    return count;
+}
+
+inline
+std::size_t sl_node_pool::slabs_allocated() const
+{
+    std::size_t count = 0;
+    for (unsigned n = 0; n < num_buckets; ++n)
+        for (const slab *s = buckets[n].slabs; s; s = s->next) ++count;
+    return count;
+}
+
+inline
+void sl_node_pool::refill(bucket &b, std::size_t size)
+{
+    std::size_t blocks = slab_bytes/size;
+    if (blocks < min_blocks) blocks = min_blocks;
+
+    char *memory = static_cast<char*>(::operator new(header_bytes + blocks*size));
+    slab *new_slab = reinterpret_cast<slab*>(memory);
+    new_slab->next = b.slabs;
+    b.slabs = new_slab;
+
+    // Thread the blocks onto the free list in address order, so that
+    // consecutive allocations are adjacent in memory.
+    char *block = memory + header_bytes + blocks*size;
+    for (std::size_t n = 0; n < blocks; ++n)
+    {
+        block -= size;
+        free_block *fb = reinterpret_cast<free_block*>(block);
+        fb->next = b.free;
+        b.free = fb;
+    }
+}
+
+inline
+void sl_node_pool::release(bucket &b)
+{
+    while (b.slabs)
+    {
+        slab *next = b.slabs->next;
+        ::operator delete(b.slabs);
+        b.slabs = next;
+    }
+    b.free = 0;
+}
+
+} // namespace detail
+} // namespace goodliffe
+
+//==============================================================================
+#pragma mark - skip_list_pool_allocator
+//==============================================================================
+
+namespace goodliffe {
+
+/// An allocator that pools skip list nodes.
+///
+/// Use it as the Allocator parameter of any of the skip list containers to
+/// avoid a trip to the global allocator for each insert and erase:
+///
+///     skip_list<int, std::less<int>, skip_list_pool_allocator<int> > list;
+///
+/// Each default-constructed allocator owns a new pool. Copies and rebinds of
+/// an allocator share its pool, so a container's nodes all come from the
+/// pool of the allocator it was constructed with.
+///
+/// Erased nodes are recycled through a free list per node size (i.e. per
+/// tower height). When a container is cleared, the slabs backing every
+/// emptied free list are returned in bulk. The remaining memory is returned
+/// when the last allocator sharing the pool is destroyed.
+///
+/// Like the containers themselves, this allocator is not thread safe.
+/// Containers sharing one pool must not be used concurrently.
+template <typename T>
+class skip_list_pool_allocator
+{
+public:
+    typedef T                 value_type;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+    typedef T&                reference;
+    typedef const T&          const_reference;
+    typedef T*                pointer;
+    typedef const T*          const_pointer;
+
+    template <typename U>
+    struct rebind { typedef skip_list_pool_allocator<U> other; };
+
+    skip_list_pool_allocator()
+        : pool(new detail::sl_node_pool(detail::alignment_of<T>::value)) {}
+    skip_list_pool_allocator(const skip_list_pool_allocator &other)
+        : pool(other.pool) { pool->add_ref(); }
+    template <typename U>
+    skip_list_pool_allocator(const skip_list_pool_allocator<U> &other)
+        : pool(other.get_pool()) { pool->add_ref(); }
+    ~skip_list_pool_allocator()
+        { if (pool->remove_ref()) delete pool; }
+
+    skip_list_pool_allocator &operator=(const skip_list_pool_allocator &other)
+    {
+        other.pool->add_ref();
+        if (pool->remove_ref()) delete pool;
+        pool = other.pool;
+        return *this;
+    }
+
+    pointer allocate(size_type n, const void * = 0)
+        { return static_cast<pointer>(pool->allocate(n*sizeof(T))); }
+    void deallocate(pointer p, size_type n)
+        { pool->deallocate(p, n*sizeof(T)); }
+
+#if SKIP_LIST_CPP11
+    template <class U, class... Args>
+    void construct(U *p, Args&&... args)
+        { ::new ((void*)p) U(std::forward<Args>(args)...); }
+    template <class U>
+    void destroy(U *p)
+        { p->~U(); }
+#else
+    void construct(pointer p, const_reference value)
+        { new ((void*)p) T(value); }
+    void destroy(pointer p)
+        { p->~T(); }
+#endif
+
+    pointer       address(reference x) const       { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+    size_type     max_size() const
+        { return std::numeric_limits<size_type>::max()/sizeof(T); }
+
+    /// Return the memory of every node size with no nodes in use.
+    void release_unused() { pool->release_unused(); }
+
+    detail::sl_node_pool *get_pool() const { return pool; } ///< @internal
+
+private:
+    detail::sl_node_pool *pool;
+};
+
+template <typename T1, typename T2>
+inline
+bool operator==(const skip_list_pool_allocator<T1> &lhs, const skip_list_pool_allocator<T2> &rhs)
+{
+    return lhs.get_pool() == rhs.get_pool();
+}
+
+template <typename T1, typename T2>
+inline
+bool operator!=(const skip_list_pool_allocator<T1> &lhs, const skip_list_pool_allocator<T2> &rhs)
+{
+    return !operator==(lhs, rhs);
+}
+
+namespace detail {
+
+template <typename T>
+struct node_pool_traits<skip_list_pool_allocator<T> >
+{
+    static void release_unused(skip_list_pool_allocator<T> &alloc)
+        { alloc.release_unused(); }
+};
+
+} // namespace detail
+
+} // namespace goodliffe
+
+//==============================================================================
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
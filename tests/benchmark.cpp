@@ -4,10 +4,18 @@
 //============================================================================
 
 #include "skip_list.h"
+#include "skip_list_map.h"
 #include "random_access_skip_list.h"
+#include "skip_list_pool_allocator.h"
+#if SKIP_LIST_CPP11
+#include "concurrent_skip_list.h"
+#include "sharded_skip_list_map.h"
+#include <mutex>
+#include <numeric>
+#include <thread>
+#endif
 
 #include "get_time.h"
-#include "test_types.h"
 
 #include <set>
 #include <list>
@@ -28,6 +36,7 @@
 
 #define CATCH_CONFIG_NO_STREAM_REDIRECTION
 #include "catch.hpp"
+#include "test_types.h"
 
 using goodliffe::skip_list;
 using goodliffe::random_access_skip_list;
@@ -80,6 +89,17 @@ struct Benchmark
         : name(name_), vector(-1), set(-1), list(-1), multi(-1), skip_list(-1), ra_skip_list(-1) {}
 };
 
+/// A head-to-head timing of two variants of the same container.
+struct Comparison
+{
+    std::string name;
+    long        baseline;
+    long        candidate;
+
+    Comparison(const std::string &name_, long baseline_, long candidate_)
+        : name(name_), baseline(baseline_), candidate(candidate_) {}
+};
+
 long TimeExecutionOf(const boost::function<void()> &f);
 void FillWithRandomData(size_t size, std::vector<int> &data);
 void FillWithOrderedData(size_t size, std::vector<int> &data);
@@ -199,6 +219,12 @@ void InsertByValueAtRightPlace(const std::vector<int> *data, CONTAINER *containe
         }
     }
 }
+template <typename CONTAINER>
+void InsertByValueWithHint(const std::vector<int> *data, CONTAINER *container)
+{
+    for (std::vector<int>::const_iterator i = data->begin(); i != data->end(); ++i)
+        container->insert(container->end(), *i);
+}
 void InsertIntoMultiIndex(const std::vector<int> *data, multi_index *container);
 void InsertIntoMultiIndex(const std::vector<int> *data, multi_index *container)
 {
@@ -349,6 +375,35 @@ Benchmark InsertReverseOrderedData(unsigned size)
     FillWithReverseOrderedData(size, data);
     return InsertData(data, "reverse");
 }
+Benchmark InsertOrderedDataWithHint(unsigned size);
+Benchmark InsertOrderedDataWithHint(unsigned size)
+{
+    std::vector<int> data;
+    FillWithOrderedData(size, data);
+
+    std::set<int>                std_set;
+    std::list<int>               std_list;
+    std::vector<int>             std_vector;
+    multi_index                  multi;
+    skip_list<int>               skip_list;
+    random_access_skip_list<int> ra_skip_list;
+
+    Benchmark benchmark("insert ordered data with hint");
+
+    benchmark.set           = TimeExecutionOf(boost::bind(&InsertByValueWithHint<std::set<int> >, &data, &std_set));
+    benchmark.list          = TimeExecutionOf(boost::bind(&PushBack<std::list<int> >, &data, &std_list));
+    benchmark.vector        = TimeExecutionOf(boost::bind(&PushBack<std::vector<int> >, &data, &std_vector));
+    benchmark.multi         = TimeExecutionOf(boost::bind(&InsertIntoMultiIndex, &data, &multi));
+    benchmark.skip_list     = TimeExecutionOf(boost::bind(&InsertByValueWithHint<goodliffe::skip_list<int> >, &data, &skip_list));
+    benchmark.ra_skip_list  = TimeExecutionOf(boost::bind(&InsertByValueWithHint<goodliffe::random_access_skip_list<int> >, &data, &ra_skip_list));
+
+    REQUIRE(std_set.size()      == data.size());
+    REQUIRE(skip_list.size()    == data.size());
+    REQUIRE(ra_skip_list.size() == data.size());
+
+    return benchmark;
+}
+
 Benchmark IterateForwards(unsigned size);
 Benchmark IterateForwards(unsigned size)
 {
@@ -532,6 +587,461 @@ Benchmark Allocation(unsigned size)
     return benchmark;
 }
 
+//============================================================================
+#pragma mark Allocators
+
+template <typename CONTAINER>
+void InsertValue(CONTAINER &c, int value)
+    { c.insert(value); }
+template <typename K, typename V, typename C, typename A, typename LG>
+void InsertValue(goodliffe::skip_list_map<K,V,C,A,LG> &c, int value)
+    { c.insert(std::make_pair(value, value)); }
+
+template <typename CONTAINER>
+void InsertAndErase(const std::vector<int> *data, CONTAINER *container)
+{
+    for (unsigned repeat = 0; repeat < 10; ++repeat)
+    {
+        for (std::vector<int>::const_iterator i = data->begin(); i != data->end(); ++i)
+            InsertValue(*container, *i);
+        for (std::vector<int>::const_reverse_iterator i = data->rbegin(); i != data->rend(); ++i)
+            container->erase(*i);
+    }
+}
+
+template <typename STD_CONTAINER, typename POOL_CONTAINER>
+Comparison CompareAllocators(const std::string &name, std::vector<int> &data)
+{
+    STD_CONTAINER  with_std;
+    POOL_CONTAINER with_pool;
+    const long std_time  = TimeExecutionOf(boost::bind(&InsertAndErase<STD_CONTAINER>, &data, &with_std));
+    const long pool_time = TimeExecutionOf(boost::bind(&InsertAndErase<POOL_CONTAINER>, &data, &with_pool));
+    REQUIRE(with_std.empty());
+    REQUIRE(with_pool.empty());
+    return Comparison(name, std_time, pool_time);
+}
+
+void CompareAllocators(unsigned size, std::vector<Comparison> &comparisons);
+void CompareAllocators(unsigned size, std::vector<Comparison> &comparisons)
+{
+    using goodliffe::skip_list_pool_allocator;
+    using goodliffe::skip_list_map;
+    typedef std::pair<const int,int> map_value;
+
+    std::vector<int> data;
+    FillWithRandomData(size, data);
+
+    comparisons.push_back(CompareAllocators
+        <
+            skip_list<int>,
+            skip_list<int,std::less<int>,skip_list_pool_allocator<int> >
+        >("churn: skip_list", data));
+    comparisons.push_back(CompareAllocators
+        <
+            goodliffe::multi_skip_list<int>,
+            goodliffe::multi_skip_list<int,std::less<int>,skip_list_pool_allocator<int> >
+        >("churn: multi_skip_list", data));
+    comparisons.push_back(CompareAllocators
+        <
+            skip_list_map<int,int>,
+            skip_list_map<int,int,std::less<int>,skip_list_pool_allocator<map_value> >
+        >("churn: skip_list_map", data));
+    comparisons.push_back(CompareAllocators
+        <
+            random_access_skip_list<int>,
+            random_access_skip_list<int,std::less<int>,skip_list_pool_allocator<int> >
+        >("churn: random_access_skip_list", data));
+}
+
+//============================================================================
+#pragma mark Level generators
+
+template <typename GENERATOR>
+void GenerateLevels(unsigned count, GENERATOR *generator)
+{
+    unsigned total = 0;
+    for (unsigned n = 0; n < count; ++n) total += generator->new_level();
+    REQUIRE(total < count*32);
+}
+
+template <typename OLD_GENERATOR, typename NEW_GENERATOR>
+void CompareLevelGenerators(const std::string &name, std::vector<int> &data, std::vector<Comparison> &comparisons)
+{
+    {
+        OLD_GENERATOR old_generator;
+        NEW_GENERATOR new_generator;
+        const unsigned count = unsigned(data.size()*100);
+        const long old_time = TimeExecutionOf(boost::bind(&GenerateLevels<OLD_GENERATOR>, count, &old_generator));
+        const long new_time = TimeExecutionOf(boost::bind(&GenerateLevels<NEW_GENERATOR>, count, &new_generator));
+        comparisons.push_back(Comparison("new_level: " + name, old_time, new_time));
+    }
+    {
+        typedef skip_list<int,std::less<int>,std::allocator<int>,OLD_GENERATOR> old_list;
+        typedef skip_list<int,std::less<int>,std::allocator<int>,NEW_GENERATOR> new_list;
+        old_list with_old;
+        new_list with_new;
+        const long old_time = TimeExecutionOf(boost::bind(&InsertByValue<old_list>, &data, &with_old));
+        const long new_time = TimeExecutionOf(boost::bind(&InsertByValue<new_list>, &data, &with_new));
+        comparisons.push_back(Comparison("insert: " + name, old_time, new_time));
+    }
+}
+
+void CompareLevelGenerators(unsigned size, std::vector<Comparison> &comparisons);
+void CompareLevelGenerators(unsigned size, std::vector<Comparison> &comparisons)
+{
+    using namespace goodliffe::detail;
+
+    std::vector<int> data;
+    FillWithRandomData(size, data);
+
+    CompareLevelGenerators
+        <
+            skip_list_level_generator<32>,
+            xorshift_skip_list_level_generator<32>
+        >("rand loop", data, comparisons);
+    CompareLevelGenerators
+        <
+            bit_based_skip_list_level_generator<32>,
+            xorshift_skip_list_level_generator<32>
+        >("rand bits", data, comparisons);
+}
+
+//============================================================================
+#pragma mark Concurrent containers
+// a skip_list_map behind a mutex against the lock-free concurrent map
+
+#if SKIP_LIST_CPP11
+
+struct MutexGuardedMap
+{
+    std::mutex                         mutex;
+    goodliffe::skip_list_map<int, int> map;
+
+    bool find(int key)   { std::lock_guard<std::mutex> lock(mutex); return map.find(key) != map.end(); }
+    void insert(int key) { std::lock_guard<std::mutex> lock(mutex); map.insert(std::make_pair(key, key)); }
+    void erase(int key)  { std::lock_guard<std::mutex> lock(mutex); map.erase(key); }
+};
+
+struct LockFreeMap
+{
+    goodliffe::concurrent_skip_list_map<int, int> map;
+
+    bool find(int key)   { return map.contains(key); }
+    void insert(int key) { map.insert(std::make_pair(key, key)); }
+    void erase(int key)  { map.erase(key); }
+};
+
+/// 80% finds, 10% inserts and 10% erases, over keys [0,key_range).
+/// The finds are counted, so they cannot be optimised away.
+template <typename MAP>
+void MixedUse(MAP *map, unsigned seed, unsigned ops, unsigned key_range, unsigned *found_count)
+{
+    unsigned state = seed*2654435761u + 1;
+    unsigned found = 0;
+    for (unsigned n = 0; n < ops; ++n)
+    {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        const int key = int(state % key_range);
+        switch ((state >> 24) % 10)
+        {
+            case 0:  map->insert(key); break;
+            case 1:  map->erase(key);  break;
+            default: found += map->find(key) ? 1 : 0;
+        }
+    }
+    *found_count = found;
+}
+
+struct ShardedMap
+{
+    goodliffe::sharded_skip_list_map<int, int> map;
+
+    explicit ShardedMap(const std::vector<int> &boundaries) : map(boundaries) {}
+
+    bool find(int key)   { return map.contains(key); }
+    void insert(int key) { map.insert(std::make_pair(key, key)); }
+    void erase(int key)  { map.erase(key); }
+};
+
+/// The same total work, shared between threads.
+template <typename MAP>
+long TimeMixedUseOf(MAP &map, unsigned threads, unsigned size)
+{
+    for (unsigned key = 0; key < size*2; key += 2) map.insert(int(key));
+
+    const unsigned total_ops = 400000;
+    std::vector<unsigned> found(threads);
+    const long start = get_time_us();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.push_back(std::thread(&MixedUse<MAP>, &map, t+1, total_ops/threads, size*2, &found[t]));
+    }
+    for (unsigned t = 0; t < threads; ++t) workers[t].join();
+    const long time = get_time_us()-start;
+
+    REQUIRE(std::accumulate(found.begin(), found.end(), 0u) > 0);
+    return time;
+}
+
+template <typename MAP>
+long TimeMixedUse(unsigned threads, unsigned size)
+{
+    MAP map;
+    return TimeMixedUseOf(map, threads, size);
+}
+
+/// Shards of equal width over the keys MixedUse uses.
+long TimeShardedUse(unsigned threads, unsigned shards, unsigned size)
+{
+    std::vector<int> boundaries;
+    for (unsigned n = 1; n < shards; ++n) boundaries.push_back(int(size*2*n/shards));
+    ShardedMap map(boundaries);
+    return TimeMixedUseOf(map, threads, size);
+}
+
+void CompareConcurrentMaps(unsigned size, std::vector<Comparison> &comparisons);
+void CompareConcurrentMaps(unsigned size, std::vector<Comparison> &comparisons)
+{
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (!max_threads)     max_threads = 4;
+    if (max_threads > 32) max_threads = 32;
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        char name[64];
+        sprintf(name, "mixed use: %u threads", threads);
+        comparisons.push_back(Comparison(name,
+                                         TimeMixedUse<MutexGuardedMap>(threads, size),
+                                         TimeMixedUse<LockFreeMap>(threads, size)));
+    }
+}
+
+void CompareShardedMaps(unsigned size, std::vector<Comparison> &comparisons);
+void CompareShardedMaps(unsigned size, std::vector<Comparison> &comparisons)
+{
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (!max_threads)     max_threads = 4;
+    if (max_threads > 32) max_threads = 32;
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        const long baseline = TimeMixedUse<MutexGuardedMap>(threads, size);
+        for (unsigned shards = 1; shards <= 64; shards *= 4)
+        {
+            char name[64];
+            sprintf(name, "%u threads, %u shards", threads, shards);
+            comparisons.push_back(Comparison(name, baseline, TimeShardedUse(threads, shards, size)));
+        }
+    }
+}
+
+//============================================================================
+#pragma mark Epoch reclamation
+// what deferring frees through an epoch_reclaimer costs, per object
+
+namespace
+{
+    void DeleteInts(void *, void **objects, std::size_t count)
+    {
+        for (std::size_t n = 0; n < count; ++n) delete static_cast<int*>(objects[n]);
+    }
+
+    const unsigned reclaimed_objects = 200000;
+
+    /// Called through a volatile pointer, so the new and delete can't be
+    /// optimised away.
+    long TimeDeleteNow()
+    {
+        goodliffe::epoch_reclaimer::free_function volatile free = &DeleteInts;
+        const long start = get_time_us();
+        for (unsigned n = 0; n < reclaimed_objects; ++n)
+        {
+            void *objects[1] = { new int(int(n)) };
+            free(0, objects, 1);
+        }
+        return get_time_us()-start;
+    }
+
+    /// Includes destroying the reclaimer, which frees the stragglers.
+    long TimeRetire(bool registered, bool one_guard)
+    {
+        const long start = get_time_us();
+        {
+            goodliffe::epoch_reclaimer reclaimer;
+            goodliffe::epoch_reclaimer::registration *registration =
+                registered ? new goodliffe::epoch_reclaimer::registration(reclaimer) : 0;
+            goodliffe::epoch_reclaimer::guard *outer =
+                one_guard ? new goodliffe::epoch_reclaimer::guard(reclaimer) : 0;
+            for (unsigned n = 0; n < reclaimed_objects; ++n)
+            {
+                goodliffe::epoch_reclaimer::guard g(reclaimer);
+                g.retire(new int(int(n)), &DeleteInts, 0);
+            }
+            delete outer;
+            delete registration;
+        }
+        return get_time_us()-start;
+    }
+
+    /// Erase and reinsert every key until reclaimed_objects have been erased.
+    long TimeConcurrentErase(unsigned size, bool registered)
+    {
+        goodliffe::concurrent_skip_list<int> list;
+        for (unsigned key = 0; key < size; ++key) list.insert(int(key));
+
+        goodliffe::epoch_reclaimer::registration *registration =
+            registered ? new goodliffe::epoch_reclaimer::registration(list.get_reclaimer()) : 0;
+        unsigned erased = 0;
+        long     time   = 0;
+        while (erased < reclaimed_objects)
+        {
+            const long start = get_time_us();
+            for (unsigned key = 0; key < size; ++key) erased += unsigned(list.erase(int(key)));
+            time += get_time_us()-start;
+            for (unsigned key = 0; key < size; ++key) list.insert(int(key));
+        }
+        delete registration;
+
+        REQUIRE(list.size() == size);
+        return time;
+    }
+}
+
+void CompareReclamation(unsigned size, std::vector<Comparison> &retiring, std::vector<Comparison> &erasing);
+void CompareReclamation(unsigned size, std::vector<Comparison> &retiring, std::vector<Comparison> &erasing)
+{
+    const long delete_now = TimeDeleteNow();
+    retiring.push_back(Comparison("retire: guard each", delete_now, TimeRetire(false, false)));
+    retiring.push_back(Comparison("retire: registered", delete_now, TimeRetire(true, false)));
+    retiring.push_back(Comparison("retire: one guard", delete_now, TimeRetire(false, true)));
+
+    char name[64];
+    sprintf(name, "erase %u keys, repeatedly", size);
+    erasing.push_back(Comparison(name, TimeConcurrentErase(size, false), TimeConcurrentErase(size, true)));
+}
+
+#endif
+
+//============================================================================
+#pragma mark Batched lookups
+// find_batch against a loop of single finds, on lists far bigger than the cache
+
+template <typename CONTAINER>
+long TimeSingleFinds(const CONTAINER &container, const std::vector<int> &keys,
+                     std::vector<typename CONTAINER::const_iterator> &found)
+{
+    const long start = get_time_us();
+    for (size_t n = 0; n < keys.size(); ++n) found[n] = container.find(keys[n]);
+    return get_time_us()-start;
+}
+
+template <typename CONTAINER>
+long TimeBatchedFinds(const CONTAINER &container, const std::vector<int> &keys,
+                      std::vector<typename CONTAINER::const_iterator> &found)
+{
+    const long start = get_time_us();
+    container.find_batch(keys.begin(), keys.end(), found.begin());
+    return get_time_us()-start;
+}
+
+/// Both ways must find the same things, which also stops either being
+/// optimised away.
+template <typename CONTAINER>
+Comparison CompareFinds(const char *name, const CONTAINER &container, const std::vector<int> &keys)
+{
+    std::vector<typename CONTAINER::const_iterator> single(keys.size()), batched(keys.size());
+    const long single_time  = TimeSingleFinds(container, keys, single);
+    const long batched_time = TimeBatchedFinds(container, keys, batched);
+    REQUIRE(single == batched);
+    return Comparison(name, single_time, batched_time);
+}
+
+void CompareBatchedFinds(unsigned size, std::vector<Comparison> &comparisons);
+void CompareBatchedFinds(unsigned size, std::vector<Comparison> &comparisons)
+{
+    std::vector<int> data;
+    FillWithRandomData(size, data);
+    std::vector<int> keys;
+    FillWithRandomData(size, keys); // a random mix of hits and misses
+
+    char name[64];
+    {
+        goodliffe::skip_list<int> list(data.begin(), data.end());
+        sprintf(name, "skip_list: %u", size);
+        comparisons.push_back(CompareFinds(name, list, keys));
+    }
+    {
+        goodliffe::random_access_skip_list<int> list(data.begin(), data.end());
+        sprintf(name, "ra_skip_list: %u", size);
+        comparisons.push_back(CompareFinds(name, list, keys));
+    }
+}
+
+//============================================================================
+#pragma mark Sorted batches
+// insert_sorted_batch and erase_sorted_batch against a loop of single calls
+
+template <typename CONTAINER>
+Comparison CompareSortedInserts(const char *name, const std::vector<int> &data, const std::vector<int> &batch)
+{
+    CONTAINER single(data.begin(), data.end());
+    long start = get_time_us();
+    for (size_t n = 0; n < batch.size(); ++n) single.insert(batch[n]);
+    const long single_time = get_time_us()-start;
+
+    CONTAINER batched(data.begin(), data.end());
+    start = get_time_us();
+    batched.insert_sorted_batch(batch.begin(), batch.end());
+    const long batched_time = get_time_us()-start;
+
+    REQUIRE(single.size() == batched.size());
+    return Comparison(name, single_time, batched_time);
+}
+
+template <typename CONTAINER>
+Comparison CompareSortedErases(const char *name, const std::vector<int> &data, const std::vector<int> &batch)
+{
+    CONTAINER single(data.begin(), data.end());
+    long start = get_time_us();
+    for (size_t n = 0; n < batch.size(); ++n) single.erase(batch[n]);
+    const long single_time = get_time_us()-start;
+
+    CONTAINER batched(data.begin(), data.end());
+    start = get_time_us();
+    batched.erase_sorted_batch(batch.begin(), batch.end());
+    const long batched_time = get_time_us()-start;
+
+    REQUIRE(single.size() == batched.size());
+    return Comparison(name, single_time, batched_time);
+}
+
+void CompareSortedBatches(unsigned size, unsigned batch_size,
+                          std::vector<Comparison> &inserts, std::vector<Comparison> &erases);
+void CompareSortedBatches(unsigned size, unsigned batch_size,
+                          std::vector<Comparison> &inserts, std::vector<Comparison> &erases)
+{
+    std::vector<int> data;
+    FillWithRandomData(size, data);
+    std::vector<int> batch;
+    FillWithRandomData(batch_size, batch);
+    std::sort(batch.begin(), batch.end());
+
+    char name[64];
+    sprintf(name, "skip_list: %u into %u", batch_size, size);
+    inserts.push_back(CompareSortedInserts<goodliffe::skip_list<int> >(name, data, batch));
+    sprintf(name, "ra_skip_list: %u into %u", batch_size, size);
+    inserts.push_back(CompareSortedInserts<goodliffe::random_access_skip_list<int> >(name, data, batch));
+
+    // erase keys that are there
+    std::vector<int> present(data.begin(), data.begin() + (batch_size < size ? batch_size : size));
+    std::sort(present.begin(), present.end());
+    sprintf(name, "skip_list: %u from %u", batch_size, size);
+    erases.push_back(CompareSortedErases<goodliffe::skip_list<int> >(name, data, present));
+    sprintf(name, "ra_skip_list: %u from %u", batch_size, size);
+    erases.push_back(CompareSortedErases<goodliffe::random_access_skip_list<int> >(name, data, present));
+}
+
 //============================================================================
 #pragma mark The mother of all tests
 // the mother of all comparison tests converted into a benchmark
@@ -662,6 +1172,24 @@ const char *build_type = "Debug";
 const char *build_type = "Release";
 #endif
 
+void PrintComparisons(const char *baseline, const char *candidate, const std::vector<Comparison> &comparisons);
+void PrintComparisons(const char *baseline, const char *candidate, const std::vector<Comparison> &comparisons)
+{
+    fprintf(stderr, "+===============================+=================+=================+===========+\n");
+    fprintf(stderr, "|                    test title | %15s | %15s | candidate%%|\n", baseline, candidate);
+    fprintf(stderr, "+-------------------------------+-----------------+-----------------+-----------+\n");
+
+    for (size_t n = 0; n < comparisons.size(); ++n)
+    {
+        const Comparison &c = comparisons[n];
+        int pc = c.baseline > 0 ? int(c.candidate * 100 / c.baseline) : 0;
+        fprintf(stderr, "|%30s | %15ld | %15ld | %8d%% |\n",
+                c.name.c_str(), c.baseline, c.candidate, pc);
+    }
+    fprintf(stderr, "+===============================+=================+=================+===========+\n");
+    fprintf(stderr, "\n");
+}
+
 void RunBenchmarks(unsigned size);
 void RunBenchmarks(unsigned size)
 {
@@ -671,6 +1199,7 @@ void RunBenchmarks(unsigned size)
     benchmarks.push_back(InsertRandomData(size));           Progress();
     benchmarks.push_back(InsertOrderedData(size));          Progress();
     benchmarks.push_back(InsertReverseOrderedData(size));   Progress();
+    benchmarks.push_back(InsertOrderedDataWithHint(size));  Progress();
     benchmarks.push_back(IterateForwards(size));            Progress();
     benchmarks.push_back(IterateBackwards(size));           Progress();
     benchmarks.push_back(Find(size));                       Progress();
@@ -697,6 +1226,30 @@ void RunBenchmarks(unsigned size)
     }
     fprintf(stderr, "+===============================+===========+===========+==========+==========+==========+==========+=========+=========+=========+=========+\n");
     fprintf(stderr, "\n");
+
+    std::vector<Comparison> allocators;
+    CompareAllocators(size, allocators);
+    PrintComparisons("std::allocator", "pool_allocator", allocators);
+
+    std::vector<Comparison> generators;
+    CompareLevelGenerators(size, generators);
+    PrintComparisons("rand()", "xorshift", generators);
+
+#if SKIP_LIST_CPP11
+    std::vector<Comparison> concurrent;
+    CompareConcurrentMaps(size, concurrent);
+    PrintComparisons("mutex+map", "concurrent", concurrent);
+
+    std::vector<Comparison> sharded;
+    CompareShardedMaps(size, sharded);
+    PrintComparisons("mutex+map", "sharded", sharded);
+
+    std::vector<Comparison> retiring;
+    std::vector<Comparison> erasing;
+    CompareReclamation(size, retiring, erasing);
+    PrintComparisons("delete now", "epoch retire", retiring);
+    PrintComparisons("unregistered", "registered", erasing);
+#endif
 }
 
 TEST_CASE( "skip_list/benchmarks", "" )
@@ -706,3 +1259,25 @@ TEST_CASE( "skip_list/benchmarks", "" )
         RunBenchmarks(size);
     }
 }
+
+TEST_CASE( "skip_list/benchmarks/batched finds", "" )
+{
+    std::vector<Comparison> comparisons;
+    for (unsigned size = 1000; size <= 4096000; size *= 4)
+    {
+        CompareBatchedFinds(size, comparisons);
+    }
+    PrintComparisons("find", "find_batch", comparisons);
+}
+
+TEST_CASE( "skip_list/benchmarks/sorted batches", "" )
+{
+    std::vector<Comparison> inserts, erases;
+    for (unsigned batch_size = 10000; batch_size <= 100000; batch_size *= 10)
+    {
+        CompareSortedBatches(1000000, batch_size, inserts, erases);
+        CompareSortedBatches(batch_size, batch_size, inserts, erases);
+    }
+    PrintComparisons("insert", "insert_sorted_batch", inserts);
+    PrintComparisons("erase", "erase_sorted_batch", erases);
+}
@@ -0,0 +1,267 @@
+//============================================================================
+// test_augmented_skip_list_map.cpp
+// Copyright (c) 2011 Pete Goodliffe. All rights reserved
+//============================================================================
+
+#include "augmented_skip_list_map.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION 1
+#include "catch.hpp"
+#include "test_types.h"
+
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+
+using goodliffe::augmented_skip_list_map;
+using goodliffe::min_aggregator;
+using goodliffe::max_aggregator;
+using goodliffe::count_aggregator;
+
+namespace
+{
+    /// Joins the values in order, which shows up any that are combined out
+    /// of order; the other aggregators would not notice.
+    struct concat_aggregator
+    {
+        typedef std::string result_type;
+
+        result_type identity() const                                                 { return std::string(); }
+        result_type operator()(char value) const                                     { return std::string(1, value); }
+        result_type operator()(const result_type &lhs, const result_type &rhs) const { return lhs + rhs; }
+    };
+
+    template <typename AGGREGATOR>
+    typename AGGREGATOR::result_type
+    Aggregate(const std::map<int,int> &map, int lo, int hi, AGGREGATOR aggregator)
+    {
+        typename AGGREGATOR::result_type result = aggregator.identity();
+        if (!(lo < hi)) return result;
+        for (std::map<int,int>::const_iterator i = map.lower_bound(lo); i != map.lower_bound(hi); ++i)
+            result = aggregator(result, aggregator(i->second));
+        return result;
+    }
+}
+
+TEST_CASE( "augmented_skip_list_map/is constructable", "" )
+{
+    augmented_skip_list_map<int, int> map;
+
+    REQUIRE(map.empty());
+    REQUIRE(map.size() == 0);
+    REQUIRE(map.begin() == map.end());
+    REQUIRE(map.aggregate() == 0);
+    REQUIRE(map.aggregate(0, 100) == 0);
+}
+
+TEST_CASE( "augmented_skip_list_map/insert and find", "" )
+{
+    augmented_skip_list_map<int, int> map;
+
+    REQUIRE(map.insert(std::make_pair(20, 2)).second);
+    REQUIRE(map.insert(std::make_pair(10, 1)).second);
+    REQUIRE(!map.insert(std::make_pair(10, 100)).second);
+
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.count(10) == 1);
+    REQUIRE(map.find(10)->second == 1);
+    REQUIRE(map.find(15) == map.end());
+    REQUIRE(map.lower_bound(15)->first == 20);
+    REQUIRE(map.upper_bound(20) == map.end());
+    REQUIRE(map.aggregate() == 3);
+}
+
+//============================================================================
+// aggregates
+
+TEST_CASE( "augmented_skip_list_map/sums over ranges", "" )
+{
+    // prices to volumes
+    augmented_skip_list_map<int, int> book;
+    for (int price = 100; price < 200; ++price) book.insert(std::make_pair(price, price - 99));
+
+    REQUIRE(book.aggregate() == 5050);
+    REQUIRE(book.aggregate(100, 200) == 5050);
+    REQUIRE(book.aggregate(100, 101) == 1);
+    REQUIRE(book.aggregate(110, 120) == 155);
+    REQUIRE(book.aggregate(0, 100) == 0);
+    REQUIRE(book.aggregate(150, 150) == 0);
+    REQUIRE(book.aggregate(160, 150) == 0);
+    REQUIRE(book.aggregate(199, 1000) == 100);
+}
+
+TEST_CASE( "augmented_skip_list_map/aggregates follow inserts, updates and erases", "" )
+{
+    augmented_skip_list_map<int, int>                      sums;
+    augmented_skip_list_map<int, int, min_aggregator<int> > mins;
+    augmented_skip_list_map<int, int, max_aggregator<int> > maxes;
+    std::map<int, int>                                     expected;
+
+    std::srand(99);
+    for (int n = 0; n < 600; ++n)
+    {
+        const int key   = std::rand() % 300;
+        const int value = std::rand() % 1000 - 500;
+        switch (std::rand() % 3)
+        {
+            case 0:
+            case 1:
+                sums.update(key, value);
+                mins.update(key, value);
+                maxes.update(key, value);
+                expected[key] = value;
+                break;
+            default:
+                sums.erase(key);
+                mins.erase(key);
+                maxes.erase(key);
+                expected.erase(key);
+                break;
+        }
+    }
+    REQUIRE(sums.size() == expected.size());
+    REQUIRE(sums.aggregate() == Aggregate(expected, 0, 300, goodliffe::sum_aggregator<int>()));
+
+    for (int n = 0; n < 300; ++n)
+    {
+        const int lo = std::rand() % 320 - 10;
+        const int hi = std::rand() % 320 - 10;
+        REQUIRE(sums.aggregate(lo, hi) == Aggregate(expected, lo, hi, goodliffe::sum_aggregator<int>()));
+        REQUIRE(mins.aggregate(lo, hi) == Aggregate(expected, lo, hi, min_aggregator<int>()));
+        REQUIRE(maxes.aggregate(lo, hi) == Aggregate(expected, lo, hi, max_aggregator<int>()));
+    }
+}
+
+TEST_CASE( "augmented_skip_list_map/custom aggregators combine in key order", "" )
+{
+    augmented_skip_list_map<int, char, concat_aggregator> map;
+    const std::string letters = "thequickbrownfoxjumpsoverthelazydog";
+    for (unsigned n = 0; n < letters.size(); ++n)
+        map.insert(std::make_pair(int((n * 11) % letters.size()), letters[n]));
+
+    std::string in_order;
+    for (augmented_skip_list_map<int, char, concat_aggregator>::const_iterator i = map.begin(); i != map.end(); ++i)
+        in_order += i->second;
+
+    REQUIRE(map.aggregate() == in_order);
+    REQUIRE(map.aggregate(5, 20) == in_order.substr(5, 15));
+
+    map.update(map.find(6), 'X');
+    in_order[6] = 'X';
+    REQUIRE(map.aggregate(5, 20) == in_order.substr(5, 15));
+
+    map.erase(map.find(10), map.find(12));
+    in_order.erase(10, 2);
+    REQUIRE(map.aggregate() == in_order);
+}
+
+TEST_CASE( "augmented_skip_list_map/count_aggregator counts keys", "" )
+{
+    augmented_skip_list_map<int, std::string, count_aggregator<std::string> > map;
+    for (int n = 0; n < 100; n += 2) map.insert(std::make_pair(n, std::string("x")));
+
+    REQUIRE(map.aggregate() == 50);
+    REQUIRE(map.aggregate(10, 20) == 5);
+    REQUIRE(map.aggregate(11, 21) == 5);
+}
+
+TEST_CASE( "augmented_skip_list_map/copy, assign and swap keep aggregates", "" )
+{
+    augmented_skip_list_map<int, int> map;
+    for (int n = 0; n < 50; ++n) map.insert(std::make_pair(n, n));
+
+    augmented_skip_list_map<int, int> copy(map);
+    REQUIRE(copy == map);
+    REQUIRE(copy.aggregate(10, 20) == 145);
+
+    copy.update(15, 0);
+    REQUIRE(copy != map);
+    REQUIRE(copy.aggregate(10, 20) == 130);
+
+    augmented_skip_list_map<int, int> other;
+    other.swap(copy);
+    REQUIRE(copy.empty());
+    REQUIRE(other.aggregate(10, 20) == 130);
+
+    other = map;
+    REQUIRE(other.aggregate() == 1225);
+    other.clear();
+    REQUIRE(other.aggregate() == 0);
+}
+
+namespace
+{
+    /// Sums the values times a factor, which is state the aggregates
+    /// depend on.
+    struct scaled_sum_aggregator
+    {
+        typedef int result_type;
+
+        explicit scaled_sum_aggregator(int factor_ = 1) : factor(factor_) {}
+
+        result_type identity() const                                         { return 0; }
+        result_type operator()(int value) const                              { return value * factor; }
+        result_type operator()(result_type lhs, result_type rhs) const       { return lhs + rhs; }
+
+        int factor;
+    };
+}
+
+TEST_CASE( "augmented_skip_list_map/assignment takes the aggregator too", "" )
+{
+    typedef augmented_skip_list_map<int, int, scaled_sum_aggregator> map_type;
+
+    map_type tens(map_type::allocator_type(), scaled_sum_aggregator(10));
+    for (int n = 0; n < 50; ++n) tens.insert(std::make_pair(n, n));
+    REQUIRE(tens.aggregate() == 12250);
+
+    map_type ones;
+    ones.insert(std::make_pair(1, 1));
+    ones = tens;
+    REQUIRE(ones.get_aggregator().factor == 10);
+    REQUIRE(ones.aggregate() == 12250);
+    REQUIRE(ones.aggregate(10, 20) == 1450);
+    REQUIRE(ones == tens);
+}
+
+TEST_CASE( "augmented_skip_list_map/range constructors take an aggregator", "" )
+{
+    typedef augmented_skip_list_map<int, int, scaled_sum_aggregator> map_type;
+
+    std::vector<std::pair<int, int> > values;
+    for (int n = 0; n < 10; ++n) values.push_back(std::make_pair(n, n));
+
+    map_type map(values.begin(), values.end(), map_type::allocator_type(), scaled_sum_aggregator(10));
+    REQUIRE(map.get_aggregator().factor == 10);
+    REQUIRE(map.aggregate() == 450);
+
+#if SKIP_LIST_CPP11
+    map_type listed({ {1, 1}, {2, 2} }, map_type::allocator_type(), scaled_sum_aggregator(3));
+    REQUIRE(listed.get_aggregator().factor == 3);
+    REQUIRE(listed.aggregate() == 9);
+#endif
+}
+
+TEST_CASE( "augmented_skip_list_map/duplicate insert leaves the height alone", "" )
+{
+    typedef augmented_skip_list_map<int, int, goodliffe::sum_aggregator<int>, std::less<int>,
+                                    std::allocator<std::pair<const int, int> >, TallLevelGenerator> map_type;
+
+    map_type map;
+    for (int n = 0; n < 5; ++n) map.insert(std::make_pair(n, n));
+
+    std::ostringstream before;
+    map.dump(before);
+    REQUIRE(DumpHeader(map) == "skip_list(size=5,levels=5)");
+
+    for (int n = 0; n < 5; ++n)
+    {
+        REQUIRE(!map.insert(std::make_pair(n, 100)).second);
+    }
+
+    std::ostringstream after;
+    map.dump(after);
+    REQUIRE(after.str() == before.str());
+    REQUIRE(map.aggregate() == 10);
+}
@@ -0,0 +1,388 @@
+//============================================================================
+// test_concurrent_skip_list.cpp
+//============================================================================
+
+#include "concurrent_skip_list.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION 1
+#include "catch.hpp"
+#include "test_types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using goodliffe::concurrent_skip_list;
+using goodliffe::concurrent_skip_list_map;
+
+namespace
+{
+    struct Collect
+    {
+        std::vector<int> *values;
+        void operator()(int value) const { values->push_back(value); }
+    };
+
+    std::vector<int> ContentsOf(const concurrent_skip_list<int> &list)
+    {
+        std::vector<int> values;
+        Collect collect = { &values };
+        list.for_each(collect);
+        return values;
+    }
+
+    bool IsStrictlyIncreasing(const std::vector<int> &values)
+    {
+        for (size_t n = 1; n < values.size(); ++n)
+        {
+            if (!(values[n-1] < values[n])) return false;
+        }
+        return true;
+    }
+
+    const unsigned num_threads = 4;
+}
+
+//============================================================================
+// single threaded
+
+TEST_CASE( "concurrent_skip_list/smoketest", "" )
+{
+    concurrent_skip_list<int> list;
+    REQUIRE(list.empty());
+    REQUIRE(list.size() == 0);
+    REQUIRE_FALSE(list.contains(10));
+}
+
+TEST_CASE( "concurrent_skip_list/insert", "" )
+{
+    concurrent_skip_list<int> list;
+    REQUIRE(list.insert(20));
+    REQUIRE(list.insert(10));
+    REQUIRE(list.insert(30));
+    REQUIRE_FALSE(list.insert(20));
+
+    REQUIRE(list.size() == 3);
+    REQUIRE(list.contains(10));
+    REQUIRE(list.contains(20));
+    REQUIRE(list.contains(30));
+    REQUIRE_FALSE(list.contains(15));
+    REQUIRE(list.count(20) == 1);
+    REQUIRE(list.count(21) == 0);
+
+    std::vector<int> contents = ContentsOf(list);
+    REQUIRE(contents.size() == 3);
+    REQUIRE(contents[0] == 10);
+    REQUIRE(contents[1] == 20);
+    REQUIRE(contents[2] == 30);
+}
+
+TEST_CASE( "concurrent_skip_list/erase", "" )
+{
+    concurrent_skip_list<int> list;
+    for (int n = 0; n < 100; ++n) list.insert(n);
+
+    REQUIRE(list.erase(50) == 1);
+    REQUIRE(list.erase(50) == 0);
+    REQUIRE(list.erase(1000) == 0);
+    REQUIRE(list.size() == 99);
+    REQUIRE_FALSE(list.contains(50));
+    REQUIRE(list.contains(49));
+    REQUIRE(list.contains(51));
+
+    for (int n = 0; n < 100; n += 2) list.erase(n);
+    std::vector<int> contents = ContentsOf(list);
+    REQUIRE(contents.size() == 50);
+    REQUIRE(IsStrictlyIncreasing(contents));
+    REQUIRE(contents.front() == 1);
+
+    REQUIRE(list.insert(50));
+    REQUIRE(list.contains(50));
+}
+
+TEST_CASE( "concurrent_skip_list/clear", "" )
+{
+    concurrent_skip_list<int> list;
+    for (int n = 0; n < 1000; ++n) list.insert(n);
+    list.clear();
+    REQUIRE(list.empty());
+    REQUIRE(ContentsOf(list).empty());
+    REQUIRE(list.insert(5));
+    REQUIRE(list.size() == 1);
+}
+
+TEST_CASE( "concurrent_skip_list/allocation/everything is freed", "" )
+{
+    AllocationCounter::reset();
+    {
+        concurrent_skip_list<int, std::less<int>, CountingAllocator<int> > list;
+        for (int n = 0; n < 1000; ++n) list.insert(n);
+        for (int n = 0; n < 1000; n += 3) list.erase(n);
+        list.insert(5); // a duplicate, freed straight away
+        REQUIRE(AllocationCounter::blocks > 0);
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "concurrent_skip_list_map/find", "" )
+{
+    concurrent_skip_list_map<int, std::string> map;
+    REQUIRE(map.insert(std::make_pair(1, std::string("one"))));
+    REQUIRE(map.insert(std::make_pair(2, std::string("two"))));
+    REQUIRE_FALSE(map.insert(std::make_pair(1, std::string("uno"))));
+    REQUIRE(map.size() == 2);
+
+    std::string value = "unchanged";
+    REQUIRE(map.find(1, value));
+    REQUIRE(value == "one");
+    REQUIRE_FALSE(map.find(3, value));
+    REQUIRE(value == "one");
+
+    REQUIRE(map.erase(1) == 1);
+    REQUIRE_FALSE(map.contains(1));
+    REQUIRE(map.contains(2));
+}
+
+//============================================================================
+// multi threaded
+
+namespace
+{
+    void InsertRange(concurrent_skip_list<int> *list, int from, int to, int step)
+    {
+        for (int n = from; n < to; n += step) list->insert(n);
+    }
+}
+
+TEST_CASE( "concurrent_skip_list/threads/disjoint inserts", "" )
+{
+    concurrent_skip_list<int> list;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+        threads.push_back(std::thread(&InsertRange, &list, int(t), 20000, int(num_threads)));
+    }
+    for (unsigned t = 0; t < num_threads; ++t) threads[t].join();
+
+    REQUIRE(list.size() == 20000);
+    std::vector<int> contents = ContentsOf(list);
+    REQUIRE(contents.size() == 20000);
+    REQUIRE(IsStrictlyIncreasing(contents));
+}
+
+namespace
+{
+    /// Insert and erase from a small key range, so threads collide. Counts
+    /// what succeeded, so the final size can be checked.
+    void Churn(concurrent_skip_list<int> *list, unsigned seed, long *net_inserts)
+    {
+        unsigned state = seed*2654435761u + 1;
+        long net = 0;
+        for (unsigned n = 0; n < 20000; ++n)
+        {
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            const int key = int(state % 256);
+            if (state & 0x100)
+            {
+                if (list->insert(key)) ++net;
+            }
+            else
+            {
+                net -= long(list->erase(key));
+            }
+        }
+        *net_inserts = net;
+    }
+}
+
+TEST_CASE( "concurrent_skip_list/threads/colliding inserts and erases", "" )
+{
+    concurrent_skip_list<int> list;
+    std::vector<long>        net(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+        threads.push_back(std::thread(&Churn, &list, t+1, &net[t]));
+    }
+    for (unsigned t = 0; t < num_threads; ++t) threads[t].join();
+
+    long total = 0;
+    for (unsigned t = 0; t < num_threads; ++t) total += net[t];
+
+    std::vector<int> contents = ContentsOf(list);
+    REQUIRE(long(list.size()) == total);
+    REQUIRE(long(contents.size()) == total);
+    REQUIRE(IsStrictlyIncreasing(contents));
+    for (int key = 0; key < 256; ++key)
+    {
+        REQUIRE(list.contains(key) == std::binary_search(contents.begin(), contents.end(), key));
+    }
+}
+
+namespace
+{
+    void ReadWhileWriting(const concurrent_skip_list<int> *list, const std::atomic<bool> *stop, bool *ok)
+    {
+        while (!*stop)
+        {
+            std::vector<int> values;
+            Collect collect = { &values };
+            list->for_each(collect);
+            if (!IsStrictlyIncreasing(values)) *ok = false;
+            // the even numbers are never erased
+            for (int n = 0; n < 1000; n += 2)
+            {
+                if (!list->contains(n)) *ok = false;
+            }
+        }
+    }
+
+    void EraseAndReinsertOdds(concurrent_skip_list<int> *list)
+    {
+        for (unsigned repeat = 0; repeat < 20; ++repeat)
+        {
+            for (int n = 1; n < 1000; n += 2) list->erase(n);
+            for (int n = 1; n < 1000; n += 2) list->insert(n);
+        }
+    }
+}
+
+TEST_CASE( "concurrent_skip_list/threads/readers see a consistent list", "" )
+{
+    concurrent_skip_list<int> list;
+    for (int n = 0; n < 1000; ++n) list.insert(n);
+
+    std::atomic<bool> stop(false);
+    bool              ok = true;
+    std::thread reader(&ReadWhileWriting, &list, &stop, &ok);
+    std::thread writer1(&EraseAndReinsertOdds, &list);
+    std::thread writer2(&EraseAndReinsertOdds, &list);
+    writer1.join();
+    writer2.join();
+    stop = true;
+    reader.join();
+
+    REQUIRE(ok);
+    REQUIRE(list.size() == 1000);
+}
+
+//============================================================================
+// reclamation
+
+namespace
+{
+    /// A CountingAllocator that many threads can use at once.
+    struct AtomicAllocationCounter
+    {
+        static std::atomic<long> blocks;
+    };
+
+    std::atomic<long> AtomicAllocationCounter::blocks(0);
+
+    template <typename T>
+    struct AtomicCountingAllocator : std::allocator<T>
+    {
+        AtomicCountingAllocator() {}
+        template <class OTHER>
+        AtomicCountingAllocator(const OTHER &) {}
+
+        template <typename OTHER>
+        struct rebind { typedef AtomicCountingAllocator<OTHER> other; };
+
+        T *allocate(size_t n, const void * = 0)
+        {
+            ++AtomicAllocationCounter::blocks;
+            return std::allocator<T>::allocate(n);
+        }
+        void deallocate(T *p, size_t n)
+        {
+            --AtomicAllocationCounter::blocks;
+            std::allocator<T>::deallocate(p, n);
+        }
+    };
+
+    typedef concurrent_skip_list_map<int, std::string, std::less<int>,
+                                     AtomicCountingAllocator<std::pair<const int, std::string> > >
+        CountedMap;
+
+    std::string NameOf(int key)
+    {
+        return std::string(size_t(key % 50 + 20), char('a' + key % 26));
+    }
+
+    struct CheckEntry
+    {
+        bool *ok;
+        int  *last;
+        void operator()(const std::pair<const int, std::string> &entry) const
+        {
+            if (entry.first <= *last || entry.second != NameOf(entry.first)) *ok = false;
+            *last = entry.first;
+        }
+    };
+
+    /// Walks the map over and over, checking every value it passes is intact.
+    void IterateWhileErasing(const CountedMap *map, const std::atomic<bool> *stop, bool *ok)
+    {
+        while (!*stop)
+        {
+            int last = -1;
+            CheckEntry check = { ok, &last };
+            map->for_each(check);
+
+            std::string value;
+            for (int key = 0; key < 2000; key += 97)
+            {
+                if (map->find(key, value) && value != NameOf(key)) *ok = false;
+            }
+        }
+    }
+
+    /// Erases every key this thread owns, puts them back, and repeats.
+    void EraseEverything(CountedMap *map, int first, int step, bool registered)
+    {
+        goodliffe::epoch_reclaimer::registration *registration = registered
+            ? new goodliffe::epoch_reclaimer::registration(map->get_reclaimer())
+            : 0;
+        for (unsigned repeat = 0; repeat < 30; ++repeat)
+        {
+            for (int key = first; key < 2000; key += step) map->erase(key);
+            for (int key = first; key < 2000; key += step) map->insert(std::make_pair(key, NameOf(key)));
+        }
+        delete registration;
+    }
+}
+
+TEST_CASE( "concurrent_skip_list_map/threads/erase while readers iterate", "" )
+{
+    AtomicAllocationCounter::blocks = 0;
+    {
+        CountedMap map;
+        for (int key = 0; key < 2000; ++key) map.insert(std::make_pair(key, NameOf(key)));
+
+        std::atomic<bool> stop(false);
+        bool              ok1 = true, ok2 = true;
+        std::thread reader1(&IterateWhileErasing, &map, &stop, &ok1);
+        std::thread reader2(&IterateWhileErasing, &map, &stop, &ok2);
+        std::vector<std::thread> writers;
+        for (unsigned t = 0; t < num_threads; ++t)
+        {
+            writers.push_back(std::thread(&EraseEverything, &map, int(t), int(num_threads), t % 2 == 0));
+        }
+        for (unsigned t = 0; t < num_threads; ++t) writers[t].join();
+        stop = true;
+        reader1.join();
+        reader2.join();
+
+        REQUIRE(ok1);
+        REQUIRE(ok2);
+        REQUIRE(map.size() == 2000);
+
+        // Once everyone has gone, every erased node can be freed
+        for (int n = 0; n < 3; ++n) map.get_reclaimer().collect();
+        REQUIRE(AtomicAllocationCounter::blocks.load() == 2000 + 1); // and the head
+    }
+    REQUIRE(AtomicAllocationCounter::blocks.load() == 0);
+}
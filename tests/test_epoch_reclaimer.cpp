@@ -0,0 +1,193 @@
+//============================================================================
+// test_epoch_reclaimer.cpp
+//============================================================================
+
+#include "skip_list_epoch_reclaimer.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION 1
+#include "catch.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using goodliffe::epoch_reclaimer;
+
+namespace
+{
+    /// Counts what the reclaimer frees, and how it was batched.
+    struct Freed
+    {
+        Freed() : objects(0), track_batches(true) {}
+
+        std::atomic<int>         objects;
+        bool                     track_batches; // only safe single threaded
+        std::vector<std::size_t> batches;
+
+        static void Free(void *context, void **objects, std::size_t count)
+        {
+            Freed *freed = static_cast<Freed*>(context);
+            for (std::size_t n = 0; n < count; ++n) delete static_cast<int*>(objects[n]);
+            freed->objects += int(count);
+            if (freed->track_batches) freed->batches.push_back(count);
+        }
+    };
+
+    void Retire(epoch_reclaimer &reclaimer, Freed &freed, int count)
+    {
+        for (int n = 0; n < count; ++n)
+        {
+            epoch_reclaimer::guard g(reclaimer);
+            g.retire(new int(n), &Freed::Free, &freed);
+        }
+    }
+}
+
+TEST_CASE( "epoch_reclaimer/retired objects are freed", "" )
+{
+    Freed freed;
+    {
+        epoch_reclaimer reclaimer;
+        Retire(reclaimer, freed, 1000);
+        REQUIRE(freed.objects.load() > 0);    // without waiting for the destructor
+        REQUIRE(freed.objects.load() < 1000); // but not straight away
+    }
+    REQUIRE(freed.objects.load() == 1000);
+}
+
+TEST_CASE( "epoch_reclaimer/collect frees what is safe", "" )
+{
+    Freed freed;
+    epoch_reclaimer reclaimer;
+    Retire(reclaimer, freed, 10);
+    REQUIRE(freed.objects.load() == 0);
+    reclaimer.collect();
+    reclaimer.collect();
+    reclaimer.collect();
+    REQUIRE(freed.objects.load() == 10);
+}
+
+TEST_CASE( "epoch_reclaimer/objects retired together are freed together", "" )
+{
+    Freed freed;
+    Freed other;
+    {
+        epoch_reclaimer reclaimer;
+        epoch_reclaimer::guard g(reclaimer);
+        for (int n = 0; n < 10; ++n) g.retire(new int(n), &Freed::Free, &freed);
+        for (int n = 0; n < 10; ++n)
+        {
+            g.retire(new int(n), &Freed::Free, (n % 2) ? &freed : &other);
+        }
+    }
+    REQUIRE(freed.objects.load() == 15);
+    REQUIRE(other.objects.load() == 5);
+    REQUIRE(freed.batches.size() == 6);
+    REQUIRE(freed.batches[0] == 10);
+    REQUIRE(other.batches.size() == 5);
+}
+
+TEST_CASE( "epoch_reclaimer/guards nest", "" )
+{
+    Freed freed;
+    epoch_reclaimer reclaimer;
+    {
+        epoch_reclaimer::guard outer(reclaimer);
+        {
+            epoch_reclaimer::guard inner(reclaimer);
+            inner.retire(new int(1), &Freed::Free, &freed);
+        }
+        // still pinned by outer, so the epoch can't get far enough
+        reclaimer.collect();
+        reclaimer.collect();
+        reclaimer.collect();
+        REQUIRE(freed.objects.load() == 0);
+    }
+    reclaimer.collect();
+    reclaimer.collect();
+    REQUIRE(freed.objects.load() == 1);
+}
+
+TEST_CASE( "epoch_reclaimer/registered threads reuse their record", "" )
+{
+    Freed freed;
+    epoch_reclaimer reclaimer;
+    {
+        epoch_reclaimer::registration registered(reclaimer);
+        Retire(reclaimer, freed, 1000);
+        REQUIRE(freed.objects.load() > 0);
+    }
+    {
+        // the record went back, and another registration can have it
+        epoch_reclaimer::registration registered(reclaimer);
+        Retire(reclaimer, freed, 10);
+    }
+    reclaimer.collect();
+    reclaimer.collect();
+    REQUIRE(freed.objects.load() == 1010);
+}
+
+namespace
+{
+    void StayPinned(epoch_reclaimer *reclaimer, std::atomic<bool> *pinned, std::atomic<bool> *stop)
+    {
+        epoch_reclaimer::guard g(*reclaimer);
+        *pinned = true;
+        while (!*stop) std::this_thread::yield();
+    }
+}
+
+TEST_CASE( "epoch_reclaimer/threads/nothing is freed under a pinned reader", "" )
+{
+    Freed freed;
+    epoch_reclaimer reclaimer;
+
+    std::atomic<bool> pinned(false);
+    std::atomic<bool> stop(false);
+    std::thread reader(&StayPinned, &reclaimer, &pinned, &stop);
+    while (!pinned) std::this_thread::yield();
+
+    Retire(reclaimer, freed, 1000);
+    REQUIRE(freed.objects.load() == 0);
+
+    stop = true;
+    reader.join();
+    Retire(reclaimer, freed, 1000);
+    REQUIRE(freed.objects.load() > 0);
+}
+
+namespace
+{
+    void RetireMany(epoch_reclaimer *reclaimer, Freed *freed, bool registered)
+    {
+        if (registered)
+        {
+            epoch_reclaimer::registration registration(*reclaimer);
+            Retire(*reclaimer, *freed, 20000);
+        }
+        else
+        {
+            Retire(*reclaimer, *freed, 20000);
+        }
+    }
+}
+
+TEST_CASE( "epoch_reclaimer/threads/many threads retiring at once", "" )
+{
+    const unsigned num_threads = 4;
+    std::vector<Freed> freed(num_threads);
+    for (unsigned t = 0; t < num_threads; ++t) freed[t].track_batches = false;
+    {
+        epoch_reclaimer reclaimer;
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < num_threads; ++t)
+        {
+            threads.push_back(std::thread(&RetireMany, &reclaimer, &freed[t], t % 2 == 0));
+        }
+        for (unsigned t = 0; t < num_threads; ++t) threads[t].join();
+    }
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+        REQUIRE(freed[t].objects.load() == 20000);
+    }
+}
@@ -14,10 +14,20 @@
 #include "catch.hpp"
 #include "test_types.h"
 
+#include <algorithm>
 #include <set>
 
 using goodliffe::multi_skip_list;
 
+namespace
+{
+    /// Orders by tens, so the units can tell equivalent values apart.
+    struct TensLess
+    {
+        bool operator()(int lhs, int rhs) const { return lhs/10 < rhs/10; }
+    };
+}
+
 //==============================================================================
 
 #ifdef _MSC_VER
@@ -194,6 +204,360 @@ TEST_CASE( "multi_skip_list/erase over multiple item boundary", "" )
     REQUIRE(list.empty());
 }
 
+namespace
+{
+    struct KeyedItem
+    {
+        int key;
+        int id;
+        KeyedItem(int key_, int id_) : key(key_), id(id_) {}
+    };
+
+    struct CountingKeyLess
+    {
+        static unsigned comparisons;
+        bool operator()(const KeyedItem &lhs, const KeyedItem &rhs) const
+            { ++comparisons; return lhs.key < rhs.key; }
+    };
+
+    unsigned CountingKeyLess::comparisons = 0;
+
+    inline
+    std::ostream &operator<<(std::ostream &s, const KeyedItem &v)
+        { return s << v.key << "#" << v.id; }
+}
+
+TEST_CASE( "multi_skip_list/erase/by iterator removes that item from a run of duplicates", "" )
+{
+    typedef multi_skip_list<KeyedItem,CountingKeyLess> list_type;
+    list_type list;
+
+    for (int n = 0; n < 200; ++n) list.insert(KeyedItem(n%3, n));
+
+    list_type::iterator i = list.begin();
+    std::advance(i, 90);
+    REQUIRE(i->key == 1);
+    const int erased_id = i->id;
+
+    CountingKeyLess::comparisons = 0;
+    list.erase(i);
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS // check() compares
+    REQUIRE(CountingKeyLess::comparisons == 0);
+#endif
+    REQUIRE(list.size() == 199);
+
+    unsigned ones = 0;
+    for (list_type::iterator j = list.begin(); j != list.end(); ++j)
+    {
+        REQUIRE(j->id != erased_id);
+        if (j->key == 1) ++ones;
+    }
+    REQUIRE(ones == 66);
+    REQUIRE(std::distance(list.rbegin(), list.rend()) == 199);
+}
+
+TEST_CASE( "multi_skip_list/bounds/descend without walking the run", "" )
+{
+    typedef multi_skip_list<KeyedItem,CountingKeyLess> list_type;
+    list_type list;
+    for (int n = 0; n < 3000; ++n) list.insert(KeyedItem(n%3, n));
+
+    CountingKeyLess::comparisons = 0;
+    list_type::iterator lower = list.lower_bound(KeyedItem(1, 0));
+    list_type::iterator upper = list.upper_bound(KeyedItem(1, 0));
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    // two descents; walking the run would take 1000
+    REQUIRE(CountingKeyLess::comparisons < 200);
+#endif
+
+    REQUIRE(lower->key == 1);
+    REQUIRE((--list_type::iterator(lower))->key == 0);
+    REQUIRE(upper->key == 2);
+    REQUIRE((--list_type::iterator(upper))->key == 1);
+    REQUIRE(std::distance(lower, upper) == 1000);
+
+    std::pair<list_type::iterator,list_type::iterator> range = list.equal_range(KeyedItem(1, 0));
+    REQUIRE(range.first == lower);
+    REQUIRE(range.second == upper);
+
+    REQUIRE(list.lower_bound(KeyedItem(0, 0)) == list.begin());
+    REQUIRE(list.upper_bound(KeyedItem(2, 0)) == list.end());
+    REQUIRE(list.lower_bound(KeyedItem(3, 0)) == list.end());
+    REQUIRE(list.upper_bound(KeyedItem(-1, 0)) == list.begin());
+
+    CountingKeyLess::comparisons = 0;
+    REQUIRE(list.count(KeyedItem(1, 0)) == 1000);
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    // one descent, then one comparison per item in the run
+    REQUIRE(CountingKeyLess::comparisons < 1000+100);
+#endif
+}
+
+TEST_CASE( "multi_skip_list/erase/by value removes the run in one pass", "" )
+{
+    typedef multi_skip_list<KeyedItem,CountingKeyLess> list_type;
+    list_type list;
+    for (int n = 0; n < 3000; ++n) list.insert(KeyedItem(n%3, n));
+
+    CountingKeyLess::comparisons = 0;
+    REQUIRE(list.erase(KeyedItem(1, 0)) == 1000);
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS // check() compares
+    // two to step back over each duplicate, and a search
+    REQUIRE(CountingKeyLess::comparisons < 2000+200);
+#endif
+    REQUIRE(list.size() == 2000);
+    REQUIRE(list.count(KeyedItem(1, 0)) == 0);
+    REQUIRE(list.count(KeyedItem(0, 0)) == 1000);
+    REQUIRE(list.count(KeyedItem(2, 0)) == 1000);
+
+    REQUIRE(list.erase(KeyedItem(1, 0)) == 0);
+    REQUIRE(list.erase(KeyedItem(2, 0)) == 1000);
+    REQUIRE(list.erase(KeyedItem(0, 0)) == 1000);
+    REQUIRE(list.empty());
+}
+
+TEST_CASE( "multi_skip_list/erase/ranges within runs of duplicates", "" )
+{
+    typedef multi_skip_list<KeyedItem,CountingKeyLess> list_type;
+    list_type list;
+    for (int n = 0; n < 600; ++n) list.insert(KeyedItem(n%4, n));
+    std::vector<int> ids;
+    for (list_type::iterator i = list.begin(); i != list.end(); ++i) ids.push_back(i->id);
+
+    while (list.size() > 10)
+    {
+        const int from  = rand() % int(list.size());
+        const int count = rand() % std::min(40, int(list.size()) - from);
+
+        list_type::iterator first = list.begin();
+        std::advance(first, from);
+        list_type::iterator last = first;
+        std::advance(last, count);
+
+        list_type::iterator result = list.erase(first, last);
+        ids.erase(ids.begin()+from, ids.begin()+from+count);
+
+        REQUIRE(list.size() == ids.size());
+        REQUIRE(std::distance(list.begin(), result) == from);
+        std::vector<int> remaining;
+        for (list_type::iterator i = list.begin(); i != list.end(); ++i) remaining.push_back(i->id);
+        REQUIRE(remaining == ids);
+    }
+}
+
+//============================================================================
+// assign_sorted and copying
+
+TEST_CASE( "multi_skip_list/assign_sorted/keeps repeated values", "" )
+{
+    std::multiset<int> set;
+    for (int n = 0; n < 1000; ++n) set.insert(rand() % 100);
+
+    multi_skip_list<int> list;
+    list.insert(5);
+    list.assign_sorted(set.begin(), set.end());
+    REQUIRE(CheckEquality(list, set));
+    REQUIRE(list.count(50) == set.count(50));
+
+    REQUIRE(list.erase(50) == set.erase(50));
+    list.insert(50);
+    set.insert(50);
+    REQUIRE(CheckEquality(list, set));
+}
+
+TEST_CASE( "multi_skip_list/copy keeps repeated values", "" )
+{
+    multi_skip_list<int> source;
+    for (int n = 0; n < 100; ++n) source.insert(n % 7);
+
+    multi_skip_list<int> copy(source);
+    REQUIRE(CheckEquality(copy, source));
+
+    multi_skip_list<int> assignee;
+    assignee.insert(1);
+    assignee = source;
+    REQUIRE(CheckEquality(assignee, source));
+    REQUIRE(assignee.count(3) == 14);
+}
+
+#if SKIP_LIST_CPP11
+
+TEST_CASE( "multi_skip_list/C++11/move and emplace keep repeated values", "" )
+{
+    multi_skip_list<int> source = { 3, 1, 3, 2, 3 };
+    REQUIRE(source.count(3) == 3);
+
+    multi_skip_list<int> moved(std::move(source));
+    REQUIRE(moved.count(3) == 3);
+    REQUIRE(source.empty());
+
+    moved.emplace(3);
+    moved.insert(3);
+    REQUIRE(moved.count(3) == 5);
+
+    source = std::move(moved);
+    REQUIRE(source.size() == 7);
+    REQUIRE(moved.empty());
+}
+
+TEST_CASE( "multi_skip_list/C++11/extract takes the first repeated value", "" )
+{
+    typedef multi_skip_list<int, TensLess> list_type;
+    list_type list;
+    for (int n = 0; n < 5; ++n) list.insert(30+n);
+
+    // repeated values go in ahead of their equivalents
+    list_type::node_handle handle = list.extract(35);
+    REQUIRE(handle.value() == 34);
+    REQUIRE(list.count(30) == 4);
+
+    handle.value() = 36;
+    REQUIRE(*list.insert(std::move(handle)).position == 36);
+    REQUIRE(*list.begin() == 36);
+    REQUIRE(*list.insert(list.extract(--list.end())).position == 30);
+    REQUIRE(list.size() == 5);
+    REQUIRE(*list.begin() == 30);
+    REQUIRE(*--list.end() == 31);
+}
+
+TEST_CASE( "multi_skip_list/C++11/transparent lookups cover the run", "" )
+{
+    multi_skip_list<CountedString, CountedStringLess> list;
+    const char *names[] = { "b", "a", "b", "c", "b" };
+    for (unsigned n = 0; n < 5; ++n) list.insert(names[n]);
+
+    CountedString::constructions = 0;
+
+    REQUIRE(list.count("b") == 3);
+    REQUIRE(list.count("d") == 0);
+    const long distance = std::distance(list.equal_range("b").first, list.equal_range("b").second);
+    REQUIRE(distance == 3);
+    REQUIRE(list.erase("b") == 3);
+    REQUIRE(list.erase("b") == 0);
+    REQUIRE(CountedString::constructions == 0);
+
+    list.erase(list.begin());
+    REQUIRE(list.size() == 1);
+    REQUIRE(list.front().text == "c");
+}
+
+#endif
+
+TEST_CASE( "multi_skip_list/finger/finds the first of repeated values", "" )
+{
+    multi_skip_list<int> list;
+    multi_skip_list<int>::finger f;
+    for (int n = 0; n < 300; ++n) list.insert(f, n/3);
+
+    for (int n = 0; n < 100; ++n)
+    {
+        multi_skip_list<int>::iterator i = list.find(n, f);
+        REQUIRE(i == list.lower_bound(n));
+        REQUIRE(std::distance(list.begin(), i) == n*3);
+    }
+}
+
+TEST_CASE( "multi_skip_list/find_sorted_batch/finds the first of repeated values", "" )
+{
+    multi_skip_list<int> list;
+    for (int n = 0; n < 300; ++n) list.insert(n/3);
+
+    std::vector<int> values;
+    for (int n = -1; n < 102; ++n) values.push_back(n);
+
+    std::vector<multi_skip_list<int>::iterator> found;
+    list.find_sorted_batch(values.begin(), values.end(), std::back_inserter(found));
+    REQUIRE(found.size() == values.size());
+    REQUIRE(found.front() == list.end());
+    REQUIRE(found.back() == list.end());
+    for (int n = 0; n < 100; ++n)
+    {
+        REQUIRE(found[n+1] == list.lower_bound(n));
+    }
+}
+
+TEST_CASE( "multi_skip_list/sorted batches/keep and erase repeated values", "" )
+{
+    multi_skip_list<int> list;
+    std::multiset<int>   expected;
+    for (int n = 0; n < 300; ++n) { list.insert(n/3); expected.insert(n/3); }
+
+    std::vector<int> values;
+    for (int n = 0; n < 300; ++n) values.push_back(n/2);
+    REQUIRE(list.insert_sorted_batch(values.begin(), values.end()) == values.size());
+    expected.insert(values.begin(), values.end());
+    REQUIRE(CheckEquality(list, expected));
+
+    std::vector<int> doomed;
+    for (int n = 0; n < 200; n += 7) doomed.push_back(n);
+    doomed.push_back(doomed.back()); // a repeat finds nothing left to erase
+
+    size_t erased = 0;
+    for (size_t n = 0; n < doomed.size(); ++n) erased += expected.erase(doomed[n]);
+    REQUIRE(list.erase_sorted_batch(doomed.begin(), doomed.end()) == erased);
+    REQUIRE(CheckEquality(list, expected));
+}
+
+//============================================================================
+// merge
+
+TEST_CASE( "multi_skip_list/merge/keeps repeated values in order", "" )
+{
+    typedef multi_skip_list<int, TensLess> list_type;
+    list_type list, other;
+    for (int n = 0; n < 30; ++n) list.insert((n/3)*10);
+    for (int n = 0; n < 40; ++n) other.insert((n/4)*10 + n%4 + 1);
+
+    const std::vector<int> others(other.begin(), other.end());
+
+    list.merge(other);
+    REQUIRE(other.empty());
+    REQUIRE(list.size() == 70u);
+
+    // this list's equivalents first, then other's in their order
+    list_type::const_iterator i = list.begin();
+    for (int key = 0; key < 10; ++key)
+    {
+        for (int n = 0; n < 3; ++n, ++i)
+        {
+            REQUIRE(*i == key*10);
+        }
+        for (int n = 0; n < 4; ++n, ++i)
+        {
+            REQUIRE(*i == others[key*4 + n]);
+        }
+    }
+
+    list_type tail = list.extract(list.lower_bound(50), list.end());
+    REQUIRE(list.size() == 35u);
+    REQUIRE(tail.size() == 35u);
+    REQUIRE(*tail.begin() == 50);
+}
+
+TEST_CASE( "multi_skip_list/splice from the middle of a run of equivalents", "" )
+{
+    typedef multi_skip_list<int, TensLess> list_type;
+    list_type list, other;
+    for (int n = 0; n < 100; ++n) other.insert(n);
+    const std::vector<int> values(other.begin(), other.end());
+
+    // positions 52..57 sit among the ten equivalents at 50..59
+    list_type::const_iterator first = other.begin(), last;
+    std::advance(first, 52);
+    last = first;
+    std::advance(last, 6);
+    list.splice(other, first, last);
+
+    REQUIRE(CheckEquality(list, std::vector<int>(values.begin()+52, values.begin()+58)));
+    std::vector<int> rest(values.begin(), values.begin()+52);
+    rest.insert(rest.end(), values.begin()+58, values.end());
+    REQUIRE(CheckEquality(other, rest));
+
+    list_type back = other.extract(other.lower_bound(values[50]), other.end());
+    REQUIRE(CheckEquality(back, std::vector<int>(rest.begin()+50, rest.end())));
+    REQUIRE(CheckEquality(other, std::vector<int>(rest.begin(), rest.begin()+50)));
+}
+
 //============================================================================
 // son of the mother of all tests
 
@@ -9,6 +9,10 @@
 #include "catch.hpp"
 #include "test_types.h"
 
+#include <iterator>
+#include <sstream>
+#include <vector>
+
 using goodliffe::random_access_skip_list;
 
 TEST_CASE( "random_access_skip_list/smoketest", "" )
@@ -338,6 +342,84 @@ TEST_CASE( "random_access_skip_list/iterators/subtraction", "" )
     REQUIRE(((clist.begin()+5)-(clist.begin()+2)) == 3)
 }
 
+TEST_CASE( "random_access_skip_list/iterators/arithmetic agrees with indexes", "" )
+{
+    random_access_skip_list<int> list;
+    for (int n = 0; n < 500; ++n) list.insert(n*2);
+
+    typedef random_access_skip_list<int>::iterator iterator;
+    for (int from = 0; from < 500; from += 7)
+    {
+        for (int to = 0; to <= 500; to += 13)
+        {
+            iterator i = list.iterator_at(unsigned(from));
+            iterator j = i + (to-from);
+            if (to < 500)
+            {
+                REQUIRE(*j == to*2);
+            }
+            else
+            {
+                REQUIRE(j == list.end());
+            }
+            REQUIRE((j-i) == (to-from));
+            REQUIRE((i < j) == (from < to));
+        }
+    }
+}
+
+TEST_CASE( "random_access_skip_list/iterators/indexes follow changes to the list", "" )
+{
+    random_access_skip_list<int> list;
+    for (int n = 0; n < 100; ++n) list.insert(n*2);
+
+    random_access_skip_list<int>::iterator i = list.begin() + 50;
+    random_access_skip_list<int>::const_iterator ci = i;
+    REQUIRE(list.index_of(i) == 50);
+
+    list.insert(-1);
+    REQUIRE(list.index_of(i) == 51);
+    REQUIRE((ci - list.cbegin()) == 51);
+
+    list.erase(list.begin(), list.begin()+11);
+    REQUIRE(list.index_of(i) == 40);
+    REQUIRE(*(i-40) == 20);
+    REQUIRE(*(ci+1) == 102);
+    REQUIRE((list.cend() - ci) == 50);
+}
+
+namespace
+{
+    struct CountingLess
+    {
+        static unsigned comparisons;
+        bool operator()(int lhs, int rhs) const { ++comparisons; return lhs < rhs; }
+    };
+
+    unsigned CountingLess::comparisons = 0;
+}
+
+TEST_CASE( "random_access_skip_list/iterators/arithmetic makes no comparisons", "" )
+{
+    typedef random_access_skip_list<int,CountingLess> list_type;
+    list_type list;
+    for (int n = 0; n < 1000; ++n) list.insert(n);
+
+    list_type::iterator i = list.begin();
+    i += 10;
+    list.insert(1000); // forget any cached indexes
+
+    CountingLess::comparisons = 0;
+    list_type::iterator j = i + 500;
+    j -= 250;
+    REQUIRE(*j == 260);
+    REQUIRE((j - i) == 250);
+    REQUIRE(i < j);
+    REQUIRE(std::distance(list.begin(), list.end()) == 1001);
+    REQUIRE(list.index_of(j) == 260);
+    REQUIRE(CountingLess::comparisons == 0);
+}
+
 //============================================================================
 #pragma mark erase_at
 
@@ -491,5 +573,237 @@ TEST_CASE( "random_access_skip_list/index_of", "" )
 }
 
 //============================================================================
-// TODO: allocation test
+#pragma mark find_batch
+
+TEST_CASE( "random_access_skip_list/find_batch/agrees with find and indexes", "" )
+{
+    // big enough (past rasl_impl::batch_threshold) that searches interleave
+    std::vector<int> evens;
+    for (int n = 0; n < 20000; ++n) evens.push_back(n*2);
+    random_access_skip_list<int> list(evens.begin(), evens.end());
+
+    std::vector<int> values;
+    for (int n = 1001; n >= -1; --n) values.push_back((n * 7919) % 40003 - 1);
+
+    std::vector<random_access_skip_list<int>::iterator> found(values.size());
+    list.find_batch(values.begin(), values.end(), found.begin());
+    for (size_t n = 0; n < values.size(); ++n)
+    {
+        REQUIRE(found[n] == list.find(values[n]));
+        if (found[n] != list.end())
+        {
+            const int index = values[n]/2;
+            REQUIRE(list.index_of(found[n]) == unsigned(index));
+        }
+    }
+}
+
+//============================================================================
+#pragma mark sorted batches
+
+TEST_CASE( "random_access_skip_list/insert_sorted_batch/maintains indexes", "" )
+{
+    std::vector<int> data;
+    for (int n = 0; n < 2000; n += 2) data.push_back(n);
+    random_access_skip_list<int> list(data.begin(), data.end());
+
+    std::vector<int> batch;
+    for (int n = 0; n < 1000; ++n) batch.push_back(rand() % 2500 - 100); // with repeats
+    std::sort(batch.begin(), batch.end());
+
+    const unsigned inserted = unsigned(list.insert_sorted_batch(batch.begin(), batch.end()));
+    const size_t   before   = data.size();
+    data.insert(data.end(), batch.begin(), batch.end());
+    SortVectorAndRemoveDuplicates(data);
+    REQUIRE(inserted == data.size()-before);
+    REQUIRE(CheckEquality(list, data));
+    REQUIRE(CheckEqualityViaIndexing(list, data));
+
+    // and out of order
+    list.insert_sorted_batch(batch.rbegin(), batch.rend());
+    list.insert(-1000);
+    data.insert(data.begin(), -1000);
+    REQUIRE(CheckEqualityViaIndexing(list, data));
+}
+
+TEST_CASE( "random_access_skip_list/erase_sorted_batch/maintains indexes", "" )
+{
+    std::vector<int> data;
+    FillWithOrderedData(2000, data);
+    random_access_skip_list<int> list(data.begin(), data.end());
+
+    std::vector<int> batch;
+    for (int n = 0; n < 1500; ++n) batch.push_back(rand() % 2500 - 100);
+    std::sort(batch.begin(), batch.end());
+
+    const size_t erased = list.erase_sorted_batch(batch.begin(), batch.end());
+    std::vector<int> remaining;
+    std::set_difference(data.begin(), data.end(), batch.begin(), batch.end(), std::back_inserter(remaining));
+    REQUIRE(erased == data.size()-remaining.size());
+    REQUIRE(CheckEquality(list, remaining));
+    REQUIRE(CheckEqualityViaIndexing(list, remaining));
+
+    REQUIRE(list.erase_sorted_batch(data.begin(), data.end()) == remaining.size());
+    REQUIRE(list.empty());
+    REQUIRE(list.erase_sorted_batch(data.begin(), data.end()) == 0);
+    REQUIRE(list.insert_sorted_batch(data.begin(), data.end()) == data.size());
+    REQUIRE(CheckEqualityViaIndexing(list, data));
+}
+
+TEST_CASE( "random_access_skip_list/rank and count_range", "" )
+{
+    random_access_skip_list<int> list;
+    for (int n = 0; n < 50; ++n) list.insert(n*2);
+
+    REQUIRE(list.rank(0) == 0);
+    REQUIRE(list.rank(7) == 4);
+    REQUIRE(list.rank(8) == 4);
+    REQUIRE(list.rank(1000) == 50);
+    REQUIRE(list[list.rank(40)] == 40);
+    REQUIRE(list.count_range(10, 20) == 5);
+    REQUIRE(list.count_range(11, 21) == 5);
+    REQUIRE(list.count_range(20, 10) == 0);
+    REQUIRE(list.count_range(-10, 1000) == 50);
+}
+
+//============================================================================
+#pragma mark assign_sorted and copying
+
+TEST_CASE( "random_access_skip_list/assign_sorted/maintains indexes", "" )
+{
+    std::vector<int> data;
+    for (int n = 0; n < 1000; ++n) data.push_back(rand() % 500); // with repeats
+    std::sort(data.begin(), data.end());
+
+    random_access_skip_list<int> list;
+    list.insert(7);
+    list.assign_sorted(data.begin(), data.end());
+
+    SortVectorAndRemoveDuplicates(data);
+    REQUIRE(CheckEquality(list, data));
+    REQUIRE(CheckEqualityViaIndexing(list, data));
+
+    for (unsigned n = 0; n < 100; ++n)
+    {
+        unsigned index = unsigned(rand()) % unsigned(list.size());
+        list.erase_at(index);
+        data.erase(data.begin()+index);
+    }
+    list.insert(1000);
+    data.push_back(1000);
+    REQUIRE(CheckEqualityViaIndexing(list, data));
+}
+
+TEST_CASE( "random_access_skip_list/copy maintains indexes", "" )
+{
+    std::vector<int> data;
+    FillWithOrderedData(300, data);
+    random_access_skip_list<int> source(data.begin(), data.end());
+
+    random_access_skip_list<int> copy(source);
+    REQUIRE(CheckEqualityViaIndexing(copy, data));
+    REQUIRE(copy.index_of(copy.find(150)) == 150);
+
+    random_access_skip_list<int> assignee;
+    assignee.insert(-1);
+    assignee = source;
+    REQUIRE(CheckEqualityViaIndexing(assignee, data));
+    REQUIRE(assignee.index_of(assignee.end()) == 300);
+}
+
+//============================================================================
+#pragma mark C++11 operations
+
+#if SKIP_LIST_CPP11
 
+TEST_CASE( "random_access_skip_list/C++11/emplace and rvalue insert maintain indexes", "" )
+{
+    random_access_skip_list<CopyCounter> list;
+    CopyCounter::reset();
+
+    for (int n = 0; n < 100; n += 2) list.emplace(n, "even");
+    for (int n = 1; n < 100; n += 2) list.insert(CopyCounter(n, "odd"));
+    REQUIRE(!list.emplace(50, "again").second);
+    REQUIRE(CopyCounter::copies == 0);
+
+    REQUIRE(list.size() == 100);
+    for (unsigned n = 0; n < 100; ++n)
+    {
+        REQUIRE(list[n].value == int(n));
+    }
+    REQUIRE(list[50].payload == "even");
+}
+
+TEST_CASE( "random_access_skip_list/C++11/move", "" )
+{
+    random_access_skip_list<int> source = { 5, 4, 3, 2, 1 };
+
+    random_access_skip_list<int> moved(std::move(source));
+    REQUIRE(moved.size() == 5);
+    REQUIRE(moved[2] == 3);
+    REQUIRE(source.empty());
+
+    source = std::move(moved);
+    REQUIRE(source[4] == 5);
+    REQUIRE(moved.empty());
+}
+
+#endif
+
+//============================================================================
+#pragma mark allocations
+
+TEST_CASE( "random_access_skip_list/allocation/one allocation per inserted item", "" )
+{
+    typedef random_access_skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    AllocationCounter::reset();
+    {
+        list_type list;
+        const int baseline = AllocationCounter::allocations; // head and tail
+
+        for (int n = 0; n < 100; ++n) list.insert(n);
+        REQUIRE(AllocationCounter::allocations == baseline+100);
+
+        for (unsigned n = 0; n < 50; ++n) list.erase_at(0);
+        REQUIRE(AllocationCounter::blocks == baseline+50);
+        REQUIRE(CheckEqualityViaIndexing(list, std::vector<int>(list.begin(), list.end())));
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "random_access_skip_list/allocation/duplicate insert leaves the height alone", "" )
+{
+    typedef random_access_skip_list<int,std::less<int>,std::allocator<int>,TallLevelGenerator> list_type;
+
+    list_type list;
+    for (int n = 0; n < 5; ++n) list.insert(n);
+
+    std::ostringstream before;
+    list.dump(before);
+    REQUIRE(DumpHeader(list) == "skip_list(size=5,levels=5)");
+
+    for (int n = 0; n < 5; ++n)
+    {
+        REQUIRE(!list.insert(n).second);
+        REQUIRE(*list.insert(list.end(), n) == n);
+#if SKIP_LIST_CPP11
+        REQUIRE(!list.insert(int(n)).second);
+        REQUIRE(!list.emplace(n).second);
+        REQUIRE(*list.emplace_hint(list.end(), n) == n);
+#endif
+    }
+    const int values[] = { 0, 1, 2, 3, 4 };
+    list.insert_sorted_batch(values, values+5);
+
+    std::ostringstream after;
+    list.dump(after);
+    REQUIRE(after.str() == before.str());
+    REQUIRE(CheckEqualityViaIndexing(list, std::vector<int>(values, values+5)));
+
+#if SKIP_LIST_CPP11
+    REQUIRE(list.emplace(5).second);
+    REQUIRE(DumpHeader(list) == "skip_list(size=6,levels=6)");
+    REQUIRE(CheckEqualityViaIndexing(list, std::vector<int>(list.begin(), list.end())));
+#endif
+}
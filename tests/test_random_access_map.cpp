@@ -0,0 +1,184 @@
+//============================================================================
+// test_random_access_map.cpp
+// Copyright (c) 2011 Pete Goodliffe. All rights reserved
+//============================================================================
+
+#include "random_access_skip_list_map.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION 1
+#include "catch.hpp"
+#include "test_types.h"
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+using goodliffe::random_access_skip_list_map;
+
+TEST_CASE( "random_access_skip_list_map/is constructable", "" )
+{
+    random_access_skip_list_map<int, int>         map_int;
+    random_access_skip_list_map<std::string, int> map_string;
+
+    REQUIRE(map_int.empty());
+    REQUIRE(map_string.size() == 0);
+    REQUIRE(map_int.begin() == map_int.end());
+    REQUIRE(map_int.rank(10) == 0);
+    REQUIRE(map_int.count_range(0, 10) == 0);
+}
+
+TEST_CASE( "random_access_skip_list_map/insert and find", "" )
+{
+    random_access_skip_list_map<int, std::string> map;
+
+    REQUIRE(map.insert(std::make_pair(20, std::string("twenty"))).second);
+    REQUIRE(map.insert(std::make_pair(10, std::string("ten"))).second);
+    REQUIRE(!map.insert(std::make_pair(10, std::string("TEN"))).second);
+
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.contains(10));
+    REQUIRE(map.count(20) == 1);
+    REQUIRE(map.count(30) == 0);
+    REQUIRE(map.find(10)->second == "ten");
+    REQUIRE(map.find(15) == map.end());
+    REQUIRE(map.front().first == 10);
+    REQUIRE(map.back().first == 20);
+}
+
+TEST_CASE( "random_access_skip_list_map/mapped values are writable through iterators", "" )
+{
+    random_access_skip_list_map<int, int> map;
+    for (int n = 0; n < 10; ++n) map.insert(std::make_pair(n, 0));
+
+    for (random_access_skip_list_map<int, int>::iterator i = map.begin(); i != map.end(); ++i)
+        i->second = i->first * 2;
+    map.nth(3).second = 100;
+    map.find(4)->second = 200;
+
+    REQUIRE(map.find(2)->second == 4);
+    REQUIRE(map.nth(3).second == 100);
+    REQUIRE(map.find(4)->second == 200);
+    REQUIRE(map.iterator_at(9)->second == 18);
+}
+
+//============================================================================
+// order statistics
+
+TEST_CASE( "random_access_skip_list_map/rank, nth and count_range match std::map", "" )
+{
+    random_access_skip_list_map<int, int> map;
+    std::map<int, int>                    expected;
+
+    std::srand(1234);
+    for (int n = 0; n < 500; ++n)
+    {
+        const int key = std::rand() % 2000;
+        map.insert(std::make_pair(key, n));
+        expected.insert(std::make_pair(key, n));
+    }
+    REQUIRE(map.size() == expected.size());
+
+    std::size_t index = 0;
+    for (std::map<int, int>::const_iterator i = expected.begin(); i != expected.end(); ++i, ++index)
+    {
+        REQUIRE(map.nth(index).first == i->first);
+        REQUIRE(map.nth(index).second == i->second);
+        REQUIRE(map.rank(i->first) == index);
+    }
+
+    for (int n = 0; n < 200; ++n)
+    {
+        const int lo = std::rand() % 2100;
+        const int hi = std::rand() % 2100;
+        const std::size_t count = lo < hi
+            ? std::distance(expected.lower_bound(lo), expected.lower_bound(hi)) : 0;
+        REQUIRE(map.count_range(lo, hi) == count);
+
+        const std::size_t rank = std::distance(expected.begin(), expected.lower_bound(lo));
+        REQUIRE(map.rank(lo) == rank);
+    }
+}
+
+TEST_CASE( "random_access_skip_list_map/bounds carry their index", "" )
+{
+    random_access_skip_list_map<int, int> map;
+    for (int n = 0; n < 20; ++n) map.insert(std::make_pair(n*10, n));
+
+    REQUIRE(map.lower_bound(35)->first == 40);
+    REQUIRE(map.index_of(map.lower_bound(35)) == 4);
+    REQUIRE(map.lower_bound(40)->first == 40);
+    REQUIRE(map.upper_bound(40)->first == 50);
+    REQUIRE(map.index_of(map.upper_bound(40)) == 5);
+    REQUIRE(map.upper_bound(190) == map.end());
+    REQUIRE(map.lower_bound(-5) == map.begin());
+}
+
+TEST_CASE( "random_access_skip_list_map/erase keeps ranks", "" )
+{
+    random_access_skip_list_map<int, int> map;
+    for (int n = 0; n < 100; ++n) map.insert(std::make_pair(n, n));
+
+    REQUIRE(map.erase(10) == 1);
+    REQUIRE(map.erase(10) == 0);
+    map.erase_at(0);
+    map.erase(map.lower_bound(50), map.lower_bound(60));
+
+    REQUIRE(map.size() == 88);
+    REQUIRE(map.rank(11) == 9);
+    REQUIRE(map.rank(60) == 48);
+    REQUIRE(map.nth(48).first == 60);
+    REQUIRE(map.count_range(0, 100) == 88);
+    REQUIRE(map.count_range(40, 70) == 20);
+}
+
+TEST_CASE( "random_access_skip_list_map/sorted batches keep ranks", "" )
+{
+    random_access_skip_list_map<int, int> map;
+    std::vector<std::pair<int, int> > items;
+    for (int n = 0; n < 50; ++n) items.push_back(std::make_pair(n*2, n));
+
+    REQUIRE(map.insert_sorted_batch(items.begin(), items.end()) == 50);
+
+    std::vector<int> keys;
+    for (int n = 0; n < 50; n += 5) keys.push_back(n*2);
+    REQUIRE(map.erase_sorted_batch(keys.begin(), keys.end()) == 10);
+
+    REQUIRE(map.size() == 40);
+    REQUIRE(map.rank(98) == 39);
+    REQUIRE(map.nth(0).first == 2);
+    REQUIRE(map.count_range(0, 20) == 8);
+}
+
+TEST_CASE( "random_access_skip_list_map/copy and compare", "" )
+{
+    random_access_skip_list_map<int, int> map;
+    for (int n = 0; n < 30; ++n) map.insert(std::make_pair(n, n*n));
+
+    random_access_skip_list_map<int, int> copy(map);
+    REQUIRE(copy == map);
+    REQUIRE(copy.rank(15) == 15);
+
+    copy.nth(0).second = 1;
+    REQUIRE(copy != map);
+    REQUIRE(map < copy);
+}
+
+#if SKIP_LIST_CPP11
+
+TEST_CASE( "random_access_skip_list_map/C++11/emplace and initializer lists", "" )
+{
+    random_access_skip_list_map<int, std::string> map = { {3, "three"}, {1, "one"} };
+    REQUIRE(map.emplace(2, "two").second);
+    REQUIRE(!map.emplace(2, "deux").second);
+
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.nth(1).second == "two");
+    REQUIRE(map.rank(3) == 2);
+
+    random_access_skip_list_map<int, std::string> moved(std::move(map));
+    REQUIRE(moved.size() == 3);
+    REQUIRE(map.empty());
+}
+
+#endif
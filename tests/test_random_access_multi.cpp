@@ -0,0 +1,222 @@
+//============================================================================
+// test_random_access_multi.cpp
+// Copyright (c) 2011 Pete Goodliffe. All rights reserved
+//============================================================================
+
+#define _SCL_SECURE_NO_WARNINGS
+
+#include "random_access_skip_list.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION 1
+#include "catch.hpp"
+#include "test_types.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+using goodliffe::random_access_multi_skip_list;
+
+namespace
+{
+    /// Orders by tens, so the units can tell equivalent values apart.
+    struct TensLess
+    {
+        bool operator()(int lhs, int rhs) const { return lhs/10 < rhs/10; }
+    };
+
+    template <typename LIST>
+    bool CheckIndexing(const LIST &list, const std::vector<int> &expected)
+    {
+        if (list.size() != expected.size()) return false;
+        for (unsigned n = 0; n < expected.size(); ++n)
+        {
+            if (list[n] != expected[n]) return false;
+            if (list.index_of(list.iterator_at(n)) != n) return false;
+        }
+        return true;
+    }
+}
+
+TEST_CASE( "random_access_multi_skip_list/is constructable", "" )
+{
+    random_access_multi_skip_list<int>    list;
+    random_access_multi_skip_list<Struct> list_struct;
+
+    REQUIRE(list.empty());
+    REQUIRE(list.count(1) == 0);
+    REQUIRE(list.find(1) == list.end());
+    REQUIRE(list.equal_index_range(1).first == 0);
+    REQUIRE(list.equal_index_range(1).second == 0);
+}
+
+TEST_CASE( "random_access_multi_skip_list/repeated values are all held", "" )
+{
+    random_access_multi_skip_list<int> list;
+    for (int n = 0; n < 5; ++n)
+    {
+        REQUIRE(list.insert(3).second);
+        REQUIRE(list.insert(1).second);
+    }
+    list.insert(2);
+
+    REQUIRE(list.size() == 11);
+    REQUIRE(list.count(1) == 5);
+    REQUIRE(list.count(2) == 1);
+    REQUIRE(list.count(3) == 5);
+    REQUIRE(list.count(4) == 0);
+    REQUIRE(list[4] == 1);
+    REQUIRE(list[5] == 2);
+    REQUIRE(list[6] == 3);
+    REQUIRE(list.rank(3) == 6);
+    REQUIRE(list.count_range(1, 3) == 6);
+}
+
+TEST_CASE( "random_access_multi_skip_list/equal_range gives index ranges", "" )
+{
+    random_access_multi_skip_list<int> list;
+    for (int n = 0; n < 10; ++n)
+        for (int m = 0; m <= n; ++m)
+            list.insert(n);
+
+    for (int n = 0; n < 10; ++n)
+    {
+        const random_access_multi_skip_list<int>::index_range range = list.equal_index_range(n);
+        const unsigned first = unsigned(n*(n+1)/2);
+        REQUIRE(range.first == first);
+        REQUIRE(range.second == first + n + 1);
+
+        std::pair<random_access_multi_skip_list<int>::iterator,
+                  random_access_multi_skip_list<int>::iterator> iters = list.equal_range(n);
+        REQUIRE(list.index_of(iters.first) == range.first);
+        REQUIRE(list.index_of(iters.second) == range.second);
+        const long distance = iters.second - iters.first;
+        REQUIRE(distance == n + 1);
+    }
+}
+
+TEST_CASE( "random_access_multi_skip_list/new values go before their equivalents", "" )
+{
+    random_access_multi_skip_list<int, TensLess> list;
+    list.insert(10);
+    list.insert(11);
+    list.insert(12);
+    list.insert(5);
+
+    REQUIRE(list[1] == 12);
+    REQUIRE(list[2] == 11);
+    REQUIRE(list[3] == 10);
+    REQUIRE(*list.find(15) == 12);
+    REQUIRE(list.index_of(list.find(15)) == 1);
+}
+
+//============================================================================
+// spans under removal
+
+TEST_CASE( "random_access_multi_skip_list/erase by value removes the run", "" )
+{
+    random_access_multi_skip_list<int> list;
+    for (int n = 0; n < 300; ++n) list.insert(n % 30);
+
+    REQUIRE(list.erase(7) == 10);
+    REQUIRE(list.erase(7) == 0);
+    REQUIRE(list.size() == 290);
+    REQUIRE(list.count(7) == 0);
+    REQUIRE(list.rank(8) == 70);
+    REQUIRE(list[70] == 8);
+    REQUIRE(list.count(8) == 10);
+}
+
+TEST_CASE( "random_access_multi_skip_list/erase_at within runs keeps the spans", "" )
+{
+    random_access_multi_skip_list<int, TensLess> list;
+    std::vector<int> expected;
+
+    std::srand(42);
+    for (int n = 0; n < 400; ++n)
+    {
+        const int value = std::rand() % 200;
+        list.insert(value);
+    }
+    expected.assign(list.begin(), list.end());
+    REQUIRE(CheckIndexing(list, expected));
+
+    for (int n = 0; n < 150; ++n)
+    {
+        const unsigned index = unsigned(std::rand()) % unsigned(list.size());
+        list.erase_at(index);
+        expected.erase(expected.begin() + index);
+    }
+    REQUIRE(CheckIndexing(list, expected));
+
+    for (int n = 0; n < 20; ++n)
+    {
+        const unsigned first = unsigned(std::rand()) % unsigned(list.size());
+        const unsigned last  = first + unsigned(std::rand()) % unsigned(list.size() - first);
+        list.erase(list.iterator_at(first), list.iterator_at(last));
+        expected.erase(expected.begin() + first, expected.begin() + last);
+    }
+    REQUIRE(CheckIndexing(list, expected));
+}
+
+TEST_CASE( "random_access_multi_skip_list/sorted batches keep repeats", "" )
+{
+    std::vector<int> data;
+    for (int n = 0; n < 200; ++n) data.push_back(n / 4);
+
+    random_access_multi_skip_list<int> list;
+    list.assign_sorted(data.begin(), data.end());
+    REQUIRE(CheckIndexing(list, data));
+
+    REQUIRE(list.insert_sorted_batch(data.begin(), data.begin() + 20) == 20);
+    REQUIRE(list.count(0) == 8);
+    REQUIRE(list.count(5) == 4);
+
+    std::vector<int> keys(3, 2);
+    REQUIRE(list.erase_sorted_batch(keys.begin(), keys.end()) == 3);
+    REQUIRE(list.count(2) == 5);
+    REQUIRE(list.size() == 217);
+
+    random_access_multi_skip_list<int> copy(list);
+    REQUIRE(copy == list);
+    REQUIRE(copy.count(0) == 8);
+}
+
+TEST_CASE( "random_access_multi_skip_list/find_batch agrees with find on repeats", "" )
+{
+    random_access_multi_skip_list<int> small;
+    const int values[] = { 1, 5, 5, 5, 9 };
+    small.assign_sorted(values, values+5);
+
+    const int probes[] = { 0, 1, 5, 7, 9, 10 };
+    std::vector<random_access_multi_skip_list<int>::iterator> found;
+    small.find_batch(probes, probes+6, std::back_inserter(found));
+    REQUIRE(found.size() == 6u);
+    for (unsigned n = 0; n < 6; ++n)
+    {
+        REQUIRE(found[n] == small.find(probes[n]));
+    }
+    REQUIRE(small.index_of(found[2]) == 1u);
+
+    // big enough (past rasl_impl::batch_threshold) that searches interleave
+    std::vector<int> data;
+    for (int n = 0; n < 40000; ++n) data.push_back(n / 3);
+    random_access_multi_skip_list<int> big;
+    big.assign_sorted(data.begin(), data.end());
+
+    std::vector<int> keys;
+    for (int n = -10; n < 1010; ++n) keys.push_back((n * 7919) % 13350);
+
+    const random_access_multi_skip_list<int> &cbig = big;
+    std::vector<random_access_multi_skip_list<int>::const_iterator> cfound(keys.size());
+    REQUIRE(cbig.find_batch(keys.begin(), keys.end(), cfound.begin()) == cfound.end());
+    for (size_t n = 0; n < keys.size(); ++n)
+    {
+        REQUIRE(cfound[n] == cbig.find(keys[n]));
+        if (cfound[n] != cbig.end())
+        {
+            REQUIRE(cbig.index_of(cfound[n]) == size_t(keys[n])*3);
+        }
+    }
+}
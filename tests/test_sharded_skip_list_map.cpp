@@ -0,0 +1,239 @@
+//============================================================================
+// test_sharded_skip_list_map.cpp
+//============================================================================
+
+#include "sharded_skip_list_map.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION 1
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using goodliffe::sharded_skip_list_map;
+
+namespace
+{
+    typedef sharded_skip_list_map<int, int> Map;
+
+    std::vector<int> Boundaries(int first, int second)
+    {
+        std::vector<int> boundaries;
+        boundaries.push_back(first);
+        boundaries.push_back(second);
+        return boundaries;
+    }
+
+    struct CollectKeys
+    {
+        std::vector<int> *keys;
+        void operator()(const std::pair<const int, int> &value) const { keys->push_back(value.first); }
+    };
+
+    std::vector<int> KeysOf(const Map &map)
+    {
+        std::vector<int> keys;
+        CollectKeys collect = { &keys };
+        map.for_each(collect);
+        return keys;
+    }
+
+    bool IsStrictlyIncreasing(const std::vector<int> &values)
+    {
+        for (size_t n = 1; n < values.size(); ++n)
+        {
+            if (!(values[n-1] < values[n])) return false;
+        }
+        return true;
+    }
+
+    const unsigned num_threads = 4;
+}
+
+TEST_CASE( "sharded_skip_list_map/smoketest", "" )
+{
+    Map map(Boundaries(100, 200));
+    REQUIRE(map.empty());
+    REQUIRE(map.shard_count() == 3);
+    REQUIRE(map.boundaries() == Boundaries(100, 200));
+    REQUIRE_FALSE(map.contains(10));
+}
+
+TEST_CASE( "sharded_skip_list_map/insert, find and erase across shards", "" )
+{
+    Map map(Boundaries(100, 200));
+    REQUIRE(map.insert(std::make_pair(250, 2500)));
+    REQUIRE(map.insert(std::make_pair(50, 500)));
+    REQUIRE(map.insert(std::make_pair(100, 1000)));
+    REQUIRE(map.insert(std::make_pair(199, 1990)));
+    REQUIRE(map.insert(std::make_pair(-5, -50)));
+    REQUIRE_FALSE(map.insert(std::make_pair(100, 0)));
+    REQUIRE(map.size() == 5);
+
+    int value = 0;
+    REQUIRE(map.find(100, value));
+    REQUIRE(value == 1000);
+    REQUIRE(map.find(-5, value));
+    REQUIRE(value == -50);
+    REQUIRE_FALSE(map.find(101, value));
+    REQUIRE(value == -50);
+    REQUIRE(map.count(250) == 1);
+
+    std::vector<int> keys = KeysOf(map);
+    REQUIRE(keys.size() == 5);
+    REQUIRE(keys[0] == -5);
+    REQUIRE(keys[1] == 50);
+    REQUIRE(keys[2] == 100);
+    REQUIRE(keys[3] == 199);
+    REQUIRE(keys[4] == 250);
+
+    REQUIRE(map.erase(199) == 1);
+    REQUIRE(map.erase(199) == 0);
+    REQUIRE_FALSE(map.contains(199));
+    REQUIRE(map.size() == 4);
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(KeysOf(map).empty());
+}
+
+TEST_CASE( "sharded_skip_list_map/rebalance/moves keys from a hot shard", "" )
+{
+    Map map(Boundaries(100, 200));
+    for (int key = 0; key < 300; ++key) map.insert(std::make_pair(key, key*10));
+
+    for (int repeat = 0; repeat < 10; ++repeat)
+    {
+        for (int key = 0; key < 100; ++key) map.contains(key);
+    }
+    REQUIRE(map.rebalance());
+
+    // shard 0 was busiest, and gave some of its top keys to shard 1
+    std::vector<int> boundaries = map.boundaries();
+    REQUIRE(boundaries[0] < 100);
+    REQUIRE(boundaries[0] > 0);
+    REQUIRE(boundaries[1] == 200);
+
+    std::vector<int> keys = KeysOf(map);
+    REQUIRE(keys.size() == 300);
+    for (int key = 0; key < 300; ++key)
+    {
+        REQUIRE(keys[key] == key);
+        int value = 0;
+        REQUIRE(map.find(key, value));
+        REQUIRE(value == key*10);
+    }
+
+    // and keys either side of the new boundary still go to the right place
+    REQUIRE(map.erase(boundaries[0]) == 1);
+    REQUIRE(map.erase(boundaries[0]-1) == 1);
+    REQUIRE(map.insert(std::make_pair(boundaries[0], 0)));
+    REQUIRE(map.size() == 299);
+    REQUIRE(IsStrictlyIncreasing(KeysOf(map)));
+}
+
+TEST_CASE( "sharded_skip_list_map/rebalance/can move a boundary down", "" )
+{
+    Map map(Boundaries(100, 200));
+    for (int key = 0; key < 300; ++key) map.insert(std::make_pair(key, key));
+
+    // the last shard is hot, and gives its bottom keys to the middle one
+    for (int repeat = 0; repeat < 5; ++repeat)
+    {
+        for (int key = 200; key < 300; ++key) map.contains(key);
+    }
+    REQUIRE(map.rebalance());
+    std::vector<int> boundaries = map.boundaries();
+    REQUIRE(boundaries[0] == 100);
+    REQUIRE(boundaries[1] > 200);
+    REQUIRE(KeysOf(map).size() == 300);
+}
+
+TEST_CASE( "sharded_skip_list_map/rebalance/nothing moves when the load is even", "" )
+{
+    Map map(Boundaries(100, 200));
+    for (int key = 0; key < 300; ++key) map.insert(std::make_pair(key, key));
+    REQUIRE_FALSE(map.rebalance());
+    REQUIRE(map.boundaries() == Boundaries(100, 200));
+}
+
+TEST_CASE( "sharded_skip_list_map/rebalance/happens by itself", "" )
+{
+    Map map(Boundaries(100, 200));
+    for (int key = 0; key < 300; ++key) map.insert(std::make_pair(key, key));
+
+    for (unsigned long n = 0; n < Map::rebalance_interval; ++n) map.contains(int(n % 100));
+    REQUIRE(map.boundaries()[0] < 100);
+    REQUIRE(KeysOf(map).size() == 300);
+}
+
+//============================================================================
+// multi threaded
+
+namespace
+{
+    /// Mostly works on the bottom shard, so it gets hot.
+    void SkewedChurn(Map *map, unsigned seed, long *net_inserts)
+    {
+        unsigned state = seed*2654435761u + 1;
+        long net = 0;
+        for (unsigned n = 0; n < 50000; ++n)
+        {
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            const int key = (state & 0x3) ? int(state % 100) : int(state % 300);
+            if (state & 0x100)
+            {
+                if (map->insert(std::make_pair(key, key))) ++net;
+            }
+            else
+            {
+                net -= long(map->erase(key));
+            }
+        }
+        *net_inserts = net;
+    }
+
+    void ReadAndRebalance(Map *map, const std::atomic<bool> *stop, bool *ok)
+    {
+        while (!*stop)
+        {
+            if (!IsStrictlyIncreasing(KeysOf(*map))) *ok = false;
+            map->rebalance();
+        }
+    }
+}
+
+TEST_CASE( "sharded_skip_list_map/threads/writes while boundaries move", "" )
+{
+    Map map(Boundaries(100, 200));
+
+    std::atomic<bool> stop(false);
+    bool              ok = true;
+    std::thread reader(&ReadAndRebalance, &map, &stop, &ok);
+
+    std::vector<long>        net(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+        threads.push_back(std::thread(&SkewedChurn, &map, t+1, &net[t]));
+    }
+    for (unsigned t = 0; t < num_threads; ++t) threads[t].join();
+    stop = true;
+    reader.join();
+
+    REQUIRE(ok);
+
+    long total = 0;
+    for (unsigned t = 0; t < num_threads; ++t) total += net[t];
+
+    std::vector<int> keys = KeysOf(map);
+    REQUIRE(long(map.size()) == total);
+    REQUIRE(long(keys.size()) == total);
+    REQUIRE(IsStrictlyIncreasing(keys));
+    for (int key = 0; key < 300; ++key)
+    {
+        REQUIRE(map.contains(key) == std::binary_search(keys.begin(), keys.end(), key));
+    }
+}
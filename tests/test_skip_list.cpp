@@ -15,6 +15,13 @@
 #include "catch.hpp"
 #include "test_types.h"
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+
 using goodliffe::skip_list;
 using goodliffe::detail::sl_impl;
 
@@ -270,7 +277,7 @@ TEST_CASE( "skip_list/can't insert same item twice", "" )
 
     skip_list<int>::insert_by_value_result r = list.insert(10);
     REQUIRE(!r.second);
-    REQUIRE(r.first == list.end());
+    REQUIRE(r.first == list.begin());
     REQUIRE(list.size() == 1);
     
     skip_list<int>::iterator i = list.begin();
@@ -661,6 +668,536 @@ TEST_CASE( "skip_list/insert-hint/good", "" )
     REQUIRE(*i == 25);
 }
 
+//============================================================================
+// fingers
+
+namespace
+{
+    struct CountingLess
+    {
+        static unsigned comparisons;
+        bool operator()(int lhs, int rhs) const { ++comparisons; return lhs < rhs; }
+    };
+
+    unsigned CountingLess::comparisons = 0;
+}
+
+TEST_CASE( "skip_list/finger/find matches find", "" )
+{
+    std::vector<int> data;
+    FillWithRandomData(1000, data);
+    skip_list<int> list(data.begin(), data.end());
+
+    skip_list<int>::finger f;
+    for (unsigned n = 0; n < 2000; ++n)
+    {
+        const int value = n % 2 ? data[n % data.size()] : rand();
+        REQUIRE(list.find(value, f) == list.find(value));
+        REQUIRE(list.lower_bound(value, f) == list.lower_bound(value));
+    }
+}
+
+TEST_CASE( "skip_list/finger/survives inserts and erases", "" )
+{
+    skip_list<int> list;
+    for (int n = 0; n < 100; n += 2) list.insert(n);
+
+    skip_list<int>::finger f;
+    REQUIRE(*list.find(50, f) == 50);
+
+    list.insert(49);
+    list.insert(51);
+    REQUIRE(*list.lower_bound(49, f) == 49);
+    REQUIRE(*list.find(51, f) == 51);
+
+    list.erase(48);
+    list.erase(52);
+    REQUIRE(list.find(48, f) == list.end());
+    REQUIRE(*list.lower_bound(52, f) == 54);
+    REQUIRE(*list.find(10, f) == 10);
+
+    list.clear();
+    REQUIRE(list.find(10, f) == list.end());
+}
+
+TEST_CASE( "skip_list/finger/ordered inserts", "" )
+{
+    skip_list<int> list;
+    skip_list<int>::finger f;
+    std::set<int> set;
+
+    for (int n = 0; n < 1000; ++n)
+    {
+        const int value = n*3 - rand()%10; // nearly sorted
+        REQUIRE(list.insert(f, value).second == set.insert(value).second);
+    }
+    REQUIRE(CheckEquality(list, set));
+}
+
+TEST_CASE( "skip_list/finger/nearby searches are cheap", "" )
+{
+    typedef skip_list<int,CountingLess> list_type;
+
+    std::vector<int> data;
+    FillWithOrderedData(10000, data);
+    list_type list;
+    list.assign_sorted(data.begin(), data.end());
+
+    CountingLess::comparisons = 0;
+    for (int n = 0; n < 10000; ++n) list.find(n);
+    const unsigned without_finger = CountingLess::comparisons;
+
+    list_type::finger f;
+    CountingLess::comparisons = 0;
+    for (int n = 0; n < 10000; ++n)
+    {
+        REQUIRE(*list.find(n, f) == n);
+    }
+    const unsigned with_finger = CountingLess::comparisons;
+
+    const unsigned with_finger_x3 = with_finger*3;
+    REQUIRE(with_finger_x3 < without_finger);
+}
+
+//============================================================================
+// find_batch
+
+TEST_CASE( "skip_list/find_batch/agrees with find", "" )
+{
+    // big enough (past sl_impl::batch_threshold) that searches interleave
+    std::vector<int> evens;
+    for (int n = 0; n < 40000; n += 2) evens.push_back(n);
+    skip_list<int> list(evens.begin(), evens.end());
+
+    // more than one batch, out of order, with misses and values past each end
+    std::vector<int> values;
+    for (int n = -10; n < 1010; ++n) values.push_back((n * 7919) % 40020 - 10);
+
+    std::vector<skip_list<int>::iterator> found;
+    list.find_batch(values.begin(), values.end(), std::back_inserter(found));
+    REQUIRE(found.size() == values.size());
+    for (size_t n = 0; n < values.size(); ++n)
+    {
+        REQUIRE(found[n] == list.find(values[n]));
+    }
+
+    const skip_list<int> &clist = list;
+    std::vector<skip_list<int>::const_iterator> cfound(values.size());
+    REQUIRE(clist.find_batch(values.begin(), values.end(), cfound.begin()) == cfound.end());
+    for (size_t n = 0; n < values.size(); ++n)
+    {
+        REQUIRE(cfound[n] == clist.find(values[n]));
+    }
+}
+
+TEST_CASE( "skip_list/find_batch/empty list or no values", "" )
+{
+    skip_list<int> list;
+    std::vector<int> values(20, 5);
+    std::vector<skip_list<int>::iterator> found;
+    list.find_batch(values.begin(), values.end(), std::back_inserter(found));
+    REQUIRE(found.size() == 20);
+    REQUIRE(found[0] == list.end());
+    REQUIRE(found[19] == list.end());
+
+    list.insert(5);
+    found.clear();
+    list.find_batch(values.begin(), values.begin(), std::back_inserter(found));
+    REQUIRE(found.empty());
+}
+
+//============================================================================
+// find_sorted_batch
+
+TEST_CASE( "skip_list/find_sorted_batch/agrees with find and lower_bound", "" )
+{
+    skip_list<int> list;
+    for (int n = 0; n < 2000; n += 2) list.insert(n);
+
+    std::vector<int> values;
+    for (int n = -5; n < 2005; n += 3) values.push_back(n);
+
+    std::vector<skip_list<int>::iterator> found, bounds;
+    list.find_sorted_batch(values.begin(), values.end(), std::back_inserter(found));
+    list.lower_bound_sorted_batch(values.begin(), values.end(), std::back_inserter(bounds));
+    REQUIRE(found.size() == values.size());
+    REQUIRE(bounds.size() == values.size());
+    for (size_t n = 0; n < values.size(); ++n)
+    {
+        REQUIRE(found[n] == list.find(values[n]));
+        REQUIRE(bounds[n] == list.lower_bound(values[n]));
+    }
+
+    // out of order still works
+    const skip_list<int> &clist = list;
+    std::vector<skip_list<int>::const_iterator> reversed;
+    clist.find_sorted_batch(values.rbegin(), values.rend(), std::back_inserter(reversed));
+    REQUIRE(reversed.size() == values.size());
+    REQUIRE(reversed.front() == clist.find(values.back()));
+    REQUIRE(reversed.back() == clist.find(values.front()));
+}
+
+TEST_CASE( "skip_list/find_sorted_batch/sorted probes are cheap", "" )
+{
+    typedef skip_list<int,CountingLess> list_type;
+    list_type list;
+    for (int n = 0; n < 20000; n += 2) list.insert(list.end(), n);
+
+    std::vector<int> values;
+    for (int n = 0; n < 20000; n += 2) values.push_back(n);
+
+    std::vector<list_type::iterator> found;
+    CountingLess::comparisons = 0;
+    for (size_t n = 0; n < values.size(); ++n) found.push_back(list.find(values[n]));
+    const unsigned singly = CountingLess::comparisons;
+
+    std::vector<list_type::iterator> batched;
+    CountingLess::comparisons = 0;
+    list.find_sorted_batch(values.begin(), values.end(), std::back_inserter(batched));
+    const unsigned sorted = CountingLess::comparisons;
+
+    REQUIRE(batched == found);
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    // neighbouring probes cost a constant each, rather than log n
+    REQUIRE(sorted < 80000u);
+    REQUIRE(singly > sorted*4);
+#endif
+}
+
+TEST_CASE( "skip_list/insert_sorted_batch/merges into the list", "" )
+{
+    skip_list<int> list;
+    std::set<int>  expected;
+    for (int n = 0; n < 2000; n += 2) { list.insert(n); expected.insert(n); }
+
+    std::vector<int> values;
+    for (int n = -30; n < 3030; n += 3) values.push_back(n);
+
+    const size_t before = expected.size();
+    expected.insert(values.begin(), values.end());
+    REQUIRE(list.insert_sorted_batch(values.begin(), values.end()) == expected.size()-before);
+    REQUIRE(CheckEquality(list, expected));
+    REQUIRE(list.insert_sorted_batch(values.begin(), values.end()) == 0);
+
+    // out of order is slower, but still right
+    std::vector<int> odds;
+    for (int n = 1; n < 100; n += 2) odds.push_back(n);
+    list.insert_sorted_batch(odds.rbegin(), odds.rend());
+    expected.insert(odds.begin(), odds.end());
+    REQUIRE(CheckEquality(list, expected));
+}
+
+TEST_CASE( "skip_list/erase_sorted_batch/erases what is there", "" )
+{
+    skip_list<int> list;
+    std::set<int>  expected;
+    for (int n = 0; n < 2000; ++n) { list.insert(n); expected.insert(n); }
+
+    std::vector<int> values;
+    for (int n = -30; n < 3030; n += 3) values.push_back(n);
+
+    skip_list<int>::finger f;
+    list.find(10, f);
+
+    size_t erased = 0;
+    for (size_t n = 0; n < values.size(); ++n) erased += expected.erase(values[n]);
+    REQUIRE(list.erase_sorted_batch(values.begin(), values.end()) == erased);
+    REQUIRE(CheckEquality(list, expected));
+    REQUIRE(list.erase_sorted_batch(values.begin(), values.end()) == 0);
+
+    // fingers from before are no longer trusted
+    REQUIRE(list.find(10, f) == list.find(10));
+    REQUIRE(list.find(12, f) == list.end());
+
+    const std::vector<int> rest(list.begin(), list.end());
+    REQUIRE(list.erase_sorted_batch(rest.begin(), rest.end()) == rest.size());
+    REQUIRE(list.empty());
+}
+
+TEST_CASE( "skip_list/sorted batches/agree with std::set", "" )
+{
+    skip_list<int> list;
+    std::set<int>  expected;
+    for (unsigned round = 0; round < 20; ++round)
+    {
+        std::vector<int> batch;
+        for (unsigned n = 0; n < 500; ++n) batch.push_back(rand() % 2000);
+        std::sort(batch.begin(), batch.end());
+
+        if (round % 3 == 2)
+        {
+            size_t erased = 0;
+            for (size_t n = 0; n < batch.size(); ++n) erased += expected.erase(batch[n]);
+            REQUIRE(list.erase_sorted_batch(batch.begin(), batch.end()) == erased);
+        }
+        else
+        {
+            const size_t before = expected.size();
+            expected.insert(batch.begin(), batch.end());
+            REQUIRE(list.insert_sorted_batch(batch.begin(), batch.end()) == expected.size()-before);
+        }
+        REQUIRE(CheckEquality(list, expected));
+    }
+}
+
+TEST_CASE( "skip_list/insert_sorted_batch/sorted values are cheap", "" )
+{
+    typedef skip_list<int,CountingLess> list_type;
+    std::vector<int> evens, odds;
+    for (int n = 0; n < 20000; n += 2) { evens.push_back(n); odds.push_back(n+1); }
+
+    list_type singly(evens.begin(), evens.end());
+    CountingLess::comparisons = 0;
+    for (size_t n = 0; n < odds.size(); ++n) singly.insert(odds[n]);
+    const unsigned one_at_a_time = CountingLess::comparisons;
+
+    list_type batched(evens.begin(), evens.end());
+    CountingLess::comparisons = 0;
+    batched.insert_sorted_batch(odds.begin(), odds.end());
+    const unsigned merged = CountingLess::comparisons;
+
+    REQUIRE(batched == singly);
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    REQUIRE(one_at_a_time > merged*2);
+#endif
+
+    CountingLess::comparisons = 0;
+    batched.erase_sorted_batch(odds.begin(), odds.end());
+    const unsigned erased = CountingLess::comparisons;
+    REQUIRE(batched.size() == evens.size());
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    REQUIRE(one_at_a_time > erased*2);
+#endif
+}
+
+//============================================================================
+// merge, splice, extract
+
+TEST_CASE( "skip_list/merge/interleaved lists", "" )
+{
+    skip_list<int> list, other;
+    std::set<int>  expected;
+    for (int n = 0; n < 1000; n += 2) { list.insert(n); expected.insert(n); }
+    for (int n = 0; n < 1500; n += 3) { other.insert(n); expected.insert(n); }
+
+    list.merge(other);
+    REQUIRE(CheckEquality(list, expected));
+
+    // the values that were already here stay behind
+    REQUIRE(other.size() == 167u);
+    for (skip_list<int>::iterator i = other.begin(); i != other.end(); ++i)
+    {
+        const bool multiple_of_six = *i % 6 == 0;
+        REQUIRE(multiple_of_six);
+        REQUIRE(*i < 1000);
+    }
+
+    list.merge(other);
+    REQUIRE(list.size() == expected.size());
+    REQUIRE(other.size() == 167u);
+
+    skip_list<int> empty;
+    empty.merge(list);
+    REQUIRE(CheckEquality(empty, expected));
+    REQUIRE(list.empty());
+    list.merge(list);
+    REQUIRE(list.empty());
+}
+
+TEST_CASE( "skip_list/splice/a range and a single element", "" )
+{
+    skip_list<int> list, other;
+    for (int n = 0; n < 10; ++n) list.insert(n*10);
+    for (int n = 0; n < 100; ++n) other.insert(n);
+
+    list.splice(other, other.find(21), other.find(25));
+    REQUIRE(list.size() == 14u);
+    REQUIRE(other.size() == 96u);
+    REQUIRE(list.contains(23));
+    REQUIRE(!other.contains(23));
+    REQUIRE(other.contains(25));
+
+    list.splice(other, other.find(55));
+    REQUIRE(list.size() == 15u);
+    REQUIRE(other.size() == 95u);
+    REQUIRE(list.contains(55));
+    REQUIRE(!other.contains(55));
+    REQUIRE(std::adjacent_find(list.begin(), list.end(), std::greater_equal<int>()) == list.end());
+
+    // an element already here is left where it was
+    list.splice(other, other.find(30));
+    REQUIRE(list.size() == 15u);
+    REQUIRE(other.contains(30));
+
+    list.splice(other, other.begin(), other.begin());
+    REQUIRE(other.size() == 95u);
+}
+
+TEST_CASE( "skip_list/extract/range", "" )
+{
+    skip_list<int> list;
+    for (int n = 0; n < 100; ++n) list.insert(n);
+
+    skip_list<int> middle = list.extract(list.find(40), list.find(60));
+    REQUIRE(middle.size() == 20u);
+    REQUIRE(list.size() == 80u);
+    REQUIRE(middle.front() == 40);
+    REQUIRE(middle.back() == 59);
+    REQUIRE(*list.lower_bound(40) == 60);
+
+    skip_list<int> rest = list.extract(list.begin(), list.end());
+    REQUIRE(rest.size() == 80u);
+    REQUIRE(list.empty());
+
+    list.merge(middle);
+    list.merge(rest);
+    REQUIRE(list.size() == 100u);
+    for (int n = 0; n < 100; ++n) { REQUIRE(list.contains(n)); }
+}
+
+TEST_CASE( "skip_list/merge/from a multi_skip_list", "" )
+{
+    skip_list<int>                    list;
+    goodliffe::multi_skip_list<int> multi;
+    for (int n = 0; n < 20; ++n) { multi.insert(n/2); multi.insert(n/2); }
+
+    list.merge(multi);
+    REQUIRE(list.size() == 10u);
+    REQUIRE(multi.size() == 30u);
+    REQUIRE(multi.count(3) == 3u);
+
+    multi.merge(list);
+    REQUIRE(list.empty());
+    REQUIRE(multi.size() == 40u);
+    REQUIRE(multi.count(3) == 4u);
+}
+
+TEST_CASE( "skip_list/allocation/merge relinks without allocating", "" )
+{
+    typedef skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    AllocationCounter::reset();
+    {
+        list_type list, other;
+        for (int n = 0; n < 100; ++n) { list.insert(n*2); other.insert(n*3); }
+
+        const int allocations = AllocationCounter::allocations;
+        const int blocks      = AllocationCounter::blocks;
+        list.merge(other);
+        list_type extracted = list.extract(list.begin(), list.find(100));
+        other.splice(extracted, extracted.begin(), extracted.end());
+        REQUIRE(AllocationCounter::allocations == allocations+2); // extracted's head and tail
+        REQUIRE(AllocationCounter::blocks == blocks+2);
+        const size_t total = list.size()+other.size()+extracted.size();
+        REQUIRE(total == 200u);
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "skip_list/insert-hint/any hint gives the right order", "" )
+{
+    skip_list<int> list;
+    for (int n = 0; n < 1000; n += 10) list.insert(n);
+
+    // Hints on either side of the new value, near and far, short and tall
+    for (int n = 5; n < 1000; n += 10)
+    {
+        skip_list<int>::iterator hint = list.begin();
+        std::advance(hint, (n*7) % int(list.size()));
+        skip_list<int>::iterator i = list.insert(hint, n);
+        REQUIRE(*i == n);
+        REQUIRE(*--i < n);
+    }
+    REQUIRE(list.size() == 200);
+    REQUIRE(std::adjacent_find(list.begin(), list.end(), std::greater_equal<int>()) == list.end());
+
+    REQUIRE(*list.insert(list.end(), 2000) == 2000);
+    REQUIRE(*list.insert(list.end(), -1) == -1);
+    REQUIRE(list.front() == -1);
+    REQUIRE(list.back() == 2000);
+}
+
+TEST_CASE( "skip_list/insert-hint/ordered appends are cheap", "" )
+{
+    typedef skip_list<int,CountingLess> list_type;
+
+    list_type at_end;
+    CountingLess::comparisons = 0;
+    for (int n = 0; n < 10000; ++n) at_end.insert(at_end.end(), n);
+    const unsigned end_hint = CountingLess::comparisons;
+
+    list_type after_last;
+    list_type::iterator hint = after_last.end();
+    CountingLess::comparisons = 0;
+    for (int n = 0; n < 10000; ++n) hint = after_last.insert(hint, n);
+    const unsigned last_hint = CountingLess::comparisons;
+
+    std::vector<int> data;
+    FillWithOrderedData(10000, data);
+    list_type ranged;
+    CountingLess::comparisons = 0;
+    ranged.insert(data.begin(), data.end());
+    const unsigned range = CountingLess::comparisons;
+
+    REQUIRE(at_end.size() == 10000);
+    REQUIRE(after_last.size() == 10000);
+    REQUIRE(ranged.size() == 10000);
+    REQUIRE(std::adjacent_find(ranged.begin(), ranged.end(), std::greater_equal<int>()) == ranged.end());
+
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    // A constant number per element, rather than one per level
+    REQUIRE(end_hint < 10000*4);
+    REQUIRE(last_hint < 10000*4);
+    REQUIRE(range < 10000*4);
+#endif
+}
+
+TEST_CASE( "skip_list/insert-hint/unsorted input costs no more than plain inserts", "" )
+{
+    typedef skip_list<int,CountingLess> list_type;
+
+    // A hint that isn't next to the value must cost no more than a search
+    // from the top. Each step along a level is paid for by a comparison,
+    // so counting them bounds the walking too.
+    std::vector<int> data;
+    FillWithRandomData(20000, data);
+
+    list_type plain;
+    CountingLess::comparisons = 0;
+    for (size_t n = 0; n < data.size(); ++n) plain.insert(data[n]);
+    const unsigned without_hint = CountingLess::comparisons;
+
+    list_type ranged;
+    CountingLess::comparisons = 0;
+    ranged.insert(data.begin(), data.end());
+    const unsigned range = CountingLess::comparisons;
+
+    list_type at_end;
+    CountingLess::comparisons = 0;
+    for (size_t n = 0; n < data.size(); ++n) at_end.insert(at_end.end(), data[n]);
+    const unsigned end_hint = CountingLess::comparisons;
+
+    list_type after_last;
+    list_type::iterator hint = after_last.end();
+    CountingLess::comparisons = 0;
+    for (size_t n = 0; n < data.size(); ++n) hint = after_last.insert(hint, data[n]);
+    const unsigned last_hint = CountingLess::comparisons;
+
+    REQUIRE(ranged.size() == plain.size());
+    REQUIRE(at_end.size() == plain.size());
+    REQUIRE(after_last.size() == plain.size());
+    REQUIRE(std::equal(plain.begin(), plain.end(), ranged.begin()));
+    REQUIRE(std::equal(plain.begin(), plain.end(), at_end.begin()));
+    REQUIRE(std::equal(plain.begin(), plain.end(), after_last.begin()));
+
+#ifndef SKIP_LIST_IMPL_DIAGNOSTICS
+    const unsigned allowance = without_hint + without_hint/4;
+    REQUIRE(range < allowance);
+    REQUIRE(end_hint < allowance);
+    REQUIRE(last_hint < allowance);
+#endif
+}
+
 //============================================================================
 // random level selection
 
@@ -686,6 +1223,68 @@ TEST_CASE( "skip_list_level_generator/random level algorithm", "" )
     }
 }
 
+TEST_CASE( "xorshift_skip_list_level_generator/random level algorithm", "" )
+{
+    using goodliffe::detail::xorshift_skip_list_level_generator;
+    typedef xorshift_skip_list_level_generator<32> generator_type;
+
+    generator_type generator;
+    std::vector<unsigned> levels(generator_type::num_levels, 0);
+    for (unsigned n = 0; n < 100000; ++n)
+    {
+        unsigned random = generator.new_level();
+        REQUIRE(random < unsigned(generator_type::num_levels));
+        levels[random]++;
+    }
+
+    // Roughly half of the levels should be 0, a quarter 1, and so on
+    REQUIRE(levels[0] > 45000); REQUIRE(levels[0] < 55000);
+    REQUIRE(levels[1] > 20000); REQUIRE(levels[1] < 30000);
+    REQUIRE(levels[2] > 10000); REQUIRE(levels[2] < 15000);
+    for (unsigned n = 0; n < 8; ++n)
+    {
+        REQUIRE(levels[n] > levels[n+1]);
+    }
+}
+
+TEST_CASE( "xorshift_skip_list_level_generator/respects num_levels", "" )
+{
+    goodliffe::detail::xorshift_skip_list_level_generator<2> generator;
+    for (unsigned n = 0; n < 1000; ++n)
+    {
+        REQUIRE(generator.new_level() < 2u);
+    }
+}
+
+TEST_CASE( "xorshift_skip_list_level_generator/state is per instance", "" )
+{
+    using goodliffe::detail::xorshift_skip_list_level_generator;
+
+    xorshift_skip_list_level_generator<32> g1(1234), g2(1234);
+    for (unsigned n = 0; n < 1000; ++n)
+    {
+        REQUIRE(g1.new_level() == g2.new_level());
+    }
+
+    // and does not touch std::rand
+    srand(99);
+    const int expected = rand();
+    srand(99);
+    for (unsigned n = 0; n < 1000; ++n) g1.new_level();
+    REQUIRE(rand() == expected);
+}
+
+TEST_CASE( "skip_list_level_generator/count_trailing_zeros", "" )
+{
+    using goodliffe::detail::count_trailing_zeros;
+    
+    REQUIRE(count_trailing_zeros(1) == 0);
+    REQUIRE(count_trailing_zeros(2) == 1);
+    REQUIRE(count_trailing_zeros(12) == 2);
+    REQUIRE(count_trailing_zeros(0x80000000u) == 31);
+    REQUIRE(count_trailing_zeros(0xffffffffu) == 0);
+}
+
 TEST_CASE( "skip_list_level_generator/compilation errors", "" )
 {
     goodliffe::detail::skip_list_level_generator<33> list;
@@ -811,6 +1410,54 @@ TEST_CASE( "skip_list/assign/populated list", "" )
     REQUIRE(*i == 67); ++i; REQUIRE(i == list.end());
 }
 
+//============================================================================
+// assign_sorted
+
+TEST_CASE( "skip_list/assign_sorted/populated list", "" )
+{
+    std::vector<int> data;
+    for (int n = 0; n < 1000; ++n) data.push_back(rand() % 300); // with repeats
+    std::sort(data.begin(), data.end());
+
+    skip_list<int> list;
+    list.insert(1); list.insert(2); list.insert(300);
+
+    list.assign_sorted(data.begin(), data.end());
+    SortVectorAndRemoveDuplicates(data);
+    REQUIRE(CheckEquality(list, data));
+}
+
+TEST_CASE( "skip_list/assign_sorted/list is usable afterwards", "" )
+{
+    std::vector<int> data;
+    FillWithOrderedData(200, data);
+
+    skip_list<int> list;
+    list.assign_sorted(data.begin(), data.end());
+
+    for (int n = 0; n < 200; n += 2)
+    {
+        REQUIRE(list.erase(n) == 1);
+    }
+    list.insert(-1);
+    list.insert(1000);
+    REQUIRE(list.size() == 102);
+    REQUIRE(list.find(51) != list.end());
+    REQUIRE(list.find(50) == list.end());
+    REQUIRE(CheckForwardIteration(list));
+    REQUIRE(CheckBackwardIteration(list));
+}
+
+TEST_CASE( "skip_list/assign_sorted/empty range", "" )
+{
+    skip_list<int> list;
+    list.insert(1);
+
+    list.assign_sorted(assign_source_data, assign_source_data);
+    REQUIRE(list.empty());
+    REQUIRE(list.begin() == list.end());
+}
+
 //============================================================================
 // operator=
 
@@ -855,6 +1502,17 @@ TEST_CASE( "skip_list/operator=/assignment still maintains seprate lists", "" )
     REQUIRE(assignee.size() == 4);
 }
 
+TEST_CASE( "skip_list/operator=/self assignment", "" )
+{
+    skip_list<int> list;
+    list.assign(assign_source_data, assign_source_data_end);
+
+    skip_list<int> &alias = list;
+    list = alias;
+    REQUIRE(list.size() == 4);
+    REQUIRE(list.front() == 12);
+}
+
 //============================================================================
 // copy ctor
 
@@ -1317,6 +1975,318 @@ TEST_CASE( "skip_list/object lifetime", "" )
     REQUIRE(Counter::count == 0);
 }
 
+//============================================================================
+// C++11 operations
+
+#if SKIP_LIST_CPP11
+
+int CopyCounter::copies = 0;
+int CopyCounter::moves  = 0;
+int CountedString::constructions = 0;
+
+TEST_CASE( "skip_list/C++11/move ctor takes the nodes", "" )
+{
+    typedef skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    list_type source;
+    source.assign(assign_source_data, assign_source_data_end);
+
+    AllocationCounter::reset();
+    list_type moved(std::move(source));
+    REQUIRE(AllocationCounter::allocations == 2); // a new head and tail only
+    REQUIRE(moved.size() == 4);
+    REQUIRE(moved.front() == 12);
+    REQUIRE(source.empty());
+
+    source.insert(1);
+    REQUIRE(source.size() == 1);
+}
+
+TEST_CASE( "skip_list/C++11/move assignment", "" )
+{
+    skip_list<int> source;
+    source.assign(assign_source_data, assign_source_data_end);
+
+    skip_list<int> assignee;
+    assignee.insert(1);
+    assignee = std::move(source);
+
+    REQUIRE(assignee.size() == 4);
+    REQUIRE(assignee.front() == 12);
+    REQUIRE(source.empty());
+    REQUIRE(CheckBackwardIteration(assignee));
+
+    skip_list<int> &alias = assignee;
+    assignee = std::move(alias);
+    REQUIRE(assignee.size() == 4);
+}
+
+TEST_CASE( "skip_list/C++11/initializer lists", "" )
+{
+    skip_list<int> list = { 45, 34, 67, 12, 34 };
+    REQUIRE(list.size() == 4);
+    REQUIRE(list.front() == 12);
+
+    list.insert({ 1, 100 });
+    REQUIRE(list.size() == 6);
+    REQUIRE(list.back() == 100);
+}
+
+TEST_CASE( "skip_list/C++11/rvalue insert does not copy", "" )
+{
+    skip_list<CopyCounter> list;
+    CopyCounter::reset();
+
+    list.insert(CopyCounter(2, "two"));
+    list.insert(list.end(), CopyCounter(3, "three"));
+    REQUIRE(CopyCounter::copies == 0);
+    REQUIRE(list.size() == 2);
+    REQUIRE(list.find(CopyCounter(3))->payload == "three");
+}
+
+TEST_CASE( "skip_list/C++11/emplace constructs in place", "" )
+{
+    skip_list<CopyCounter> list;
+    CopyCounter::reset();
+
+    skip_list<CopyCounter>::insert_by_value_result r = list.emplace(2, "two");
+    REQUIRE(r.second);
+    REQUIRE(r.first->payload == "two");
+
+    skip_list<CopyCounter>::iterator i = list.emplace_hint(list.end(), 3, "three");
+    REQUIRE(i->value == 3);
+    REQUIRE(CopyCounter::copies == 0);
+    REQUIRE(CopyCounter::moves == 0);
+
+    r = list.emplace(2, "deux");
+    REQUIRE(!r.second);
+    REQUIRE(r.first->payload == "two");
+    REQUIRE(list.size() == 2);
+}
+
+TEST_CASE( "skip_list/C++11/emplace object lifetime", "" )
+{
+    REQUIRE(Counter::count == 0);
+    {
+        skip_list<Counter> list;
+        list.emplace(1);
+        list.emplace(2);
+        list.emplace(1);
+        REQUIRE(list.size() == 2);
+        REQUIRE(Counter::count == 2);
+    }
+    REQUIRE(Counter::count == 0);
+}
+
+TEST_CASE( "skip_list/C++11/extract and reinsert a node", "" )
+{
+    typedef skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    AllocationCounter::reset();
+    {
+        list_type list, other;
+        for (int n = 0; n < 100; ++n) { list.insert(n); other.insert(n*2); }
+        const int allocations = AllocationCounter::allocations;
+
+        list_type::node_handle handle = list.extract(51);
+        REQUIRE(!handle.empty());
+        REQUIRE(handle.value() == 51);
+        REQUIRE(list.size() == 99u);
+        REQUIRE(!list.contains(51));
+        REQUIRE(list.extract(51).empty());
+
+        list_type::insert_return_type r = other.insert(std::move(handle));
+        REQUIRE(r.inserted);
+        REQUIRE(*r.position == 51);
+        REQUIRE(r.node.empty());
+        REQUIRE(handle.empty());
+        REQUIRE(other.size() == 101u);
+
+        // an equivalent already there: the node comes back
+        r = other.insert(list.extract(list.find(50)));
+        REQUIRE(!r.inserted);
+        REQUIRE(r.position == other.find(50));
+        REQUIRE(r.node.value() == 50);
+        r.node.value() = 49;
+        list_type::iterator i = other.insert(other.end(), std::move(r.node));
+        REQUIRE(*i == 49);
+        REQUIRE(i == other.find(49));
+        REQUIRE(r.node.empty());
+
+        REQUIRE(list.insert(std::move(r.node)).position == list.end());
+        REQUIRE(AllocationCounter::allocations == allocations);
+        REQUIRE(list.size() == 98u);
+        REQUIRE(other.size() == 102u);
+        REQUIRE(std::adjacent_find(other.begin(), other.end(), std::greater_equal<int>()) == other.end());
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "skip_list/C++11/a node handle frees what it holds", "" )
+{
+    REQUIRE(Counter::count == 0);
+    {
+        skip_list<Counter> list;
+        for (int n = 0; n < 10; ++n) list.insert(n);
+
+        skip_list<Counter>::node_handle handle = list.extract(list.begin());
+        REQUIRE(Counter::count == 10);
+        handle = list.extract(list.begin());
+        REQUIRE(Counter::count == 9);
+
+        skip_list<Counter>::node_handle other = std::move(handle);
+        REQUIRE(handle.empty());
+        other.swap(handle);
+        REQUIRE(other.empty());
+        REQUIRE(handle.value().value == 1);
+        REQUIRE(Counter::count == 9);
+    }
+    REQUIRE(Counter::count == 0);
+}
+
+TEST_CASE( "skip_list/C++11/nodes move to and from a multi_skip_list", "" )
+{
+    skip_list<int>                  list;
+    goodliffe::multi_skip_list<int> multi;
+    for (int n = 0; n < 10; ++n) { list.insert(n); multi.insert(5); }
+
+    REQUIRE(multi.insert(list.extract(5)).inserted);
+    REQUIRE(multi.count(5) == 11u);
+    REQUIRE(list.insert(multi.extract(5)).inserted);
+    REQUIRE(!list.insert(multi.extract(5)).inserted);
+    REQUIRE(multi.count(5) == 9u);
+    REQUIRE(list.size() == 10u);
+}
+
+#endif
+
+//============================================================================
+// allocations
+
+int AllocationCounter::allocations = 0;
+int AllocationCounter::blocks      = 0;
+
+TEST_CASE( "skip_list/allocation/one allocation per inserted item", "" )
+{
+    typedef skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    AllocationCounter::reset();
+    {
+        list_type list;
+        const int baseline = AllocationCounter::allocations; // head and tail
+
+        for (int n = 0; n < 100; ++n) list.insert(n);
+        REQUIRE(AllocationCounter::allocations == baseline+100);
+
+        for (int n = 0; n < 50; ++n) list.erase(n);
+        REQUIRE(AllocationCounter::blocks == baseline+50);
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "skip_list/allocation/copy allocates one node per item", "" )
+{
+    typedef skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    AllocationCounter::reset();
+    {
+        list_type source;
+        for (int n = 0; n < 100; ++n) source.insert(n);
+
+        const int allocations = AllocationCounter::allocations;
+        list_type copy(source);
+        REQUIRE(AllocationCounter::allocations == allocations+2+100);
+        REQUIRE(CheckEquality(copy, source));
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "skip_list/allocation/no allocation for duplicate insert", "" )
+{
+    typedef skip_list<int,std::less<int>,CountingAllocator<int> > list_type;
+
+    AllocationCounter::reset();
+    list_type list;
+    for (int n = 0; n < 100; ++n) list.insert(n);
+    const int allocations = AllocationCounter::allocations;
+
+    for (int n = 0; n < 100; ++n)
+    {
+        list_type::insert_by_value_result r = list.insert(n);
+        REQUIRE(!r.second);
+        REQUIRE(*r.first == n);
+    }
+    REQUIRE(AllocationCounter::allocations == allocations);
+    REQUIRE(list.size() == 100);
+}
+
+TEST_CASE( "skip_list/allocation/duplicate insert leaves the height alone", "" )
+{
+    typedef skip_list<int,std::less<int>,std::allocator<int>,TallLevelGenerator> list_type;
+
+    list_type list;
+    for (int n = 0; n < 5; ++n) list.insert(n);
+    const std::string before = DumpHeader(list);
+    REQUIRE(before == "skip_list(size=5,levels=5)");
+
+    list_type::finger f;
+    for (int n = 0; n < 5; ++n)
+    {
+        REQUIRE(!list.insert(n).second);
+        REQUIRE(!list.insert(f, n).second);
+        REQUIRE(*list.insert(list.end(), n) == n);
+        REQUIRE(*list.insert(list.begin(), n) == n);
+#if SKIP_LIST_CPP11
+        REQUIRE(!list.insert(int(n)).second);
+        REQUIRE(*list.insert(list.end(), int(n)) == n);
+        REQUIRE(!list.emplace(n).second);
+#endif
+    }
+    const int values[] = { 4, 0, 2, 3, 1 };
+    list.insert(values, values+5);
+    list.insert_sorted_batch(values+1, values+3);
+
+    REQUIRE(DumpHeader(list) == before);
+}
+
+TEST_CASE( "skip_list/allocation/merge leaves behind tall duplicates without growing", "" )
+{
+    typedef skip_list<int,std::less<int>,std::allocator<int>,TallLevelGenerator> list_type;
+
+    list_type list, other;
+    for (int n = 0; n < 5; ++n) list.insert(n);
+    for (int n = 10; n--; ) other.insert(n); // the duplicates get the tallest towers
+    const std::string before = DumpHeader(list);
+
+    list.merge(other);
+    REQUIRE(list.size() == 10u);
+    REQUIRE(other.size() == 5u);
+    REQUIRE(DumpHeader(list) == "skip_list(size=10,levels=5)");
+    REQUIRE(before == "skip_list(size=5,levels=5)");
+}
+
+#if SKIP_LIST_CPP11
+TEST_CASE( "skip_list/allocation/rejected node handle leaves the height alone", "" )
+{
+    typedef skip_list<int,std::less<int>,std::allocator<int>,TallLevelGenerator> list_type;
+
+    list_type list, other;
+    for (int n = 0; n < 5; ++n) list.insert(n);
+    for (int n = 10; n--; ) other.insert(n); // 0 has the tallest tower
+    const std::string before = DumpHeader(list);
+
+    list_type::insert_return_type r = list.insert(other.extract(0));
+    REQUIRE(!r.inserted);
+    REQUIRE(r.node.value() == 0);
+    REQUIRE(*list.insert(list.begin(), std::move(r.node)) == 0);
+    REQUIRE(list.size() == 5u);
+    REQUIRE(DumpHeader(list) == before);
+
+    REQUIRE(list.insert(other.extract(9)).inserted);
+    REQUIRE(DumpHeader(list) == "skip_list(size=6,levels=5)");
+}
+#endif
+
 TEST_CASE( "skip_list/remove/two item list object lifetime", "" )
 {
     skip_list<Counter> list;
@@ -1516,6 +2486,50 @@ TEST_CASE( "skip_list/type requirements (only <)", "" )
     REQUIRE_FALSE(list2.empty());
 }
 
+#if SKIP_LIST_CPP11
+
+TEST_CASE( "skip_list/C++11/transparent lookups build no value", "" )
+{
+    skip_list<CountedString, CountedStringLess> list;
+    const char *names[] = { "delta", "alpha", "echo", "charlie", "bravo" };
+    for (unsigned n = 0; n < 5; ++n) list.insert(names[n]);
+
+    const skip_list<CountedString, CountedStringLess> &clist = list;
+    CountedString::constructions = 0;
+
+    REQUIRE(list.contains("charlie"));
+    REQUIRE(!list.contains("foxtrot"));
+    REQUIRE(list.count("alpha") == 1);
+    REQUIRE(list.find("echo")->text == "echo");
+    REQUIRE(clist.find("zulu") == clist.end());
+    REQUIRE(list.lower_bound("c")->text == "charlie");
+    REQUIRE(clist.upper_bound("charlie")->text == "delta");
+    REQUIRE(list.erase("bravo") == 1);
+    REQUIRE(list.erase("bravo") == 0);
+    REQUIRE(CountedString::constructions == 0);
+
+    // iterators still erase by position
+    list.erase(list.begin());
+    REQUIRE(list.size() == 3);
+    REQUIRE(list.front().text == "charlie");
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "skip_list/C++11/std::less<> looks up strings by C string", "" )
+{
+    skip_list<std::string, std::less<> > list;
+    list.insert("one");
+    list.insert("two");
+
+    REQUIRE(list.find("two") != list.end());
+    REQUIRE(list.count("three") == 0);
+    REQUIRE(list.erase("one") == 1);
+    REQUIRE(list.size() == 1);
+}
+#endif
+
+#endif
+
 //============================================================================
 // things that should not be compilable
 
@@ -8,8 +8,10 @@
 #include "catch.hpp"
 #include "test_types.h"
 
+#include <iterator>
 #include <map>
 #include <string>
+#include <vector>
 
 using goodliffe::skip_list_map;
 
@@ -107,7 +109,7 @@ TEST_CASE( "skip_list_map/can't insert same item twice", "" )
 
     skip_list_map<int, std::string>::insert_by_value_result r = map.insert(std::make_pair(10, "ten"));
     REQUIRE(!r.second);
-    REQUIRE(r.first == map.end());
+    REQUIRE(r.first == map.begin());
     REQUIRE(map.size() == 1);
     
     skip_list_map<int, std::string>::iterator i = map.begin();
@@ -131,6 +133,149 @@ TEST_CASE( "skip_list_map/impl/double insert middle value", "" )
     REQUIRE(map.size() == 3);
 }
 
+TEST_CASE( "skip_list_map/duplicate insert leaves existing value alone", "" )
+{
+    skip_list_map<int, std::string> map;
+
+    map.insert(std::make_pair(10, "ten"));
+    map.insert(std::make_pair(20, "twenty"));
+
+    skip_list_map<int, std::string>::insert_by_value_result r = map.insert(std::make_pair(20, "zwanzig"));
+    REQUIRE(!r.second);
+    REQUIRE(r.first->first == 20);
+    REQUIRE(r.first->second == "twenty");
+
+    skip_list_map<int, std::string>::iterator i = map.insert(map.begin(), std::make_pair(10, "zehn"));
+    REQUIRE(i == map.begin());
+    REQUIRE(i->second == "ten");
+    REQUIRE(map.size() == 2);
+}
+
+//============================================================================
+// assign_sorted and copying
+
+TEST_CASE( "skip_list_map/assign_sorted/keeps first of repeated keys", "" )
+{
+    std::vector<std::pair<int, std::string> > data;
+    data.push_back(std::make_pair(1, "one"));
+    data.push_back(std::make_pair(2, "two"));
+    data.push_back(std::make_pair(2, "zwei"));
+    data.push_back(std::make_pair(3, "three"));
+
+    skip_list_map<int, std::string> map;
+    map.insert(std::make_pair(10, "ten"));
+    map.assign_sorted(data.begin(), data.end());
+
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.find(2)->second == "two");
+    REQUIRE(map.find(10) == map.end());
+    REQUIRE(map.rbegin()->second == "three");
+}
+
+TEST_CASE( "skip_list_map/copy copies data", "" )
+{
+    skip_list_map<int, std::string> source;
+    for (int n = 0; n < 100; ++n) source.insert(std::make_pair(n, std::string(size_t(n%10), 'x')));
+
+    skip_list_map<int, std::string> copy(source);
+    REQUIRE(copy == source);
+
+    skip_list_map<int, std::string> assignee;
+    assignee = source;
+    REQUIRE(assignee == source);
+
+    source.erase(42);
+    REQUIRE(copy.find(42)->second == "xx");
+    REQUIRE(assignee.size() == 100);
+}
+
+#if SKIP_LIST_CPP11
+
+TEST_CASE( "skip_list_map/C++11/emplace constructs in place", "" )
+{
+    skip_list_map<int, std::string> map = { { 1, "one" }, { 3, "three" } };
+
+    REQUIRE(map.emplace(2, "two").second);
+    REQUIRE(!map.emplace(3, "drei").second);
+    REQUIRE(map.emplace_hint(map.end(), 4, "four")->second == "four");
+    REQUIRE(map.insert(std::make_pair(5, std::string("five"))).second);
+
+    REQUIRE(map.size() == 5);
+    REQUIRE(map.find(2)->second == "two");
+    REQUIRE(map.find(3)->second == "three");
+
+    skip_list_map<int, std::string> moved(std::move(map));
+    REQUIRE(moved.size() == 5);
+    REQUIRE(map.empty());
+}
+
+TEST_CASE( "skip_list_map/C++11/re-key a node without allocating", "" )
+{
+    typedef std::pair<const int, std::string> value_type;
+    typedef skip_list_map<int, std::string, std::less<int>, CountingAllocator<value_type> > map_type;
+
+    AllocationCounter::reset();
+    {
+        map_type map;
+        for (int n = 0; n < 50; ++n) map.insert(std::make_pair(n, std::string(size_t(n), 'x')));
+        const int allocations = AllocationCounter::allocations;
+
+        map_type::node_handle handle = map.extract(10);
+        REQUIRE(handle.key() == 10);
+        REQUIRE(handle.mapped() == std::string(10, 'x'));
+        REQUIRE(!map.count(10));
+
+        handle.key() = 100;
+        handle.mapped() = "hundred";
+        map_type::insert_return_type r = map.insert(std::move(handle));
+        REQUIRE(r.inserted);
+        REQUIRE(r.position->first == 100);
+        REQUIRE(map.find(100)->second == "hundred");
+
+        // clashing keys come back
+        handle = map.extract(map.find(20));
+        handle.key() = 30;
+        r = map.insert(std::move(handle));
+        REQUIRE(!r.inserted);
+        REQUIRE(r.position->first == 30);
+        REQUIRE(r.node.mapped() == std::string(20, 'x'));
+        r.node.key() = 20;
+        REQUIRE(map.insert(map.begin(), std::move(r.node))->first == 20);
+
+        REQUIRE(AllocationCounter::allocations == allocations);
+        REQUIRE(map.size() == 50);
+    }
+    REQUIRE(AllocationCounter::blocks == 0);
+}
+
+TEST_CASE( "skip_list_map/C++11/transparent lookups build no key", "" )
+{
+    typedef skip_list_map<CountedString, int, CountedStringLess> map_type;
+    map_type map;
+    map.insert(std::make_pair(CountedString("one"),   1));
+    map.insert(std::make_pair(CountedString("two"),   2));
+    map.insert(std::make_pair(CountedString("three"), 3));
+
+    const map_type &cmap = map;
+    CountedString::constructions = 0;
+
+    REQUIRE(map.contains("two"));
+    REQUIRE(map.count("four") == 0);
+    REQUIRE(map.find("three")->second == 3);
+    map.find("one")->second = 10;
+    REQUIRE(cmap.find("one")->second == 10);
+    REQUIRE(map.lower_bound("p")->second == 3);
+    REQUIRE(cmap.upper_bound("three")->second == 2);
+    REQUIRE(map.erase("two") == 1);
+    REQUIRE(map.erase("two") == 0);
+    REQUIRE(CountedString::constructions == 0);
+
+    map.erase(map.find("one"));
+    REQUIRE(map.size() == 1);
+}
+
+#endif
+
 //============================================================================
 // erasing by key
 
@@ -282,6 +427,141 @@ TEST_CASE( "skip_list_map/find/in a populated map with several keys having the s
 }
 
 
+//============================================================================
+// fingers
+
+TEST_CASE( "skip_list_map/finger/find and insert", "" )
+{
+    skip_list_map<int, std::string> map;
+    skip_list_map<int, std::string>::finger f;
+
+    for (int n = 0; n < 100; ++n)
+    {
+        REQUIRE(map.insert(f, std::make_pair(n, std::string(size_t(n%5), 'x'))).second);
+    }
+    REQUIRE(!map.insert(f, std::make_pair(42, std::string("dup"))).second);
+    REQUIRE(map.size() == 100);
+
+    for (int n = 99; n >= 0; --n)
+    {
+        REQUIRE(map.find(n, f)->second == std::string(size_t(n%5), 'x'));
+    }
+    REQUIRE(map.find(100, f) == map.end());
+    REQUIRE(map.lower_bound(-1, f) == map.begin());
+
+    const skip_list_map<int, std::string> &cmap = map;
+    REQUIRE(cmap.find(50, f)->first == 50);
+}
+
+//============================================================================
+// find_batch
+
+TEST_CASE( "skip_list_map/find_batch/agrees with find", "" )
+{
+    typedef skip_list_map<int, std::string> map_type;
+    map_type map;
+    // big enough (past sl_impl::batch_threshold) that searches interleave
+    for (int n = 0; n < 60000; n += 3) map.insert(map.end(), std::make_pair(n, std::string(size_t(n%5), 'x')));
+
+    std::vector<int> keys;
+    for (int n = 110; n > -10; --n) keys.push_back(n);
+
+    std::vector<map_type::iterator> found;
+    map.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+    REQUIRE(found.size() == keys.size());
+    for (size_t n = 0; n < keys.size(); ++n)
+    {
+        REQUIRE(found[n] == map.find(keys[n]));
+    }
+
+    const map_type &cmap = map;
+    std::vector<map_type::const_iterator> cfound;
+    cmap.find_batch(keys.begin(), keys.end(), std::back_inserter(cfound));
+    REQUIRE(cfound[110-42]->first == 42);
+    REQUIRE(cfound[110-43] == cmap.end());
+}
+
+TEST_CASE( "skip_list_map/find_sorted_batch/agrees with find and lower_bound", "" )
+{
+    typedef skip_list_map<int, std::string> map_type;
+    map_type map;
+    for (int n = 0; n < 300; n += 3) map.insert(std::make_pair(n, std::string(size_t(n%5), 'x')));
+
+    std::vector<int> keys;
+    for (int n = -10; n < 310; ++n) keys.push_back(n);
+
+    const map_type &cmap = map;
+    std::vector<map_type::const_iterator> found, bounds;
+    cmap.find_sorted_batch(keys.begin(), keys.end(), std::back_inserter(found));
+    cmap.lower_bound_sorted_batch(keys.begin(), keys.end(), std::back_inserter(bounds));
+    for (size_t n = 0; n < keys.size(); ++n)
+    {
+        REQUIRE(found[n] == cmap.find(keys[n]));
+        REQUIRE(bounds[n] == cmap.lower_bound(keys[n]));
+    }
+}
+
+TEST_CASE( "skip_list_map/sorted batches/insert and erase", "" )
+{
+    typedef skip_list_map<int, std::string> map_type;
+    map_type map;
+    map.insert(std::make_pair(5, std::string("five")));
+
+    std::vector<map_type::value_type> values;
+    for (int n = 0; n < 100; ++n) values.push_back(std::make_pair(n, std::string(size_t(n%7), 'x')));
+    REQUIRE(map.insert_sorted_batch(values.begin(), values.end()) == 99);
+    REQUIRE(map.size() == 100);
+    REQUIRE(map.find(5)->second == "five");
+    REQUIRE(map.find(6)->second == "xxxxxx");
+
+    std::vector<int> keys;
+    for (int n = -1; n < 120; n += 2) keys.push_back(n);
+    REQUIRE(map.erase_sorted_batch(keys.begin(), keys.end()) == 50);
+    REQUIRE(map.size() == 50);
+    REQUIRE(map.count(5) == 0);
+    REQUIRE(map.count(6) == 1);
+}
+
+//============================================================================
+// merge, splice, extract
+
+TEST_CASE( "skip_list_map/merge/existing keys stay behind", "" )
+{
+    typedef skip_list_map<int, std::string> map_type;
+    map_type map, other;
+    for (int n = 0; n < 20; n += 2) map.insert(std::make_pair(n, std::string("map")));
+    for (int n = 0; n < 20; n += 3) other.insert(std::make_pair(n, std::string("other")));
+
+    map.merge(other);
+    REQUIRE(map.size() == 13u);
+    REQUIRE(other.size() == 4u);
+    REQUIRE(map.find(6)->second == "map");
+    REQUIRE(map.find(9)->second == "other");
+    REQUIRE(other.find(6)->second == "other");
+    REQUIRE(other.count(9) == 0);
+}
+
+TEST_CASE( "skip_list_map/splice and extract/move nodes", "" )
+{
+    typedef skip_list_map<int, std::string> map_type;
+    map_type map, other;
+    for (int n = 0; n < 50; ++n) other.insert(std::make_pair(n, std::string(size_t(n%5), 'x')));
+
+    map.splice(other, other.find(10), other.find(20));
+    map.splice(other, other.find(30));
+    REQUIRE(map.size() == 11u);
+    REQUIRE(other.size() == 39u);
+    REQUIRE(map.find(14)->second == "xxxx");
+    REQUIRE(map.find(30)->second == "");
+    REQUIRE(other.count(30) == 0);
+
+    map_type low = map.extract(map.begin(), map.find(15));
+    REQUIRE(low.size() == 5u);
+    REQUIRE(map.size() == 6u);
+    REQUIRE(low.begin()->first == 10);
+    REQUIRE(map.begin()->first == 15);
+}
+
 //============================================================================
 // lower_bound
 
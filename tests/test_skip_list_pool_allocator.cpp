@@ -0,0 +1,245 @@
+//============================================================================
+// test_skip_list_pool_allocator.cpp
+//============================================================================
+
+#include "skip_list.h"
+#include "skip_list_map.h"
+#include "random_access_skip_list.h"
+#include "skip_list_pool_allocator.h"
+
+#define CATCH_CONFIG_NO_STREAM_REDIRECTION
+#include "catch.hpp"
+#include "test_types.h"
+
+#include <set>
+#include <string>
+
+using goodliffe::skip_list;
+using goodliffe::multi_skip_list;
+using goodliffe::skip_list_map;
+using goodliffe::random_access_skip_list;
+using goodliffe::skip_list_pool_allocator;
+
+TEST_CASE( "skip_list_pool_allocator/smoketest", "" )
+{
+}
+
+//============================================================================
+// the allocator itself
+
+TEST_CASE( "skip_list_pool_allocator/copies share a pool", "" )
+{
+    skip_list_pool_allocator<int> a1;
+    skip_list_pool_allocator<int> a2(a1);
+    skip_list_pool_allocator<char> a3(a1);
+    skip_list_pool_allocator<int> a4;
+
+    REQUIRE(a1 == a2);
+    REQUIRE(a1 == a3);
+    REQUIRE(a1 != a4);
+
+    a4 = a2;
+    REQUIRE(a1 == a4);
+}
+
+TEST_CASE( "skip_list_pool_allocator/recycles freed blocks", "" )
+{
+    skip_list_pool_allocator<int> alloc;
+
+    int *p1 = alloc.allocate(3);
+    alloc.deallocate(p1, 3);
+    int *p2 = alloc.allocate(3);
+    REQUIRE(p1 == p2);
+    REQUIRE(alloc.get_pool()->blocks_in_use() == 1);
+
+    alloc.deallocate(p2, 3);
+    REQUIRE(alloc.get_pool()->blocks_in_use() == 0);
+}
+
+TEST_CASE( "skip_list_pool_allocator/different sizes come from different free lists", "" )
+{
+    skip_list_pool_allocator<int> alloc;
+
+    int *small = alloc.allocate(2);
+    int *large = alloc.allocate(20);
+    alloc.deallocate(small, 2);
+
+    int *large2 = alloc.allocate(20);
+    REQUIRE(large2 != small);
+
+    alloc.deallocate(large, 20);
+    alloc.deallocate(large2, 20);
+}
+
+TEST_CASE( "skip_list_pool_allocator/very large requests bypass the pool", "" )
+{
+    skip_list_pool_allocator<char> alloc;
+
+    char *p = alloc.allocate(100000);
+    REQUIRE(p != 0);
+    REQUIRE(alloc.get_pool()->slabs_allocated() == 0);
+    alloc.deallocate(p, 100000);
+}
+
+//============================================================================
+// with the containers
+
+TEST_CASE( "skip_list_pool_allocator/skip_list", "" )
+{
+    typedef skip_list<int,std::less<int>,skip_list_pool_allocator<int> > list_type;
+
+    std::vector<int> data;
+    FillWithRandomData(1000, data);
+
+    list_type list(data.begin(), data.end());
+    SortVectorAndRemoveDuplicates(data);
+    REQUIRE(CheckEquality(list, data));
+
+    for (unsigned n = 0; n < data.size(); n += 2) list.erase(data[n]);
+    REQUIRE(list.size() == data.size()/2);
+    REQUIRE(CheckForwardIteration(list));
+    REQUIRE(CheckBackwardIteration(list));
+}
+
+TEST_CASE( "skip_list_pool_allocator/multi_skip_list", "" )
+{
+    typedef multi_skip_list<int,std::less<int>,skip_list_pool_allocator<int> > list_type;
+
+    list_type list;
+    std::multiset<int> set;
+    for (int n = 0; n < 500; ++n)
+    {
+        list.insert(n % 17);
+        set.insert(n % 17);
+    }
+    REQUIRE(CheckEquality(list, set));
+
+    REQUIRE(list.erase(3) == set.erase(3));
+    REQUIRE(CheckEquality(list, set));
+}
+
+TEST_CASE( "skip_list_pool_allocator/skip_list_map", "" )
+{
+    typedef std::pair<const int, std::string> value_type;
+    typedef skip_list_map<int,std::string,std::less<int>,skip_list_pool_allocator<value_type> > map_type;
+
+    map_type map;
+    for (int n = 0; n < 100; ++n) map.insert(std::make_pair(n, std::string(size_t(n), 'x')));
+    REQUIRE(map.size() == 100);
+    REQUIRE(map.find(42)->second == std::string(42, 'x'));
+
+    map.erase(map.find(42), map.find(60));
+    REQUIRE(map.size() == 82);
+    REQUIRE(map.find(42) == map.end());
+    REQUIRE(map.find(60) != map.end());
+}
+
+TEST_CASE( "skip_list_pool_allocator/random_access_skip_list", "" )
+{
+    typedef random_access_skip_list<int,std::less<int>,skip_list_pool_allocator<int> > list_type;
+
+    std::vector<int> data;
+    FillWithOrderedData(300, data);
+    list_type list(data.begin(), data.end());
+
+    for (unsigned n = 0; n < 100; ++n)
+    {
+        unsigned index = unsigned(rand()) % unsigned(list.size());
+        list.erase_at(index);
+        data.erase(data.begin()+index);
+    }
+    REQUIRE(CheckEquality(list, data));
+    REQUIRE(CheckEqualityViaIndexing(list, data));
+}
+
+TEST_CASE( "skip_list_pool_allocator/erase then insert recycles nodes", "" )
+{
+    typedef skip_list<int,std::less<int>,skip_list_pool_allocator<int> > list_type;
+
+    list_type list;
+    for (int n = 0; n < 1000; ++n) list.insert(n);
+    const std::size_t slabs = list.get_allocator().get_pool()->slabs_allocated();
+
+    for (unsigned repeat = 0; repeat < 10; ++repeat)
+    {
+        list.erase(list.begin(), list.find(500));
+        for (int n = 0; n < 500; ++n) list.insert(n);
+    }
+    REQUIRE(list.size() == 1000);
+
+    // New slabs are only needed if the churn happened to produce taller towers
+    // than before: at most one slab for each new tower height.
+    REQUIRE(list.get_allocator().get_pool()->slabs_allocated() <= slabs+16);
+}
+
+TEST_CASE( "skip_list_pool_allocator/clear releases node memory in bulk", "" )
+{
+    typedef skip_list<int,std::less<int>,skip_list_pool_allocator<int> > list_type;
+
+    list_type list;
+    const std::size_t empty_slabs = list.get_allocator().get_pool()->slabs_allocated(); // head and tail
+
+    for (int n = 0; n < 1000; ++n) list.insert(n);
+    REQUIRE(list.get_allocator().get_pool()->slabs_allocated() > empty_slabs);
+    REQUIRE(list.get_allocator().get_pool()->blocks_in_use() == 1002);
+
+    list.clear();
+    REQUIRE(list.get_allocator().get_pool()->blocks_in_use() == 2);
+    REQUIRE(list.get_allocator().get_pool()->slabs_allocated() == empty_slabs);
+
+    list.insert(1);
+    REQUIRE(list.size() == 1);
+}
+
+TEST_CASE( "skip_list_pool_allocator/object lifetime", "" )
+{
+    typedef skip_list<Counter,std::less<Counter>,skip_list_pool_allocator<Counter> > list_type;
+
+    REQUIRE(Counter::count == 0);
+    {
+        list_type list;
+        for (int n = 0; n < 100; ++n) list.insert(Counter(n));
+        REQUIRE(Counter::count == 100);
+        list.erase(list.begin(), list.find(Counter(50)));
+        REQUIRE(Counter::count == 50);
+    }
+    REQUIRE(Counter::count == 0);
+}
+
+#if SKIP_LIST_CPP11
+
+TEST_CASE( "skip_list_pool_allocator/rvalue insert and emplace do not copy", "" )
+{
+    typedef skip_list<CopyCounter,std::less<CopyCounter>,skip_list_pool_allocator<CopyCounter> > list_type;
+    typedef random_access_skip_list<CopyCounter,std::less<CopyCounter>,skip_list_pool_allocator<CopyCounter> > ra_list_type;
+
+    list_type    list;
+    ra_list_type ra_list;
+    CopyCounter::reset();
+
+    for (int n = 0; n < 10; ++n)
+    {
+        list.insert(CopyCounter(n, "moved"));
+        ra_list.insert(CopyCounter(n, "moved"));
+    }
+    REQUIRE(list.emplace(10, "emplaced").second);
+    REQUIRE(ra_list.emplace(10, "emplaced").second);
+
+    REQUIRE(CopyCounter::copies == 0);
+    REQUIRE(list.size() == 11);
+    REQUIRE(ra_list.size() == 11);
+    REQUIRE(list.find(CopyCounter(10))->payload == "emplaced");
+    REQUIRE(ra_list[3].payload == "moved");
+}
+
+TEST_CASE( "skip_list_pool_allocator/move-only values", "" )
+{
+    typedef std::unique_ptr<int> value_type;
+    skip_list<value_type,std::less<value_type>,skip_list_pool_allocator<value_type> > list;
+
+    list.insert(value_type(new int(1)));
+    list.emplace(new int(2));
+    REQUIRE(list.size() == 2);
+}
+
+#endif
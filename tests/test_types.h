@@ -10,9 +10,13 @@
 // wreak with STL iterators. It's like a post to tie your jelly to.
 #define _SCL_SECURE_NO_WARNINGS
 
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <string>
+#include <sstream>
 
 struct Struct
 {
@@ -70,6 +74,66 @@ struct MockAllocator : Struct
 
 //============================================================================
 
+/// Counts the number of calls made to allocate/deallocate by every
+/// CountingAllocator, whatever it has been rebound to.
+struct AllocationCounter
+{
+    static int allocations;
+    static int blocks;
+    
+    static void reset() { allocations = 0; blocks = 0; }
+};
+
+template <typename T = int>
+struct CountingAllocator
+{
+    CountingAllocator() {}
+    template <class OTHER>
+    CountingAllocator(const OTHER &) {}
+    
+    template <typename OTHER>
+    struct rebind { typedef CountingAllocator<OTHER> other; };
+    
+    std::allocator<T> alloc;
+    
+    typedef T         value_type;
+    typedef size_t    size_type;
+    typedef ptrdiff_t difference_type;
+    typedef T&        reference;
+    typedef const T&  const_reference;
+    typedef T*        pointer;
+    typedef const T*  const_pointer;
+    
+    pointer allocate(size_type n, const void * = 0)
+    {
+        ++AllocationCounter::allocations;
+        ++AllocationCounter::blocks;
+        return alloc.allocate(n);
+    }
+    void deallocate(pointer p, size_type n)
+    {
+        --AllocationCounter::blocks;
+        alloc.deallocate(p, n);
+    }
+    void construct(pointer p, const_reference val)
+        { new ((void*)p) T (val); }
+    void destroy(pointer p)
+        { p->~T(); }
+    size_type max_size() const
+        { return alloc.max_size(); }
+};
+
+template <class T1, class T2>
+inline
+bool operator==(const CountingAllocator<T1>&, const CountingAllocator<T2>&)
+    { return true; }
+template <class T1, class T2>
+inline
+bool operator!=(const CountingAllocator<T1>&, const CountingAllocator<T2>&)
+    { return false; }
+
+//============================================================================
+
 struct Counter
 {
     static int count;
@@ -96,6 +160,82 @@ inline
 std::ostream &operator<<(std::ostream &s, const Counter &c)
     { s << "Counter"; return s; }
 
+#if SKIP_LIST_CPP11
+
+/// Counts the copies and moves made of it.
+struct CopyCounter
+{
+    static int copies;
+    static int moves;
+
+    static void reset() { copies = 0; moves = 0; }
+
+    explicit CopyCounter(int i) : value(i) {}
+    CopyCounter(int i, const std::string &s) : value(i), payload(s) {}
+    CopyCounter(const CopyCounter &other) : value(other.value), payload(other.payload) { ++copies; }
+    CopyCounter(CopyCounter &&other) : value(other.value), payload(std::move(other.payload)) { ++moves; }
+    CopyCounter &operator=(const CopyCounter &other) { value = other.value; payload = other.payload; ++copies; return *this; }
+    CopyCounter &operator=(CopyCounter &&other) { value = other.value; payload = std::move(other.payload); ++moves; return *this; }
+
+    int         value;
+    std::string payload;
+
+    bool operator<(const CopyCounter &other) const { return value < other.value; }
+};
+
+inline
+std::ostream &operator<<(std::ostream &s, const CopyCounter &c)
+    { s << c.value; return s; }
+
+/// A string key that counts how many of it are made, so lookups that build
+/// one from a const char * show up.
+struct CountedString
+{
+    static int constructions;
+
+    CountedString(const char *s) : text(s) { ++constructions; }
+    CountedString(const CountedString &other) : text(other.text) { ++constructions; }
+
+    std::string text;
+
+    bool operator==(const CountedString &other) const { return text == other.text; }
+};
+
+/// Orders CountedStrings, and them against plain C strings without making one.
+struct CountedStringLess
+{
+    typedef void is_transparent;
+
+    bool operator()(const CountedString &lhs, const CountedString &rhs) const { return lhs.text < rhs.text; }
+    bool operator()(const CountedString &lhs, const char *rhs) const          { return lhs.text.compare(rhs) < 0; }
+    bool operator()(const char *lhs, const CountedString &rhs) const          { return rhs.text.compare(lhs) > 0; }
+};
+
+inline
+std::ostream &operator<<(std::ostream &s, const CountedString &c)
+    { s << c.text; return s; }
+
+#endif
+
+//============================================================================
+
+/// A level generator that always asks for the tallest tower it can, so
+/// every node that is linked in makes the list one level taller.
+struct TallLevelGenerator
+{
+    static const unsigned num_levels = 32;
+    unsigned new_level() { return num_levels-1; }
+};
+
+/// The first line of a container's dump, which gives its size and levels.
+template <typename CONTAINER>
+std::string DumpHeader(const CONTAINER &container)
+{
+    std::ostringstream s;
+    container.dump(s);
+    return s.str().substr(0, s.str().find('\n'));
+}
+
 //============================================================================
 
 template <typename CONTAINER>